@@ -1,21 +1,50 @@
 #ifndef ALARMRECEIVER_H
 #define ALARMRECEIVER_H
 
+#include <QElapsedTimer>
 #include <QObject>
-#include <QRegularExpression>
+#include <QTimer>
+#include <QVariantList>
+#include <array>
+
+#include "AlarmRules.h"
+#include "AlertLogModel.h"
 
 class SerialBridge;
 
 /**
  * @brief AlarmReceiver
- * Listens to text lines from SerialBridge and classifies them as error/warning/success.
+ * Listens to text lines from every open SerialBridge link and classifies them as
+ * error/warning/success with an AlarmRules keyword automaton (built-in rules, or a rule
+ * file via loadRules()). A line already heard on another link moments ago is the same
+ * message through a second radio and is classified only once.
+ * Every classified line and posted alarm is also kept in the deduplicated `log` model.
  */
 class AlarmReceiver : public QObject {
     Q_OBJECT
+    Q_PROPERTY(QVariantList ruleStats READ ruleStats NOTIFY ruleStatsChanged)
+    Q_PROPERTY(QString rulesSource READ rulesSource NOTIFY ruleStatsChanged)
+    Q_PROPERTY(AlertLogModel* log READ log CONSTANT)
+
 public:
     /// Construct an AlarmReceiver bound to a (non-owning) SerialBridge pointer.
     explicit AlarmReceiver(SerialBridge* bridge, QObject* parent = nullptr);
 
+    /// Replace the rules with those of a rule file; on error the current rules stay and
+    /// rulesError is emitted.
+    Q_INVOKABLE bool loadRules(const QString& path);
+
+    /// Back to the built-in rules.
+    Q_INVOKABLE void resetRules();
+
+    /// Per keyword: {keyword, severity, prefix, hits} (refreshed once a second).
+    QVariantList ruleStats() const { return m_ruleStats; }
+
+    /// Rule file in use, or empty for the built-in rules.
+    QString rulesSource() const { return m_rulesSource; }
+
+    AlertLogModel* log() { return &m_log; }
+
 signals:
     // -----------------------
     // Classified message signals (UI can bind to these)
@@ -30,35 +59,46 @@ signals:
     /// Emitted when a received line is classified as a success/OK.
     void rxSuccess(const QString& line);
 
+    void ruleStatsChanged();
+
+    /// A rule file could not be loaded.
+    void rulesError(const QString& message);
+
 public slots:
     /// Slot to handle each received line from SerialBridge and trigger classification.
     void onLineReceived(const QString& line);
 
+    /// Report an alarm from another source (AlarmRules::Severity) through the rx signals
+    /// and the log; `source` names it for deduplication and rate limiting.
+    void postAlarm(int severity, const QString& text, const QString& source = QString());
+
 private:
-    /// Apply classification regexes and emit the first matching signal.
+    /// Classify the line in one pass and emit the signal of the most severe match.
     void classifyAndEmit(const QString& line);
 
-    // -----------------------
-    // Regex patterns used to detect severity keywords
-    // -----------------------
+    /// Refresh ruleStats if any keyword was hit since the last refresh.
+    void publishStats();
 
-    /// Error keywords (e.g. "error", "failure", "failed", "fault").
-    QRegularExpression m_reErr{
-        R"(\b(error|failure|failed|fault)\b)",
-        QRegularExpression::CaseInsensitiveOption
-    };
+    /// True if another link delivered the same line within kEchoWindowMs; else remembers it.
+    bool isEchoOfOtherLink(int which, const QString& line);
 
-    /// Warning keywords (e.g. "warn", "warning", "caution").
-    QRegularExpression m_reWarn{
-        R"(\b(warn(?:ing)?|caution)\b)",
-        QRegularExpression::CaseInsensitiveOption
+    struct RecentLine {
+        size_t hash = 0;
+        int    which = 0;
+        qint64 ms = -1;
     };
+    static constexpr qint64 kEchoWindowMs = 500;
 
-    /// Success keywords (e.g. "success", "succeeded", "ok", "passed").
-    QRegularExpression m_reSucc{
-        R"(\b(success|succeeded|ok|passed)\b)",
-        QRegularExpression::CaseInsensitiveOption
-    };
+    AlarmRules   m_rules;              ///< Keyword automaton + per-keyword hit counters.
+    QString      m_rulesSource;
+    QVariantList m_ruleStats;
+    bool         m_hitsDirty = false;
+    QTimer       m_statsTimer;
+    AlertLogModel m_log;
+
+    std::array<RecentLine, 16> m_recentLines {}; ///< Ring of recently classified lines.
+    size_t        m_recentNext = 0;
+    QElapsedTimer m_lineClock;
 
     SerialBridge* m_bridge = nullptr; ///< Non-owning; used to hook up to incoming text lines.
 };
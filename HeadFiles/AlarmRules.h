@@ -0,0 +1,110 @@
+#ifndef ALARMRULES_H
+#define ALARMRULES_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+#include <QStringView>
+#include <QVariantList>
+#include <array>
+#include <vector>
+
+/**
+ * @brief AlarmRules
+ * Keyword → severity classifier for firmware text lines. All keywords are compiled into
+ * one Aho-Corasick automaton whose failure links are folded into a dense transition table
+ * over a compacted alphabet (only the characters keywords use get their own column), so
+ * a line is classified in a single pass, one table lookup per character, without
+ * allocating. Matching is ASCII case-insensitive; a keyword must start and end on a word
+ * boundary unless it ends in '*' (prefix match).
+ *
+ * Rule file, one rule per line ('#' starts a comment):
+ *
+ *     error    error failure failed fault
+ *     warning  warn* caution
+ *     success  success succeeded ok passed
+ *
+ * The most severe matching rule classifies the line (error > warning > success). Every
+ * keyword counts the lines it matched.
+ */
+class AlarmRules {
+public:
+    enum Severity { Error = 0, Warning, Success, None };
+
+    /// The built-in rules (the former hard-coded keyword regexes).
+    AlarmRules();
+
+    /// Parse rule text; on failure returns false, sets *error and keeps the current rules.
+    bool parse(const QString& text, QString* error = nullptr);
+
+    /// Load a rule file (see class comment).
+    bool load(const QString& path, QString* error = nullptr);
+
+    /// Classify one line and count the keywords it contains.
+    Severity classify(QStringView line) { return scan(line.utf16(), line.size()); }
+    Severity classify(QByteArrayView line) { return scan(line.data(), line.size()); }
+
+    /// [{keyword, severity ("error"/"warning"/"success"), prefix, hits}] in rule order.
+    QVariantList stats() const;
+
+    quint64 linesClassified() const { return m_lines; }
+    void resetHits();
+
+    static QString severityName(int severity);
+
+private:
+    struct Keyword {
+        QByteArray text;      ///< Lower-case, without the '*'.
+        int        severity = None;
+        bool       prefix = false;
+        quint64    hits = 0;
+        quint64    lastLine = 0;  ///< Line number of its last hit (counts once per line).
+    };
+
+    /// Rebuild the automaton from keywords (all lower-case ASCII).
+    void compile(std::vector<Keyword> keywords);
+
+    template <typename Ch> Severity scan(const Ch* s, qsizetype n);
+
+    static bool isWordChar(uint c) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+    }
+
+    std::vector<Keyword> m_keywords;
+    std::array<quint8, 128> m_classOf{};  ///< ASCII char (lower-cased) → column; 0 = unused.
+    int m_classes = 1;
+    std::vector<qint32> m_next;           ///< state * m_classes + class → state.
+    std::vector<qint32> m_outStart;       ///< Per state: range in m_out (size states + 1).
+    std::vector<qint32> m_out;            ///< Keyword indices ending at each state.
+    quint64 m_lines = 0;
+};
+
+template <typename Ch>
+AlarmRules::Severity AlarmRules::scan(const Ch* s, qsizetype n)
+{
+    ++m_lines;
+    int best = None;
+    qint32 state = 0;
+    for (qsizetype i = 0; i < n; ++i) {
+        const uint c = uint(s[i]);
+        const uint lc = (c >= 'A' && c <= 'Z') ? c + 32 : c;
+        state = m_next[size_t(state) * size_t(m_classes) + (lc < 128 ? m_classOf[lc] : 0)];
+
+        for (qint32 o = m_outStart[size_t(state)]; o < m_outStart[size_t(state) + 1]; ++o) {
+            Keyword& k = m_keywords[size_t(m_out[size_t(o)])];
+            const qsizetype start = i + 1 - k.text.size();
+            if (start > 0 && isWordChar(uint(s[start - 1])))
+                continue;
+            if (!k.prefix && i + 1 < n && isWordChar(uint(s[i + 1])))
+                continue;
+            if (k.lastLine != m_lines) {
+                k.lastLine = m_lines;
+                ++k.hits;
+            }
+            best = qMin(best, k.severity);
+        }
+    }
+    return Severity(best);
+}
+
+#endif // ALARMRULES_H
@@ -0,0 +1,141 @@
+#ifndef ALERTLOGMODEL_H
+#define ALERTLOGMODEL_H
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QString>
+#include <QTimer>
+#include <vector>
+
+/**
+ * @brief AlertLogModel
+ * Bounded alert log for the System Alert panel. Alerts live in a fixed-capacity ring and
+ * are published in one remove/insert/dataChanged batch per flush (at most every 50 ms),
+ * so a storm costs one layout pass per flush rather than one per alert.
+ *
+ * An alert identical to a retained one (same source, level and text, seen within the
+ * dedup window) does not add a row: the existing row's count and last-seen time are
+ * bumped instead. New rows are rate-limited per source with a token bucket; alerts over
+ * the limit are counted and reported as one "suppressed" row once the source calms down.
+ */
+class AlertLogModel : public QAbstractListModel {
+    Q_OBJECT
+
+    Q_PROPERTY(int     count      READ count      NOTIFY countChanged)
+    Q_PROPERTY(int     retention  READ retention  WRITE setRetention NOTIFY retentionChanged)
+    Q_PROPERTY(quint64 totalReceived READ totalReceived NOTIFY statsChanged)
+    Q_PROPERTY(quint64 collapsed  READ collapsed  NOTIFY statsChanged)
+    Q_PROPERTY(quint64 suppressed READ suppressed NOTIFY statsChanged)
+
+public:
+    enum Roles {
+        LevelRole = Qt::UserRole + 1, ///< "error", "warning" or "success".
+        TextRole,
+        SourceRole,
+        TimeRole,                     ///< First seen (QDateTime).
+        LastTimeRole,                 ///< Last seen (QDateTime).
+        RepeatRole                    ///< Occurrences collapsed into this row (>= 1).
+    };
+
+    explicit AlertLogModel(QObject* parent = nullptr);
+
+    // -----------------------
+    // QAbstractListModel
+    // -----------------------
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    // -----------------------
+    // Producer API
+    // -----------------------
+
+    /// Log one alert (AlarmRules::Severity); it becomes visible on the next flush.
+    void append(int level, const QString& text, const QString& source = QString());
+
+    /// Publish everything staged since the last flush as one batch of row changes.
+    void flush();
+
+    /// New rows allowed per source: `perSecond` sustained, `burst` at once.
+    void setRateLimit(double perSecond, int burst);
+
+    /// Identical alerts further apart than this start a new row.
+    void setDedupWindowMs(int ms) { m_dedupWindowMs = ms; }
+
+    // -----------------------
+    // QML API
+    // -----------------------
+
+    /// Drop all retained alerts.
+    Q_INVOKABLE void clear();
+
+    int count() const { return int(m_viewEnd - m_viewFirst); }
+
+    int retention() const { return int(m_ring.size()); }
+    void setRetention(int alerts);
+
+    quint64 totalReceived() const { return m_received; }
+    quint64 collapsed() const { return m_collapsed; }
+    quint64 suppressed() const { return m_suppressed; }
+
+signals:
+    void countChanged();
+    void retentionChanged();
+    void statsChanged();
+
+private:
+    struct Entry {
+        int     level = 0;
+        QString text;
+        QString source;
+        QString key;          ///< Dedup key (source, level, text).
+        qint64  firstMs = 0;  ///< Wall clock, ms since epoch.
+        qint64  lastMs  = 0;
+        quint32 repeats = 0;
+    };
+
+    struct Bucket {
+        double  tokens = 0.0;
+        qint64  refillNs = 0;     ///< When tokens was last topped up.
+        quint64 suppressed = 0;   ///< Dropped since the last "suppressed" row.
+        int     level = 0;        ///< Most severe level among those dropped.
+    };
+
+    Entry& entryAt(quint64 seq) { return m_ring[seq % m_ring.size()]; }
+    const Entry& entryAt(quint64 seq) const { return m_ring[seq % m_ring.size()]; }
+
+    /// Take a token from source's bucket (refilled to now); false if it is empty.
+    bool admit(Bucket& b, qint64 nowNs);
+
+    /// Add a row (no dedup or rate limiting).
+    void push(int level, const QString& text, const QString& source, const QString& key, qint64 nowMs);
+
+    /// Add a "suppressed" row for every bucket that has tokens again.
+    void reportSuppressed(qint64 nowNs);
+
+    void scheduleFlush();
+
+    std::vector<Entry> m_ring;       ///< Retained alerts, slot = seq % size.
+    quint64 m_firstSeq  = 0;         ///< Oldest sequence number still in the ring.
+    quint64 m_nextSeq   = 0;         ///< Sequence number of the next row.
+    quint64 m_viewFirst = 0;         ///< Published rows are [m_viewFirst, m_viewEnd).
+    quint64 m_viewEnd   = 0;
+    quint64 m_changedLo = ~quint64(0); ///< Published rows whose count changed since the flush.
+    quint64 m_changedHi = 0;
+
+    QHash<QString, quint64> m_bySeq;  ///< Dedup key → newest row with that key.
+    QHash<QString, Bucket>  m_buckets;
+    double m_ratePerSecond = 5.0;
+    int    m_burst         = 20;
+    int    m_dedupWindowMs = 60000;
+    bool   m_anySuppressed = false;
+
+    quint64 m_received   = 0;
+    quint64 m_collapsed  = 0;
+    quint64 m_suppressed = 0;
+
+    QTimer m_flushTimer;
+};
+
+#endif // ALERTLOGMODEL_H
@@ -0,0 +1,76 @@
+#ifndef ALLOCCOUNTER_H
+#define ALLOCCOUNTER_H
+
+#include <QtGlobal>
+
+/**
+ * @brief AllocCounter
+ * Heap allocation accounting for the receive path, compiled in with the CMake option
+ * ULYSSES_ALLOC_CHECK. With glibc it interposes malloc/calloc/realloc, so Qt container
+ * storage (QString, QByteArray, QList) and operator new are both counted; elsewhere it
+ * falls back to replacing the global operator new/delete, which sees C++ allocations only.
+ *
+ * Steady-state hot scopes are marked with ULYSSES_NO_ALLOC("site"). Once a site has run
+ * NoAllocScope::kWarmup times, any allocation inside it aborts through qFatal naming the
+ * site, so a soak, replay or ulysses_bench run proves the pipeline allocation-free.
+ * ULYSSES_ALLOC_EXEMPT() marks the rare, deliberate allocations inside such a scope
+ * (opt-in raw frame copies, a first-seen vehicle, alarm transitions). Without the option
+ * both macros expand to nothing and the counters read 0.
+ */
+namespace AllocCounter {
+
+/// True if allocation counting is compiled in.
+bool enabled();
+
+/// Allocations made by the calling thread so far.
+quint64 threadCount();
+
+/// Allocations made by all threads so far.
+quint64 totalCount();
+
+} // namespace AllocCounter
+
+#ifdef ULYSSES_ALLOC_CHECK
+
+/// Fails (qFatal) if the enclosing scope allocates after its site has warmed up.
+class NoAllocScope {
+public:
+    struct Site {
+        const char* name;
+        quint64     runs = 0;        ///< Entries so far (a site is used by one thread).
+    };
+    static constexpr quint64 kWarmup = 256;
+
+    explicit NoAllocScope(Site& site);
+    ~NoAllocScope();
+
+private:
+    Site&   m_site;
+    quint64 m_start;
+};
+
+/// Allocations inside this scope are not held against an enclosing NoAllocScope.
+class AllocExemptScope {
+public:
+    AllocExemptScope();
+    ~AllocExemptScope();
+
+private:
+    quint64 m_start;
+};
+
+#define ULYSSES_ALLOC_CONCAT2(a, b) a##b
+#define ULYSSES_ALLOC_CONCAT(a, b) ULYSSES_ALLOC_CONCAT2(a, b)
+#define ULYSSES_NO_ALLOC(name) \
+    static NoAllocScope::Site ULYSSES_ALLOC_CONCAT(allocSite_, __LINE__) { name }; \
+    NoAllocScope ULYSSES_ALLOC_CONCAT(allocScope_, __LINE__)(ULYSSES_ALLOC_CONCAT(allocSite_, __LINE__))
+#define ULYSSES_ALLOC_EXEMPT() AllocExemptScope ULYSSES_ALLOC_CONCAT(allocExempt_, __LINE__)
+
+#else
+
+#define ULYSSES_NO_ALLOC(name) do {} while (false)
+#define ULYSSES_ALLOC_EXEMPT() do {} while (false)
+
+#endif // ULYSSES_ALLOC_CHECK
+
+#endif // ALLOCCOUNTER_H
@@ -0,0 +1,120 @@
+#ifndef BATCHDECODER_H
+#define BATCHDECODER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/**
+ * @brief ColumnTable
+ * A decoded table stored column by column (one contiguous byte vector per column).
+ * Shards are built independently and concatenated in order with append().
+ *
+ * Columnar file (<prefix>.<table>.ucol, little-endian):
+ *   "ULYCOL1\0", quint32 version, quint32 columnCount, quint64 rowCount
+ *   columnCount x { char name[32]; quint32 type; quint32 reserved; quint64 offset }
+ *   column data, each column contiguous at its offset (rowCount x sizeof(type))
+ */
+class ColumnTable {
+public:
+    enum Type : quint32 { F64 = 0, F32, U32, I32, U8 };
+
+    struct Column {
+        QByteArray           name;
+        Type                 type;
+        std::vector<uint8_t> data;
+    };
+
+    /// Declare a column; all columns must be declared before the first row.
+    void addColumn(const char* name, Type type) { m_columns.push_back({ QByteArray(name), type, {} }); }
+
+    /// Append one value to column index col (caller keeps rows aligned).
+    template<typename T>
+    void push(size_t col, T value) {
+        auto& d = m_columns[col].data;
+        const size_t at = d.size();
+        d.resize(at + sizeof(T));
+        std::memcpy(d.data() + at, &value, sizeof(T));
+    }
+
+    /// Close the current row.
+    void endRow() { ++m_rows; }
+
+    /// Concatenate another table with the same schema.
+    void append(const ColumnTable& other);
+
+    quint64 rowCount() const { return m_rows; }
+    const std::vector<Column>& columns() const { return m_columns; }
+
+    bool writeCsv(const QString& path) const;
+    bool writeColumnar(const QString& path) const;
+
+    static size_t typeSize(Type t);
+
+private:
+    std::vector<Column> m_columns;
+    quint64 m_rows = 0;
+};
+
+/**
+ * @brief BatchDecoder
+ * Headless, multi-threaded decoder for recorded downlink data. Accepts either a
+ * FlightRecorder .ulog file or a raw COBS byte capture; the input is split into shards
+ * at frame boundaries (0x00 delimiters for raw captures), each shard is decoded and
+ * unit-converted on its own thread, and the per-shard tables are merged in file order.
+ */
+class BatchDecoder {
+public:
+    struct Stats {
+        quint64 frames       = 0;
+        quint64 telemetry    = 0;
+        quint64 status       = 0;
+        quint64 decodeErrors = 0;
+        int     shards       = 0;
+    };
+
+    /// jobs <= 0 uses every core.
+    explicit BatchDecoder(int jobs = 0) : m_jobs(jobs) {}
+
+    /// Decode the whole file; forceRaw treats even a .ulog as a raw COBS stream.
+    bool decodeFile(const QString& path, bool forceRaw, QString* error);
+
+    const ColumnTable& telemetry() const { return m_telemetry; }
+    const ColumnTable& status() const { return m_status; }
+    const Stats& stats() const { return m_stats; }
+
+private:
+    /// One frame located in the input (raw captures carry no receive time).
+    struct FrameSpan {
+        quint64 offset;
+        quint32 length;
+        quint8  port;
+        qint64  rxNs;
+    };
+
+    /// Output of one decode shard.
+    struct Shard {
+        ColumnTable telemetry;
+        ColumnTable status;
+        Stats       stats;
+    };
+
+    /// Locate every frame of a .ulog recording (sequential, no decode).
+    static bool indexRecording(const uchar* data, quint64 size, std::vector<FrameSpan>& frames);
+
+    /// Byte ranges of a raw capture, each starting right after a 0x00 delimiter.
+    static std::vector<std::pair<quint64, quint64>> splitRaw(const uchar* data, quint64 size, int parts);
+
+    static void declareSchema(Shard& shard);
+    static void decodeFrame(const uchar* frame, size_t size, int port, double rxMs, Shard& out);
+
+    int         m_jobs;
+    ColumnTable m_telemetry;
+    ColumnTable m_status;
+    Stats       m_stats;
+};
+
+#endif // BATCHDECODER_H
@@ -0,0 +1,51 @@
+#ifndef COMMANDCATALOG_H
+#define COMMANDCATALOG_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <array>
+
+extern "C" {
+    #include "command.pb.h"
+}
+
+/**
+ * @brief CommandCatalog
+ * Every distinct uplink command encoded once (nanopb + COBS via rp_packet_encode) and
+ * kept as an immutable QByteArray. Handing a packet out is a reference-count increment:
+ * the TX queue, the tracker's retries and periodic streams all share the same bytes, so
+ * sending allocates no packet buffer and never re-encodes.
+ *
+ * The state commands (ARM, LAUNCH, ABORT, LAND) are encoded at construction; other
+ * commands are added by name with define(), which re-encodes and swaps the buffer only
+ * when the encoded bytes actually change.
+ */
+class CommandCatalog {
+public:
+    CommandCatalog();
+
+    /// Encoded StateCommand of this type (empty if it can't be encoded). Unknown types
+    /// are encoded on first use and then kept.
+    QByteArray statePacket(int commandType);
+
+    /// Encode cmd under name; returns false (entry unchanged) if encoding fails.
+    bool define(const QString& name, const tvr_FlightCommand& cmd);
+
+    /// Packet defined under name, or an empty array.
+    QByteArray packet(const QString& name) const { return m_named.value(name); }
+
+    QStringList names() const { return m_named.keys(); }
+
+    /// Encode cmd into a fresh packet (empty on failure).
+    static QByteArray encode(const tvr_FlightCommand& cmd);
+
+private:
+    static constexpr int kStateSlots = 8;         ///< Direct slots for small type numbers.
+
+    std::array<QByteArray, kStateSlots> m_state;  ///< By StateCommand type.
+    QHash<QString, QByteArray> m_named;
+};
+
+#endif // COMMANDCATALOG_H
@@ -2,9 +2,12 @@
 #define COMMANDSENDER_H
 
 #include <QObject>
-#include <QTimer>
+#include <QPointer>
 #include <cstdint>
 
+#include "CommandCatalog.h"
+#include "PeriodicScheduler.h"
+
 
 extern "C" {
     #include "rp/codec.h"
@@ -12,6 +15,7 @@ extern "C" {
 }
 
 class SerialBridge;
+class CommandTracker;
 
 class CommandSender : public QObject {
     Q_OBJECT
@@ -23,15 +27,21 @@ public:
     /// Send a single command string out via the given channel on the bridge.
     Q_INVOKABLE bool sendCode(int which, const QString& code);
 
-    /// Send a FlightCommand via encoded protobuf packet
+    /// Send a FlightCommand (pre-encoded packet from the catalogue; tracked until confirmed
+    /// if a CommandTracker is set).
     Q_INVOKABLE bool sendFlightCommand(int which, int commandType);
 
     // -----------------------
     // Periodic test helpers
     // -----------------------
 
-    /// Start sending a command at a fixed frequency (Hz) on the given channel.
-    Q_INVOKABLE void startPeriodic(int which, const QString& code, int hz = 50);
+    /// Start sending a command at a fixed frequency (Hz) on the given channel (runs on the
+    /// scheduler's timing thread; requires setScheduler()).
+    Q_INVOKABLE void startPeriodic(int which, const QString& code, double hz = 50);
+
+    /// Stream a pre-encoded FlightCommand (binary, from the catalogue) at hz on the given
+    /// channel, for load-testing the real uplink protocol.
+    Q_INVOKABLE void startPeriodicCommand(int which, int commandType, double hz = 50);
 
     /// Stop periodic sending on the given channel.
     Q_INVOKABLE void stopPeriodic(int which);
@@ -39,6 +49,9 @@ public:
     /// Return true if periodic sending is active on the given channel.
     Q_INVOKABLE bool isPeriodicRunning(int which) const;
 
+    /// Scheduler stream id of the channel's latest periodic send (0 if none), for its stats.
+    Q_INVOKABLE int periodicStream(int which) const { return validWhich(which) ? chan(which).stream : 0; }
+
 
 signals:
     // -----------------------
@@ -55,12 +68,21 @@ public slots:
     /// Set or swap the SerialBridge used for all subsequent sends (non-owning).
     void setBridge(SerialBridge* bridge) { m_bridge = bridge; }
 
+    /// Scheduler used for periodic sending (non-owning).
+    void setScheduler(PeriodicScheduler* scheduler) { m_scheduler = scheduler; }
+
+    /// Route flight commands through tracker for acknowledgement and retries (non-owning).
+    void setTracker(CommandTracker* tracker) { m_tracker = tracker; }
+
 private:
-    /// Per-channel periodic sending state (timer + payload + rate).
+    /// Start (replacing) the channel's periodic stream; reports failures.
+    void startStream(int which, const QByteArray& payload, bool text, double hz, const QString& label);
+
+    /// Per-channel periodic sending state (scheduler stream + payload + rate).
     struct PeriodicChan {
-        QTimer timer;
-        QString payload;
-        int hz = 0;
+        int     stream = 0;   ///< PeriodicScheduler stream id (0: none).
+        QString payload;      ///< Text sent, or the command's name for binary streams.
+        double  hz = 0;
     };
 
     /// Check that the channel index is valid (1 or 2).
@@ -79,6 +101,9 @@ private:
     }
 
     SerialBridge* m_bridge = nullptr; ///< Serial transport used to send commands.
+    CommandTracker* m_tracker = nullptr; ///< Optional ack/retry tracking of flight commands.
+    QPointer<PeriodicScheduler> m_scheduler; ///< Drives periodic sends.
+    CommandCatalog m_catalog;         ///< Encoded-once command packets.
     PeriodicChan m_ch1;               ///< Periodic send state for channel 1.
     PeriodicChan m_ch2;               ///< Periodic send state for channel 2.
 };
@@ -0,0 +1,157 @@
+#ifndef COMMANDTRACKER_H
+#define COMMANDTRACKER_H
+
+#include <QByteArray>
+#include <QMap>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QVariantList>
+#include <QVariantMap>
+#include <deque>
+#include <vector>
+
+#include "DownlinkRecord.h"
+#include "LatencyHistogram.h"
+#include "PeriodicScheduler.h"
+#include "SensorDataModel.h"
+#include "SerialBridge.h"
+
+/**
+ * @brief CommandTracker
+ * Follows every FlightCommand until the rocket confirms it. Confirmation comes from the
+ * downlink, two ways:
+ *   - counter: the rocket counts every copy it receives in SystemStatus.cmd_rx_count.
+ *     Each transmitted attempt is remembered with its send time, and each increment
+ *     consumes the oldest one still outstanding: if its command is pending it is
+ *     confirmed (RTT from that attempt), otherwise the increment is the late copy of a
+ *     command already confirmed or given up and confirms nothing else. Attempts with no
+ *     increment for twice their timeout are taken as lost;
+ *   - state:   telemetry flight_state reaching the state the command leads to (LAUNCH →
+ *     RISE, ABORT → ESTOP, LAND → LOWER), which arrives at the telemetry rate rather
+ *     than once per status period.
+ *
+ * A command without confirmation within timeoutMs of its transmission is sent again,
+ * each retry waiting twice as long, until maxRetries is exhausted and it is reported as
+ * failed. Round-trip time (transmission handed to the link → confirmation seen by the
+ * model) is kept per command type in a LatencyHistogram.
+ *
+ * cmd_rx_count is one counter for all links, so while a periodic command stream
+ * (PeriodicScheduler) runs on any link, increments only move the baseline: they cannot be
+ * told apart from the stream's own packets.
+ *
+ * GUI thread only; SensorDataModel feeds it every drained record, so confirmations do not
+ * depend on the window rendering.
+ */
+class CommandTracker : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(QVariantMap  latest   READ latest   NOTIFY changed)
+    Q_PROPERTY(QVariantList recent   READ recent   NOTIFY changed)
+    Q_PROPERTY(QVariantList rttStats READ rttStats NOTIFY changed)
+    Q_PROPERTY(int timeoutMs  READ timeoutMs  WRITE setTimeoutMs  NOTIFY settingsChanged)
+    Q_PROPERTY(int maxRetries READ maxRetries WRITE setMaxRetries NOTIFY settingsChanged)
+
+public:
+    enum State { Queued = 0, Sent, Acked, Failed };
+    Q_ENUM(State)
+
+    CommandTracker(SerialBridge* bridge, SensorDataModel* model, QObject* parent = nullptr);
+
+    /// Send an encoded FlightCommand of commandType on link `which` and track it; returns
+    /// the tracking id (0 if the link is not open).
+    quint64 submit(int which, int commandType, const QByteArray& packet, int priority);
+
+    /// Latest command per type, keyed by the type number:
+    /// {id, state, attempts, rttMs (acked), via ("counter"/"state"), reason (failed)}.
+    QVariantMap latest() const { return m_latest; }
+
+    /// Last finished commands, newest first: [{id, type, name, state, attempts, rttMs, via, reason}].
+    QVariantList recent() const { return m_recent; }
+
+    /// Per type: [{type, name, sent, acked, failed, retries, p50Ms, p99Ms, maxMs, meanMs}].
+    QVariantList rttStats() const;
+
+    int  timeoutMs() const { return m_timeoutMs; }
+    void setTimeoutMs(int ms);
+    int  maxRetries() const { return m_maxRetries; }
+    void setMaxRetries(int n);
+
+    Q_INVOKABLE void resetStats();
+
+    static QString commandName(int commandType);
+
+    /// Ignore counter increments while scheduler runs a command stream.
+    void setScheduler(PeriodicScheduler* scheduler) { m_scheduler = scheduler; }
+
+    /// One decoded record of the model's vehicle and the state after it (SensorDataModel).
+    void observe(const DownlinkRecord& rec, const TelemetrySnapshot& state);
+
+signals:
+    void commandAcked(quint64 id, int commandType, double rttMs, const QString& via);
+    void commandFailed(quint64 id, int commandType, const QString& reason);
+    void changed();
+    void settingsChanged();
+
+private:
+    struct Command {
+        quint64    id = 0;
+        int        which = 0;
+        int        type = 0;
+        int        priority = 0;
+        QByteArray packet;
+        int        attempts = 0;       ///< Transmissions handed to the bridge so far.
+        std::vector<qint64> sentNs;    ///< Per attempt: when it reached the link (0: not yet).
+        qint64     deadlineNs = 0;     ///< Retry/fail time of the latest attempt (0: not sent yet).
+    };
+
+    /// A transmission that reached the link and whose increment has not been seen.
+    struct Attempt {
+        quint64 id = 0;                ///< Command it belongs to (may be finished by now).
+        qint64  sentNs = 0;
+        qint64  expiresNs = 0;         ///< Taken as lost after this.
+    };
+
+    struct TypeStats {
+        quint64 sent = 0;
+        quint64 acked = 0;
+        quint64 failed = 0;
+        quint64 retries = 0;
+        LatencyHistogram rtt;
+    };
+
+    /// Hand one more attempt to the bridge; false if the link is gone.
+    bool transmit(Command& c);
+    void onTxResult(quint64 id, int attempt, int result);
+    void onCmdRxCount(quint32 count);
+    void onFlightState(int state);
+    void onTick();
+
+    void ack(std::deque<Command>::iterator it, qint64 sentNs, const QString& via);
+    void fail(std::deque<Command>::iterator it, const QString& reason);
+    void finish(const Command& c, State state, double rttMs, const QString& via, const QString& reason);
+    void publishLatest(const Command& c, State state, double rttMs = 0.0,
+                       const QString& via = QString(), const QString& reason = QString());
+
+    std::deque<Command>::iterator find(quint64 id);
+
+    QPointer<SerialBridge>    m_bridge;
+    QPointer<SensorDataModel> m_model;
+    QPointer<PeriodicScheduler> m_scheduler;
+
+    std::deque<Command> m_pending;     ///< Unconfirmed commands in submission order.
+    std::deque<Attempt> m_inFlight;    ///< Outstanding attempts in transmission order.
+    QMap<int, TypeStats> m_stats;      ///< By command type.
+    QVariantMap  m_latest;
+    QVariantList m_recent;
+
+    bool    m_haveCount = false;
+    quint32 m_lastCount = 0;           ///< Last cmd_rx_count seen.
+    int     m_lastState = -1;
+
+    int     m_timeoutMs = 1500;        ///< One 1 Hz status period plus margin.
+    int     m_maxRetries = 3;
+    QTimer  m_tick;                    ///< Retry/timeout check while anything is pending.
+    quint64 m_nextId = 1;
+};
+
+#endif // COMMANDTRACKER_H
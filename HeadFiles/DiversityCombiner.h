@@ -0,0 +1,79 @@
+#ifndef DIVERSITYCOMBINER_H
+#define DIVERSITYCOMBINER_H
+
+#include <QVariantMap>
+#include <QtGlobal>
+#include <array>
+#include <vector>
+
+/**
+ * @brief DiversityCombiner
+ * Merges the downlink heard by several ground radios into one stream. Every decoded
+ * packet is offered with its (vehicle, timestamp_ms, payload type) key; the first copy of a key
+ * is forwarded at once (no reorder delay) and later copies from other links within the
+ * window are reported as duplicates. A link repeating a key it already delivered is
+ * sending a distinct packet (senders may stamp a burst with one timestamp). The window is a small fixed ring of recent keys,
+ * searched linearly, so offering a packet never allocates.
+ *
+ * When a key leaves the window the set of links that delivered it is settled: a key
+ * heard by one link only is that link's "solo" contribution, i.e. a packet the combined
+ * stream would have lost without it. With independent fades the combined loss is about
+ * the product of the per-link losses.
+ */
+class DiversityCombiner {
+public:
+    static constexpr int    kWindow   = 64;                     ///< Keys remembered.
+    static constexpr qint64 kWindowNs = 2'000'000'000;          ///< And for at most this long.
+    static constexpr int    kMaxLinks = 64;                     ///< Links tracked per key (bitmask).
+
+    DiversityCombiner();
+
+    /// Offer a decoded packet from link `which`; true if it is the first copy (forward it).
+    bool offer(int which, int vehicle, int payloadType, quint32 timestampMs, qint64 nowNs);
+
+    /// Forget the window and all counters.
+    void reset();
+
+    /// Contribution of one link: {offered, first, duplicates, solo, lagMs} (lagMs: mean
+    /// delay of its duplicate copies behind the first one).
+    QVariantMap linkStats(int which) const;
+
+    /// Totals: {unique, duplicates, multiLink, soloByLink: {id: solo}}.
+    QVariantMap summary() const;
+
+private:
+    struct Entry {
+        quint32 timestampMs = 0;
+        qint32  payloadType = -1;     ///< -1 = empty slot.
+        qint32  vehicle = 0;
+        quint64 links = 0;            ///< Bit per link slot that delivered this key.
+        qint64  firstNs = 0;
+        int     firstSlot = 0;
+    };
+
+    struct LinkCounters {
+        int     id = 0;
+        quint64 offered = 0;
+        quint64 first = 0;
+        quint64 duplicates = 0;
+        quint64 solo = 0;
+        qint64  lagNsSum = 0;
+    };
+
+    /// Slot of link `which` in m_links, created on first use (-1 if out of slots).
+    int slotOf(int which);
+    const LinkCounters* countersOf(int which) const;
+
+    /// Account for an entry leaving the window.
+    void settle(Entry& e);
+
+    std::array<Entry, kWindow> m_window {};
+    int m_next = 0;                   ///< Ring slot to reuse next.
+    std::vector<LinkCounters> m_links;
+
+    quint64 m_unique = 0;
+    quint64 m_duplicates = 0;
+    quint64 m_multiLink = 0;          ///< Settled keys heard by more than one link.
+};
+
+#endif // DIVERSITYCOMBINER_H
@@ -0,0 +1,82 @@
+#ifndef DOWNLINKGENERATOR_H
+#define DOWNLINKGENERATOR_H
+
+#include <QByteArray>
+#include <QtGlobal>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+extern "C" {
+    #include "downlink.pb.h"
+}
+
+/**
+ * @brief DownlinkGenerator
+ * Deterministic source of synthetic tvr_Downlink traffic for benchmarks and simulators.
+ * Produces a telemetry/status mix on a simulated clock, randomly drops the optional
+ * sub-messages, and can flip a byte inside a fraction of the encoded frames so the
+ * decoder's error path gets exercised too. Same seed, same byte stream.
+ */
+class DownlinkGenerator {
+public:
+    struct Options {
+        int      statusEvery  = 10;    ///< One SystemStatus after this many TelemetryStates (<= 0: none).
+        double   optionalRate = 1.0;   ///< Probability each optional sub-message is present.
+        double   corruptRate  = 0.0;   ///< Probability an encoded frame gets one byte flipped.
+        quint32  periodMs     = 10;    ///< Simulated time between messages.
+        quint32  seed         = 1;
+    };
+
+    explicit DownlinkGenerator(const Options& options = Options());
+
+    /// Fill msg with the next message of the mix and advance the simulated clock.
+    void next(tvr_Downlink& msg);
+
+    /// Encode the next message into out (0x00 delimiter included); returns bytes or 0.
+    /// *corrupted (optional) tells whether a byte was flipped after encoding.
+    size_t nextFrame(uint8_t* out, size_t capacity, bool* corrupted = nullptr);
+
+    /// Convenience overload returning the frame as a QByteArray.
+    QByteArray nextFrame(bool* corrupted = nullptr);
+
+    quint32 timestampMs() const { return m_timestampMs; }
+    quint64 generated() const { return m_generated; }
+
+    // -----------------------
+    // Building blocks (shared with the rocket simulator)
+    // -----------------------
+
+    /// COBS+CRC encode msg into out and make sure the frame ends with the 0x00 delimiter.
+    /// Returns the frame length, or 0 if it doesn't fit.
+    static size_t encode(const tvr_Downlink& msg, uint8_t* out, size_t capacity);
+
+    /// Flip one payload byte of an encoded frame (never the delimiter, never to 0x00,
+    /// so framing stays intact and only the CRC/decode rejects it).
+    template <typename Rng>
+    static void corrupt(uint8_t* frame, size_t size, Rng& rng) {
+        if (size < 2)
+            return;
+        const size_t at = std::uniform_int_distribution<size_t>(0, size - 2)(rng);
+        uint8_t flipped = uint8_t(frame[at] ^ (1u << std::uniform_int_distribution<int>(0, 7)(rng)));
+        frame[at] = flipped ? flipped : uint8_t(frame[at] ^ 0xFF);
+    }
+
+    /// Largest frame encode() can produce for one Downlink.
+    static constexpr size_t kMaxFrame = 512;
+
+private:
+    void fillTelemetry(tvr_Downlink& msg);
+    void fillStatus(tvr_Downlink& msg);
+    bool coin(double p) { return p >= 1.0 || (p > 0.0 && m_unit(m_rng) < p); }
+
+    Options      m_opt;
+    std::mt19937 m_rng;
+    std::uniform_real_distribution<double> m_unit{0.0, 1.0};
+
+    quint32 m_timestampMs = 0;
+    quint64 m_generated   = 0;
+    int     m_sinceStatus = 0;
+};
+
+#endif // DOWNLINKGENERATOR_H
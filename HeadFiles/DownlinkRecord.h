@@ -0,0 +1,85 @@
+#ifndef DOWNLINKRECORD_H
+#define DOWNLINKRECORD_H
+
+#include <QtGlobal>
+#include <chrono>
+
+extern "C" {
+    #include "downlink.pb.h"
+}
+
+/// Monotonic ground clock in nanoseconds, comparable across threads.
+inline qint64 monotonicNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief DownlinkRecord
+ * One decoded downlink frame as handed from the I/O thread to the UI thread.
+ */
+struct DownlinkRecord {
+    int          which  = 0;   ///< Port index the frame arrived on.
+    int          vehicle = 0;  ///< Vehicle its link is assigned to (SerialWorker::setLinkVehicle()).
+    int          status = 0;   ///< rp_codec status of the decode (RP_CODEC_OK on success).
+    qint64       rxNs   = 0;   ///< Monotonic ground time the frame was received.
+    qint64       framedNs  = 0; ///< When its delimiter was found (0 if not framed on the I/O thread).
+    qint64       decodedNs = 0; ///< When its decode finished (0 if not decoded on the I/O thread).
+    bool         primed = false; ///< Re-injected by a replay seek to restore state, not a new packet.
+    tvr_Downlink downlink {};  ///< Decoded message (only valid when status is OK).
+};
+
+/**
+ * @brief TelemetrySnapshot
+ * Latest display values derived from the downlink stream (already unit-converted).
+ * Plain data so it can be published across threads through a SnapshotBuffer.
+ */
+struct TelemetrySnapshot {
+    // Position [m]
+    double altitude = 0.0;
+    double posX     = 0.0;
+    double posY     = 0.0;
+
+    // Kalman filter — raw = angular rate (deg/s), filtered = Euler angle (deg)
+    double rawAngleX      = 0.0;
+    double filteredAngleX = 0.0;
+    double rawAngleY      = 0.0;
+    double filteredAngleY = 0.0;
+    double rawAngleZ      = 0.0;
+    double filteredAngleZ = 0.0;
+
+    // Engine outputs
+    double thrustCmd = 0.0;
+    double gimbalX   = 0.0;
+    double gimbalY   = 0.0;
+
+    // Speed [km/h]
+    double velocity = 0.0;
+
+    // SystemStatus state
+    int     flightState  = 0;
+    quint32 uptimeMs     = 0;
+    bool    accelOk      = false;
+    bool    gyroOk       = false;
+    bool    baro1Ok      = false;
+    bool    baro2Ok      = false;
+    bool    gpsConnected = false;
+    quint32 radioRxCount = 0;
+    quint32 radioTxCount = 0;
+    quint32 cmdRxCount   = 0;
+
+    quint32 telemetryCount = 0; ///< Number of TelemetryState packets applied.
+    quint32 statusCount    = 0; ///< Number of SystemStatus packets applied.
+
+    /// Fold one decoded Downlink (TelemetryState or SystemStatus) into the snapshot.
+    void apply(const tvr_Downlink& d);
+};
+
+/// Quaternion (w,x,y,z) to Euler angles (roll, pitch, yaw) in radians.
+void quatToEulerRad(float w, float x, float y, float z,
+                    float* roll_rad, float* pitch_rad, float* yaw_rad);
+
+/// Radians to degrees.
+float radToDeg(float rad);
+
+#endif // DOWNLINKRECORD_H
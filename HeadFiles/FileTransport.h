@@ -0,0 +1,46 @@
+#ifndef FILETRANSPORT_H
+#define FILETRANSPORT_H
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTimer>
+
+#include "Transport.h"
+
+/**
+ * @brief FileTransport
+ * Plays a raw byte capture (what the radio delivered, COBS delimiters included) as RX.
+ * Bytes are released at baud/10 bytes per second to mimic the radio, or as fast as the
+ * pipeline drains them when baud <= 0. Writes are accepted and discarded.
+ * (Recorded .ulog flights are replayed with ReplayEngine instead.)
+ */
+class FileTransport : public Transport {
+    Q_OBJECT
+
+public:
+    FileTransport(const QString& path, int baud, QObject* parent = nullptr);
+
+    bool open() override;
+    void close() override;
+    bool isOpen() const override { return m_file.isOpen(); }
+
+    qint64 read(char* dst, qint64 max) override;
+    qint64 write(const char*, qint64 size) override { return size; }
+
+    int baudRate() const override { return m_baud > 0 ? m_baud : 0; }
+    QString describe() const override { return QStringLiteral("file:") + m_file.fileName(); }
+    QString errorString() const override { return m_file.errorString(); }
+
+private:
+    /// Release the next slice of bytes according to the pacing budget.
+    void tick();
+
+    QFile         m_file;
+    int           m_baud;
+    QTimer        m_timer;
+    QElapsedTimer m_clock;
+    qint64        m_released = 0;   ///< Bytes the pacing budget allows so far.
+    qint64        m_consumed = 0;   ///< Bytes handed out by read().
+};
+
+#endif // FILETRANSPORT_H
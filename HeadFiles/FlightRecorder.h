@@ -0,0 +1,127 @@
+#ifndef FLIGHTRECORDER_H
+#define FLIGHTRECORDER_H
+
+#include <QFile>
+#include <QMutex>
+#include <QObject>
+#include <QTimer>
+#include <QWaitCondition>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+class QThread;
+
+/**
+ * @brief FlightRecorder
+ * Append-only recorder for raw downlink frames (see RecordingFormat.h).
+ * record() is called on the serial I/O thread and only memcpy's the frame into a
+ * pre-reserved staging buffer under a short lock; a background writer thread swaps the
+ * buffer out, writes it as one chunk, appends the sidecar index entry and applies the
+ * fsync policy. If the writer falls behind by more than the staging limit, frames are
+ * counted as dropped instead of blocking RX.
+ */
+class FlightRecorder : public QObject {
+    Q_OBJECT
+
+    Q_PROPERTY(bool    recording     READ isRecording   NOTIFY recordingChanged)
+    Q_PROPERTY(QString filePath      READ filePath      NOTIFY recordingChanged)
+    Q_PROPERTY(quint64 framesWritten READ framesWritten NOTIFY statsChanged)
+    Q_PROPERTY(quint64 bytesWritten  READ bytesWritten  NOTIFY statsChanged)
+    Q_PROPERTY(quint64 framesDropped READ framesDropped NOTIFY statsChanged)
+
+public:
+    /// When the writer forces data to stable storage.
+    enum SyncPolicy {
+        NoSync = 0,       ///< Leave it to the OS page cache.
+        SyncEveryChunk,   ///< fsync after every chunk (safest, most I/O).
+        SyncInterval      ///< fsync at most every syncIntervalMs.
+    };
+    Q_ENUM(SyncPolicy)
+
+    struct Options {
+        int        chunkBytes      = 64 * 1024;       ///< Wake the writer once this much is staged.
+        int        flushIntervalMs = 250;             ///< Write a partial chunk at least this often.
+        SyncPolicy sync            = SyncInterval;
+        int        syncIntervalMs  = 2000;
+        int        maxStagingBytes = 8 * 1024 * 1024; ///< Drop (and count) beyond this backlog.
+    };
+
+    explicit FlightRecorder(QObject* parent = nullptr);
+    ~FlightRecorder() override;
+
+    void setOptions(const Options& options) { m_options = options; } ///< Applies on next start().
+    const Options& options() const { return m_options; }
+
+    /// Directory used by start() when no path is given.
+    void setDefaultDirectory(const QString& dir) { m_defaultDir = dir; }
+
+    // -----------------------
+    // QML API
+    // -----------------------
+
+    /// Start a new recording (empty path → timestamped file in the default directory).
+    Q_INVOKABLE bool start(const QString& path = QString());
+
+    /// Flush everything staged, sync and close the recording.
+    Q_INVOKABLE void stop();
+
+    bool    isRecording() const { return m_recording.load(std::memory_order_acquire); }
+    QString filePath() const { return m_path; }
+    quint64 framesWritten() const { return m_framesWritten.load(std::memory_order_relaxed); }
+    quint64 bytesWritten() const { return m_bytesWritten.load(std::memory_order_relaxed); }
+    quint64 framesDropped() const { return m_framesDropped.load(std::memory_order_relaxed); }
+
+    // -----------------------
+    // Producer API (any thread; called from the serial I/O thread)
+    // -----------------------
+
+    /// Stage one raw frame; never blocks on disk I/O.
+    void record(int which, qint64 rxNs, const uint8_t* data, size_t size);
+
+signals:
+    void recordingChanged();
+    void statsChanged();
+    void errorMessage(const QString& msg);
+
+private:
+    /// Staged frames plus the chunk metadata that describes them.
+    struct Stage {
+        std::vector<uint8_t> bytes;
+        quint32 frames    = 0;
+        qint64  firstRxNs = 0;
+        qint64  lastRxNs  = 0;
+    };
+
+    /// Writer thread body.
+    void writerLoop();
+
+    /// Write one staged chunk + its index entry; returns false on I/O error.
+    bool writeChunk(const Stage& stage);
+
+    /// fsync both files (no-op where unsupported).
+    void syncFiles();
+
+    Options m_options;
+    QString m_defaultDir;
+    QString m_path;
+
+    QFile    m_file;                    ///< .ulog (writer thread only while recording).
+    QFile    m_index;                   ///< .ulog.idx
+    QThread* m_writer = nullptr;
+
+    QMutex         m_mutex;             ///< Guards m_stage and m_stopping.
+    QWaitCondition m_wake;
+    Stage          m_stage;             ///< Filled by record().
+    Stage          m_spare;             ///< Owned by the writer while it writes.
+    bool           m_stopping = false;
+
+    std::atomic<bool>    m_recording{false};
+    std::atomic<quint64> m_framesWritten{0};
+    std::atomic<quint64> m_bytesWritten{0};
+    std::atomic<quint64> m_framesDropped{0};
+
+    QTimer m_statsTimer;                ///< Periodic statsChanged() on the GUI thread.
+};
+
+#endif // FLIGHTRECORDER_H
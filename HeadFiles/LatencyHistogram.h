@@ -0,0 +1,70 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QtGlobal>
+#include <QtCore/qalgorithms.h>
+#include <array>
+#include <limits>
+
+/**
+ * @brief LatencyHistogram
+ * HDR-style log-linear histogram of nanosecond latencies: exact below 64 ns, then 32
+ * linear sub-buckets per power of two (≤ 3.2 % relative error) up to ~18 minutes.
+ * record() is a bit scan and an increment, so it can sit on every packet; memory is
+ * fixed (~9.5 KB) and never allocates. Not thread-safe: one writer, readers on the
+ * same thread.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int kSubBits    = 5;                   ///< log2(sub-buckets per octave).
+    static constexpr int kSubCount   = 1 << kSubBits;       ///< 32.
+    static constexpr int kLinearMax  = 2 * kSubCount;       ///< Values below this are exact.
+    static constexpr int kMaxMsb     = 40;                  ///< 2^40 ns ≈ 18 min; larger saturates.
+    static constexpr int kBuckets    = kLinearMax + (kMaxMsb - kSubBits) * kSubCount;
+
+    /// Add one sample (negative values count as 0).
+    void record(qint64 ns) {
+        const quint64 v = ns > 0 ? quint64(ns) : 0;
+        ++m_counts[bucketOf(v)];
+        ++m_count;
+        m_sum += v;
+        if (v < m_min) m_min = v;
+        if (v > m_max) m_max = v;
+    }
+
+    quint64 count() const { return m_count; }
+    qint64  min() const { return m_count ? qint64(m_min) : 0; }
+    qint64  max() const { return qint64(m_max); }
+    double  mean() const { return m_count ? double(m_sum) / double(m_count) : 0.0; }
+
+    /// Value at percentile p (0..100): midpoint of the bucket holding it, clamped to [min, max].
+    qint64 percentile(double p) const;
+
+    /// Add other's samples to this histogram.
+    void merge(const LatencyHistogram& other);
+
+    void reset();
+
+private:
+    static int bucketOf(quint64 v) {
+        if (v < quint64(kLinearMax))
+            return int(v);
+        const int msb = 63 - qCountLeadingZeroBits(v);
+        if (msb > kMaxMsb)
+            return kBuckets - 1;
+        const int shift = msb - kSubBits;                   // ≥ 1 here
+        const int sub   = int(v >> shift) - kSubCount;      // 0..kSubCount-1
+        return kLinearMax + (shift - 1) * kSubCount + sub;
+    }
+
+    /// Inclusive value range covered by bucket i.
+    static void bucketRange(int i, quint64* lo, quint64* hi);
+
+    std::array<quint64, kBuckets> m_counts{};
+    quint64 m_count = 0;
+    quint64 m_sum   = 0;
+    quint64 m_min   = std::numeric_limits<quint64>::max();
+    quint64 m_max   = 0;
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,117 @@
+#ifndef LATENCYMONITOR_H
+#define LATENCYMONITOR_H
+
+#include <QMap>
+#include <QObject>
+#include <QPointer>
+#include <QQuickWindow>
+#include <QTimer>
+#include <QVariantList>
+#include <array>
+#include <vector>
+
+#include "DownlinkRecord.h"
+#include "LatencyHistogram.h"
+
+/**
+ * @brief LatencyMonitor
+ * Per-packet latency breakdown of the downlink path, one LatencyHistogram per stage and
+ * per link (plus an all-links aggregate):
+ *
+ *   Link      sender timestamp_ms → readyRead   (only with a monotonic sender clock, i.e.
+ *                                               the simulator's --stamp-monotonic)
+ *   Framing   readyRead → delimiter found       (driver backlog drained in one read)
+ *   Decode    delimiter → decode done           (COBS + CRC + nanopb on the I/O thread)
+ *   Handoff   decode done → model updated       (SPSC queue + GUI thread wake-up)
+ *   Render    model updated → frame swapped     (coalesced notify, bindings, scene graph)
+ *   Total     readyRead → frame swapped
+ *
+ * Lives on the GUI thread; SensorDataModel feeds it and the window's frameSwapped()
+ * (render thread) closes the loop. Summaries are refreshed for QML once a second.
+ */
+class LatencyMonitor : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(QVariantList stages READ stages NOTIFY updated)
+    Q_PROPERTY(bool senderClockMonotonic READ senderClockMonotonic WRITE setSenderClockMonotonic NOTIFY senderClockMonotonicChanged)
+    Q_PROPERTY(quint64 unrenderedDropped READ unrenderedDropped NOTIFY updated)
+
+public:
+    enum Stage { Link = 0, Framing, Decode, Handoff, Render, Total, StageCount };
+    Q_ENUM(Stage)
+
+    explicit LatencyMonitor(QObject* parent = nullptr);
+
+    /// Close "render" on this window's frameSwapped(); without one Render/Total stay empty.
+    void setWindow(QQuickWindow* window);
+
+    bool senderClockMonotonic() const { return m_senderMonotonic; }
+    void setSenderClockMonotonic(bool on);
+
+    /// Summary rows: [{stage, link (0 = all), count, p50Us, p99Us, maxUs, meanUs}].
+    QVariantList stages() const { return m_rows; }
+
+    /// Records that reached the model but were pushed out before a frame showed them.
+    quint64 unrenderedDropped() const { return m_unrenderedDropped; }
+
+    // -----------------------
+    // Feed (GUI thread)
+    // -----------------------
+
+    /// A decoded record was taken off the queue (stamps Link/Framing/Decode).
+    void recordDecoded(const DownlinkRecord& rec);
+
+    /// QML has been notified of every record passed to recordDecoded() so far (the model's
+    /// coalesced notification flush, not the drain).
+    void modelUpdated(qint64 ns);
+
+    // -----------------------
+    // Reports
+    // -----------------------
+
+    /// Human-readable table of every stage and link.
+    Q_INVOKABLE QString report() const;
+
+    /// Same data as JSON (nanoseconds); returns false if the file can't be written.
+    Q_INVOKABLE bool dump(const QString& path) const;
+
+    Q_INVOKABLE void reset();
+
+    static QString stageName(int stage);
+
+signals:
+    void updated();
+    void senderClockMonotonicChanged();
+
+private:
+    using StageSet = std::array<LatencyHistogram, StageCount>;
+
+    /// A record waiting for its stages downstream of the queue.
+    struct Pending {
+        int    which   = 0;
+        qint64 rxNs    = 0;
+        qint64 decNs   = 0;   ///< 0 when not decoded on the I/O thread.
+        qint64 modelNs = 0;   ///< 0 until modelUpdated().
+    };
+
+    void add(int which, int stage, qint64 ns);
+    void onFrameShown(qint64 swapNs);
+    void publish();
+
+    StageSet& forLink(int which);
+
+    StageSet           m_all;
+    QMap<int, StageSet> m_links;
+
+    std::vector<Pending> m_pending;   ///< In arrival order; [0, m_modeled) already in the model.
+    size_t               m_modeled = 0;
+    quint64              m_unrenderedDropped = 0;
+
+    bool    m_senderMonotonic = false;
+    bool    m_dirty = false;
+    QTimer  m_publishTimer;
+    QVariantList m_rows;
+    QPointer<QQuickWindow> m_window;
+    QMetaObject::Connection m_swapConn;
+};
+
+#endif // LATENCYMONITOR_H
@@ -0,0 +1,106 @@
+#ifndef LINKQUALITY_H
+#define LINKQUALITY_H
+
+#include <QVariantMap>
+#include <QtGlobal>
+#include <array>
+
+extern "C" {
+    #include "downlink.pb.h"
+}
+
+/**
+ * @brief LinkQuality
+ * Incremental link statistics for one link, fed by the framer and decoder on the I/O
+ * thread. Counters land in 250 ms buckets; the 1 s, 10 s and 60 s window sums are kept
+ * as running totals (add on arrival, subtract the bucket that slides out), so every
+ * update and every summary is O(1) however high the packet rate.
+ *
+ * Besides throughput and decode failures it infers loss two ways:
+ *  - missed telemetry from jumps in timestamp_ms against the learned send period;
+ *  - radio accounting: the rocket's radio_tx_count delta between two SystemStatus
+ *    messages vs. frames we framed in between (downlink), and our uplink frames vs. its
+ *    radio_rx_count delta (uplink).
+ */
+class LinkQuality {
+public:
+    static constexpr int kWindowCount = 3;
+    static constexpr std::array<int, kWindowCount> kWindowSec { 1, 10, 60 };
+
+    /// Bytes read from the transport.
+    void onBytes(quint64 n, qint64 nowNs);
+
+    /// One delimited frame (before decode).
+    void onFrame(qint64 nowNs);
+
+    /// Decode result of a frame; msg is only read when status is RP_CODEC_OK.
+    void onDecoded(int status, const tvr_Downlink& msg, qint64 nowNs);
+
+    /// One binary frame written towards the rocket.
+    void onUplinkFrame(qint64 nowNs);
+
+    /// Forget everything (link reopened).
+    void reset();
+
+    /// [{windowS, framesPerSec, bytesPerSec, decodeOk, decodeErrors, decodeErrorRate,
+    ///   missedTelemetry, downlinkSent, downlinkReceived, downlinkLoss, uplinkSent,
+    ///   uplinkReceived, uplinkLoss}, ...] for 1/10/60 s, plus lifetime totals.
+    QVariantMap summary(qint64 nowNs);
+
+private:
+    /// Everything counted per bucket.
+    struct Counters {
+        quint64 frames = 0;
+        quint64 bytes = 0;
+        quint64 decodeOk = 0;
+        quint64 decodeErrors = 0;
+        quint64 missedTelemetry = 0;
+        quint64 downlinkSent = 0;      ///< radio_tx_count deltas reported by the rocket.
+        quint64 downlinkReceived = 0;  ///< Our frames over the same status-to-status spans.
+        quint64 uplinkSent = 0;        ///< Our binary TX frames over those spans.
+        quint64 uplinkReceived = 0;    ///< radio_rx_count deltas reported by the rocket.
+
+        void add(const Counters& o, int sign);
+    };
+
+    static constexpr qint64 kBucketNs = 250000000;   ///< 250 ms.
+    static constexpr int    kBucketsPerSec = 4;
+    static constexpr int    kSlots = 256;            ///< Ring of buckets (> longest window).
+
+    /// Roll the ring forward to the bucket containing nowNs.
+    void advance(qint64 nowNs);
+
+    /// Count in the current bucket, every window and the lifetime totals.
+    template <typename Fn> void bump(Fn&& fn) {
+        fn(m_slots[size_t(m_bucket & (kSlots - 1))]);
+        for (auto& w : m_windows)
+            fn(w);
+        fn(m_total);
+    }
+
+    void onTelemetry(quint32 timestampMs);
+    void onStatus(const tvr_SystemStatus& s);
+
+    std::array<Counters, kSlots> m_slots{};
+    std::array<Counters, kWindowCount> m_windows{};
+    Counters m_total;
+    qint64   m_bucket = -1;             ///< Index of the newest bucket (-1: nothing yet).
+    qint64   m_firstNs = 0;
+    std::array<quint64, 16> m_errorsByStatus{}; ///< Lifetime decode failures per rp_codec status.
+
+    // Telemetry gap inference
+    bool    m_haveTelemetry = false;
+    quint32 m_lastTelemetryMs = 0;
+    double  m_periodMs = 0.0;          ///< Learned TelemetryState period (EWMA of normal gaps).
+    qint32  m_lastGapMs = 0;
+    int     m_gapStreak = 0;           ///< Identical "gaps" in a row (the sender changed rate).
+
+    // Radio counter accounting between SystemStatus messages
+    bool    m_haveStatus = false;
+    quint32 m_lastRadioTx = 0;
+    quint32 m_lastRadioRx = 0;
+    quint64 m_framesSinceStatus = 0;
+    quint64 m_uplinkSinceStatus = 0;
+};
+
+#endif // LINKQUALITY_H
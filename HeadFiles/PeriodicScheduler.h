@@ -0,0 +1,124 @@
+#ifndef PERIODICSCHEDULER_H
+#define PERIODICSCHEDULER_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <QVariantList>
+#include <QVariantMap>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "LatencyHistogram.h"
+#include "TxQueue.h"
+
+class QThread;
+class SerialBridge;
+
+/**
+ * @brief PeriodicScheduler
+ * Drives any number of periodic TX streams (text lines or pre-encoded binary frames)
+ * from one dedicated timing thread. Tick k of a stream is due at start + k / hz, computed
+ * from k every time, so the long-run rate is exact for any hz (150 Hz is 150 Hz, not the
+ * 166 Hz of a 6 ms timer) and timer lateness never accumulates. The thread sleeps until
+ * the earliest deadline of all streams and hands each due payload straight to the
+ * bridge's I/O thread (Periodic TX class, coalesced per stream).
+ *
+ * Per stream it records the wake-up lateness against the scheduled deadline in a
+ * LatencyHistogram, the ticks sent, the ticks skipped after a stall (sent once, not in a
+ * burst) and the rate actually achieved. The public API is for the GUI thread; stats are
+ * refreshed for QML once a second.
+ */
+class PeriodicScheduler : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(QVariantList streams READ streams NOTIFY streamsChanged)
+
+public:
+    explicit PeriodicScheduler(SerialBridge* bridge, QObject* parent = nullptr);
+
+    /// Stops the timing thread.
+    ~PeriodicScheduler() override;
+
+    /// Send text (LF appended if missing) on link `which` at hz; returns the stream id (> 0) or 0.
+    Q_INVOKABLE int startText(int which, const QString& text, double hz);
+
+    /// Send an encoded packet on link `which` at hz; returns the stream id (> 0) or 0.
+    Q_INVOKABLE int startBinary(int which, const QByteArray& data, double hz);
+
+    /// Common form of the above; payload is sent as-is (and shared, never copied). label
+    /// names the stream in streams() (default: the text, or the binary size).
+    int start(int which, const QByteArray& payload, bool text, double hz,
+              int priority = TxQueue::Periodic, const QString& label = QString());
+
+    /// Stop a stream; its final statistics stay listed until more streams are started.
+    Q_INVOKABLE void stop(int id);
+
+    /// Stop every stream on link `which` (e.g. it disconnected).
+    Q_INVOKABLE void stopLink(int which);
+
+    Q_INVOKABLE void stopAll();
+
+    Q_INVOKABLE bool isRunning(int id) const;
+
+    /// True while a binary (command packet) stream is running on any link.
+    bool sendsPackets() const;
+
+    /// [{id, which, text, label, running, hz, sent, missed, achievedHz,
+    ///   latenessP50Us, latenessP99Us, latenessMaxUs}] (refreshed once a second).
+    QVariantList streams() const { return m_rows; }
+
+    /// Current statistics of one stream (same keys as streams()), empty if unknown.
+    Q_INVOKABLE QVariantMap stats(int id) const;
+
+signals:
+    void streamsChanged();
+
+private:
+    struct Stream {
+        int        id = 0;
+        int        which = 0;
+        QByteArray payload;
+        QByteArray key;                ///< Coalesce key: a stalled link holds one tick per stream.
+        QString    label;
+        bool       text = false;
+        int        priority = TxQueue::Periodic;
+        double     hz = 0.0;
+        bool       running = true;
+        qint64     startNs = 0;
+        qint64     stopNs = 0;
+        quint64    slot = 0;           ///< Index of the next tick.
+        qint64     nextNs = 0;         ///< Deadline of that tick.
+        quint64    sent = 0;
+        quint64    missed = 0;
+        LatencyHistogram lateness;     ///< Wake-up time minus deadline.
+    };
+
+    /// Timing thread body.
+    void run();
+
+    qint64 slotTime(const Stream& s, quint64 slot) const {
+        return s.startNs + qint64(double(slot) * 1e9 / s.hz);
+    }
+
+    QVariantMap rowOf(const Stream& s, qint64 nowNs) const;  ///< Caller holds m_mutex.
+    void publish();
+    void pruneStopped();                                     ///< Caller holds m_mutex.
+
+    QPointer<SerialBridge> m_bridge;
+    SerialBridge* m_post = nullptr;    ///< Same bridge, used from the timing thread.
+
+    mutable std::mutex m_mutex;        ///< Guards m_streams and m_quit.
+    std::condition_variable m_wake;    ///< Signalled when streams change or on shutdown.
+    std::vector<std::unique_ptr<Stream>> m_streams;
+    bool m_quit = false;
+    int  m_nextId = 1;
+
+    QThread*     m_thread = nullptr;
+    QTimer       m_publishTimer;
+    QVariantList m_rows;
+};
+
+#endif // PERIODICSCHEDULER_H
@@ -0,0 +1,135 @@
+#ifndef PORTDISCOVERY_H
+#define PORTDISCOVERY_H
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QSerialPortInfo>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+#include <memory>
+#include <vector>
+
+class QSerialPort;
+class QSocketNotifier;
+
+/**
+ * @brief PortDiscovery
+ * Finds radio modems without ever blocking the GUI thread. Lives on SerialBridge's
+ * discovery thread: port enumeration, hotplug watching and probing all happen there,
+ * and results come back incrementally as portAdded / portRemoved.
+ *
+ * Hotplug: on Linux an inotify watch on /dev triggers a rescan shortly after a device
+ * node appears, disappears or gets its permissions from udev; elsewhere (or if inotify
+ * is unavailable) ports are polled once a second.
+ *
+ * Classification: known USB-UART bridges (FTDI, CP210x) are listed at once and Bluetooth
+ * ports are skipped. Every other port is probed with the SiK AT handshake (guard time,
+ * "+++", "OK", ATI for the identity, ATO back to data mode). All probes run at the same
+ * time as non-blocking state machines on this thread, each bounded by its own timeouts.
+ * Verdicts are cached by USB serial number (or VID:PID at the USB location when the
+ * device has none), so a radio plugged back in is listed without a second probe.
+ *
+ * A probe interrupted after "+++" leaves the radio heading into command mode, so it is
+ * released only once the guard time has passed and ATO has put the radio back in data
+ * mode. setBusyPorts() is the one call made from another thread: it never waits for
+ * this thread, it only reports whether a probe still holds one of the ports.
+ */
+class PortDiscovery : public QObject {
+    Q_OBJECT
+
+public:
+    explicit PortDiscovery(QObject* parent = nullptr);
+    ~PortDiscovery() override;
+
+    /// Heuristic verdict from the USB descriptors alone.
+    enum Verdict { NotRadio = 0, Radio, Unknown };
+    static Verdict classify(const QSerialPortInfo& info);
+
+    /// Cache key of a port: its USB serial number, else VID:PID@location.
+    static QString cacheKey(const QSerialPortInfo& info);
+
+    static constexpr int kProbeBaud       = 57600; ///< SiK factory default.
+    static constexpr int kGuardMs         = 1100;  ///< Silence required before "+++".
+    static constexpr int kEscapeTimeoutMs = 1500;  ///< Wait for "OK" after "+++".
+    static constexpr int kIdentTimeoutMs  = 500;   ///< Wait for the ATI reply.
+    static constexpr int kSettleMs        = 150;   ///< Hotplug debounce before a rescan.
+    static constexpr int kPollMs          = 1000;  ///< Rescan period without inotify.
+
+public slots:
+    /// Set up the hotplug watch and do the first scan (call on the discovery thread).
+    void start();
+
+    /// Enumerate ports now and report what changed.
+    void rescan();
+
+    /// Thread-safe. Ports held (or about to be opened) by the application: never probed,
+    /// listed as they are. Returns false if a probe still holds one of them; that probe is
+    /// then released as soon as the radio is safely back in data mode.
+    bool setBusyPorts(const QStringList& names);
+
+    /// Forget all cached probe verdicts (the next scan probes unknown ports again).
+    void clearCache();
+
+signals:
+    /// A radio port appeared (serial: USB serial number or empty; ident: ATI reply or empty).
+    void portAdded(const QString& name, const QString& serial, const QString& ident);
+
+    /// A previously reported port disappeared.
+    void portRemoved(const QString& name);
+
+private:
+    /// Cached verdict per device.
+    struct Verdicts {
+        bool    radio = false;
+        QString ident;
+    };
+
+    /// One running AT handshake.
+    struct Probe {
+        QString      name;
+        QString      key;
+        QString      serial;
+        QSerialPort* port = nullptr;
+        QTimer*      timer = nullptr;
+        int          stage = 0;        ///< 0 guard, 1 wait "OK", 2 wait ATI reply, 3 releasing.
+        QByteArray   reply;
+        QElapsedTimer sinceEscape;     ///< Since "+++" was written.
+    };
+
+    void startProbe(const QSerialPortInfo& info, const QString& key);
+    void advanceProbe(Probe* p, bool timedOut);
+    void finishProbe(Probe* p, bool radio);
+
+    /// Leave command mode if needed, close the port and drop the probe. After "+++" but
+    /// before "OK" the port is kept until the guard time has passed (stage 3).
+    void abortProbe(size_t index);
+    void closeProbe(size_t index);
+
+    /// Abort probes of ports that became busy (queued from setBusyPorts()).
+    void releaseBusy();
+    bool isBusy(const QString& name) const;
+    Probe* probeFor(QSerialPort* port);
+
+    /// Read pending inotify events and schedule a rescan.
+    void onDevEvent();
+
+    void report(const QString& name, const QString& serial, const QString& ident);
+
+    QHash<QString, Verdicts> m_cache;          ///< By cacheKey().
+    QHash<QString, QString>  m_reported;       ///< Listed port name → serial number.
+    QSet<QString>            m_seen;           ///< Names present at the last scan.
+    mutable QMutex           m_busyMutex;      ///< Guards m_busy and m_probing.
+    QSet<QString>            m_busy;
+    QSet<QString>            m_probing;        ///< Names a probe holds open.
+    std::vector<std::unique_ptr<Probe>> m_probes;
+
+    QTimer m_settle;                           ///< Debounces hotplug bursts.
+    QTimer m_poll;                             ///< Fallback when there is no inotify.
+    int    m_inotifyFd = -1;
+    QSocketNotifier* m_devNotifier = nullptr;
+};
+
+#endif // PORTDISCOVERY_H
@@ -0,0 +1,44 @@
+#ifndef PTYTRANSPORT_H
+#define PTYTRANSPORT_H
+
+#include "Transport.h"
+
+class QSocketNotifier;
+
+/**
+ * @brief PtyTransport
+ * Creates a pseudo-terminal pair and uses the master side as the link; a simulator or
+ * test harness opens describe() (the slave path, e.g. /dev/pts/7) like a serial port.
+ * The slave is kept open internally so the master never sees EIO between peers.
+ * Unix only; open() fails elsewhere.
+ */
+class PtyTransport : public Transport {
+    Q_OBJECT
+
+public:
+    explicit PtyTransport(QObject* parent = nullptr);
+    ~PtyTransport() override;
+
+    bool open() override;
+    void close() override;
+    bool isOpen() const override { return m_master >= 0; }
+
+    qint64 read(char* dst, qint64 max) override;
+    qint64 write(const char* data, qint64 size) override;
+
+    QString describe() const override { return m_slavePath.isEmpty() ? QStringLiteral("pty") : m_slavePath; }
+    QString errorString() const override { return m_error; }
+
+    /// Slave device path peers should open (empty until open()).
+    QString slavePath() const { return m_slavePath; }
+
+private:
+    int m_master = -1;
+    int m_slave  = -1;
+    QString m_slavePath;
+    QString m_error;
+    QSocketNotifier* m_notifier = nullptr;
+    QSocketNotifier* m_writeNotifier = nullptr; ///< Armed only while the pty buffer is full.
+};
+
+#endif // PTYTRANSPORT_H
@@ -0,0 +1,115 @@
+#ifndef RAWPACKETLOGMODEL_H
+#define RAWPACKETLOGMODEL_H
+
+#include <QAbstractListModel>
+#include <vector>
+
+#include "DownlinkRecord.h"
+
+/**
+ * @brief RawPacketLogModel
+ * Bounded, virtualized log of received downlink packets for RadioOutputWindow.
+ * Decoded records are kept in a fixed-capacity ring and only formatted to text in data(),
+ * i.e. for the rows a ListView actually instantiates. Appends are staged and published in
+ * one insert/remove batch per flush(), so a burst costs one layout pass, not one per packet.
+ * The row index is a second ring of the same capacity: append() and flush() never allocate.
+ */
+class RawPacketLogModel : public QAbstractListModel {
+    Q_OBJECT
+
+    Q_PROPERTY(int  count     READ count     NOTIFY countChanged)
+    Q_PROPERTY(int  retention READ retention WRITE setRetention NOTIFY retentionChanged)
+    Q_PROPERTY(int  filter    READ filter    WRITE setFilter    NOTIFY filterChanged)
+    Q_PROPERTY(bool following READ following WRITE setFollowing NOTIFY followingChanged)
+    Q_PROPERTY(quint64 totalReceived READ totalReceived NOTIFY countChanged)
+
+public:
+    /// Payload-type filter values for the `filter` property.
+    enum Filter {
+        AllPackets = 0,
+        TelemetryOnly,
+        StatusOnly,
+        ErrorsOnly
+    };
+    Q_ENUM(Filter)
+
+    enum Roles {
+        KindRole = Qt::UserRole + 1, ///< "TELEM", "STATUS" or "ERROR".
+        RxTimeRole                   ///< Ground receive time, ms since the first packet.
+    };
+
+    explicit RawPacketLogModel(QObject* parent = nullptr);
+
+    // -----------------------
+    // QAbstractListModel
+    // -----------------------
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    // -----------------------
+    // Producer API (SensorDataModel)
+    // -----------------------
+
+    /// Stage one record; it becomes visible on the next flush().
+    void append(const DownlinkRecord& rec);
+
+    /// Publish everything staged since the last flush as one batch of row changes.
+    void flush();
+
+    // -----------------------
+    // QML API
+    // -----------------------
+
+    /// Drop all retained packets.
+    Q_INVOKABLE void clear();
+
+    int count() const { return int(m_viewCount); }
+
+    int retention() const { return int(m_ring.size()); }
+    void setRetention(int packets);
+
+    int filter() const { return m_filter; }
+    void setFilter(int filter);
+
+    /// True while the view should stay pinned to the newest row (auto-scroll).
+    bool following() const { return m_following; }
+    void setFollowing(bool following);
+
+    quint64 totalReceived() const { return m_nextSeq; }
+
+    /// Human-readable one-line rendering of a record (used lazily by data()).
+    static QString formatRecord(const DownlinkRecord& rec);
+
+signals:
+    void countChanged();
+    void retentionChanged();
+    void filterChanged();
+    void followingChanged();
+
+private:
+    const DownlinkRecord& recordAt(quint64 seq) const { return m_ring[seq % m_ring.size()]; }
+    quint64& rowSeq(size_t row) { return m_view[(m_viewHead + row) % m_view.size()]; }
+    quint64 rowSeq(size_t row) const { return m_view[(m_viewHead + row) % m_view.size()]; }
+    bool matches(const DownlinkRecord& rec) const;
+
+    /// Rebuild m_view from the ring (filter or retention change).
+    void rebuildView();
+
+    std::vector<DownlinkRecord> m_ring; ///< Retained records, slot = seq % size.
+    quint64 m_firstSeq = 0;             ///< Oldest sequence number still in the ring.
+    quint64 m_nextSeq  = 0;             ///< Sequence number of the next appended record.
+
+    std::vector<quint64> m_view;        ///< Published rows → sequence numbers (filtered), a ring
+                                        ///< as large as m_ring: row r is at m_viewHead + r.
+    size_t  m_viewHead  = 0;
+    size_t  m_viewCount = 0;
+    quint64 m_stagedSeq = 0;            ///< Records from here on are staged, not yet published.
+
+    qint64 m_epochNs   = 0;             ///< rxNs of the first packet, for relative times.
+    int    m_filter    = AllPackets;
+    bool   m_following = true;
+};
+
+#endif // RAWPACKETLOGMODEL_H
@@ -0,0 +1,74 @@
+#ifndef RECORDINGFORMAT_H
+#define RECORDINGFORMAT_H
+
+#include <QtGlobal>
+
+/**
+ * On-disk layout of flight recordings written by FlightRecorder (little-endian,
+ * naturally aligned, written as raw structs).
+ *
+ *   <name>.ulog : FileHeader, then ChunkHeader + payload, ChunkHeader + payload, ...
+ *                 payload = FrameHeader + frame bytes (padded to 8), repeated frameCount times
+ *   <name>.ulog.idx : IndexHeader, then one IndexEntry per chunk (sidecar for fast seeking)
+ *
+ * Frames are the raw COBS bytes exactly as received, delimiter included. A chunk whose
+ * payload is shorter than payloadBytes is a torn write (crash) and ends the recording.
+ */
+namespace recording {
+
+constexpr char    kFileMagic[8]  = { 'U', 'L', 'Y', 'R', 'E', 'C', '1', '\0' };
+constexpr char    kIndexMagic[8] = { 'U', 'L', 'Y', 'I', 'D', 'X', '1', '\0' };
+constexpr quint32 kChunkMagic    = 0x43594C55; // "ULYC"
+constexpr quint32 kVersion       = 1;
+
+struct FileHeader {
+    char    magic[8];
+    quint32 version;
+    quint32 reserved;
+    qint64  createdUtcMs;   ///< Wall-clock time the recording started.
+    qint64  startRxNs;      ///< Monotonic ground clock at the same instant.
+};
+
+struct ChunkHeader {
+    quint32 magic;
+    quint32 frameCount;
+    quint32 payloadBytes;
+    quint32 reserved;
+    qint64  firstRxNs;
+    qint64  lastRxNs;
+};
+
+struct FrameHeader {
+    qint64  rxNs;           ///< Monotonic ground receive time.
+    quint16 length;         ///< Frame bytes that follow (before padding).
+    quint8  port;           ///< Link index the frame arrived on.
+    quint8  flags;
+    quint32 reserved;
+};
+
+struct IndexHeader {
+    char    magic[8];
+    quint32 version;
+    quint32 reserved;
+};
+
+struct IndexEntry {
+    quint64 offset;         ///< File offset of the ChunkHeader.
+    qint64  firstRxNs;
+    qint64  lastRxNs;
+    quint32 frameCount;
+    quint32 payloadBytes;
+};
+
+static_assert(sizeof(FileHeader)  == 32, "FileHeader layout");
+static_assert(sizeof(ChunkHeader) == 32, "ChunkHeader layout");
+static_assert(sizeof(FrameHeader) == 16, "FrameHeader layout");
+static_assert(sizeof(IndexHeader) == 16, "IndexHeader layout");
+static_assert(sizeof(IndexEntry)  == 32, "IndexEntry layout");
+
+/// Frame bytes are padded so every FrameHeader stays 8-byte aligned.
+constexpr quint32 paddedLength(quint32 length) { return (length + 7u) & ~7u; }
+
+} // namespace recording
+
+#endif // RECORDINGFORMAT_H
@@ -0,0 +1,150 @@
+#ifndef REPLAYENGINE_H
+#define REPLAYENGINE_H
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QObject>
+#include <QTimer>
+#include <QVariantList>
+#include <vector>
+
+#include "SerialBridge.h"
+
+/**
+ * @brief ReplayEngine
+ * Plays a FlightRecorder recording back through the live RX path: frames are injected
+ * into the I/O thread (SerialBridge::injectFrames) and decoded exactly like radio data,
+ * so SensorDataModel, the packet log and binaryPacketReceived listeners all see them.
+ * The I/O thread reads them straight from the mapped file; nothing is copied per frame.
+ *
+ * open() maps the file and builds a per-frame index (receive time, rocket timestamp_ms,
+ * payload kind, flight state); a recording made with several radios is merged into the
+ * combined stream there (first copy of each packet from any link, see DiversityCombiner).
+ * Seeking is a binary search over that index; after a
+ * seek the newest telemetry and status frames before the target are injected, primed,
+ * so every panel shows the state at that instant without the packet log, history,
+ * alarms or command tracker counting them again. Playback runs at 0.1x-100x of recorded
+ * time or as fast as possible; the latter is paced by the record queue (one batch at a
+ * time, only while the GUI has drained enough room), so no sample is dropped.
+ */
+class ReplayEngine : public QObject {
+    Q_OBJECT
+
+    Q_PROPERTY(bool    loaded         READ isLoaded       NOTIFY loadedChanged)
+    Q_PROPERTY(QString filePath       READ filePath       NOTIFY loadedChanged)
+    Q_PROPERTY(int     frameCount     READ frameCount     NOTIFY loadedChanged)
+    Q_PROPERTY(double  durationMs     READ durationMs     NOTIFY loadedChanged)
+    Q_PROPERTY(bool    playing        READ isPlaying      NOTIFY playingChanged)
+    Q_PROPERTY(int     frameIndex     READ frameIndex     NOTIFY positionChanged)
+    Q_PROPERTY(double  positionMs     READ positionMs     NOTIFY positionChanged)
+    Q_PROPERTY(int     flightState    READ flightState    NOTIFY positionChanged)
+    Q_PROPERTY(double  speed          READ speed          WRITE setSpeed          NOTIFY speedChanged)
+    Q_PROPERTY(bool    fastAsPossible READ fastAsPossible WRITE setFastAsPossible NOTIFY speedChanged)
+
+public:
+    explicit ReplayEngine(SerialBridge* bridge, QObject* parent = nullptr);
+    ~ReplayEngine() override;
+
+    // -----------------------
+    // QML API
+    // -----------------------
+
+    /// Load a .ulog recording (accepts a path or a file:// URL string); returns true on success.
+    Q_INVOKABLE bool open(const QString& path);
+
+    /// Stop playback and release the recording.
+    Q_INVOKABLE void close();
+
+    Q_INVOKABLE void play();
+    Q_INVOKABLE void pause();
+
+    /// Inject the next / previous count frames while paused.
+    Q_INVOKABLE void step(int count = 1);
+
+    /// Seek to a time relative to the first frame (ms); O(log n).
+    Q_INVOKABLE void seek(double positionMs);
+
+    /// Seek to an absolute frame index.
+    Q_INVOKABLE void seekFrame(int index);
+
+    /// Seek to the first frame where the rocket reported state (occurrence-th entry, 0-based).
+    /// Returns false if the recording never enters that state.
+    Q_INVOKABLE bool seekToFlightState(int state, int occurrence = 0);
+
+    /// [{positionMs, state}] for every flight-state transition (for scrub bar markers).
+    Q_INVOKABLE QVariantList flightStateMarks() const;
+
+    // -----------------------
+    // Property getters/setters
+    // -----------------------
+
+    bool    isLoaded() const { return !m_frames.empty(); }
+    QString filePath() const { return m_file.fileName(); }
+    int     frameCount() const { return int(m_frames.size()); }
+    double  durationMs() const;
+    bool    isPlaying() const { return m_timer.isActive(); }
+    int     frameIndex() const { return int(m_next); }
+    double  positionMs() const;
+    int     flightState() const;
+    double  speed() const { return m_speed; }
+    void    setSpeed(double speed);
+    bool    fastAsPossible() const { return m_fast; }
+    void    setFastAsPossible(bool fast);
+
+signals:
+    void loadedChanged();
+    void playingChanged();
+    void positionChanged();
+    void speedChanged();
+    void finished();
+    void errorMessage(const QString& msg);
+
+private:
+    /// Payload kind of an indexed frame.
+    enum Kind : quint8 { KindError = 0, KindTelemetry, KindStatus };
+
+    /// One indexed frame inside the mapped recording (its bytes: m_spans, same index).
+    struct FrameRef {
+        qint64  rxNs;          ///< Recorded ground receive time.
+        quint32 timestampMs;   ///< Rocket timestamp_ms (0 for decode errors).
+        quint8  kind;
+        int     flightState;   ///< Last flight state reported at or before this frame.
+    };
+
+    /// Walk chunks of the mapped file and fill m_frames/m_marks; returns false if unreadable.
+    bool buildIndex(qint64 fileSize);
+
+    /// Playback timer: inject every frame due at the current media time (fast: the next
+    /// batch once the previous one is decoded and the record queue has room for it).
+    void tick();
+
+    /// Inject frames [from, to) in one batch, read in place from the mapping; primed
+    /// frames only restore state (DownlinkRecord::primed).
+    void inject(size_t from, size_t to, bool primed = false);
+
+    /// Move the play head to index and re-prime the display state; keeps the play/pause state.
+    void moveTo(size_t index);
+
+    /// Re-anchor the media clock at the current frame (after seek/speed change).
+    void resetClock();
+
+    SerialBridge* m_bridge = nullptr;
+
+    QFile        m_file;
+    const uchar* m_map = nullptr;
+
+    std::vector<FrameRef> m_frames;
+    std::vector<SerialBridge::InjectedFrame> m_spans; ///< File offset, length and port per frame.
+    std::vector<size_t>   m_marks;       ///< Frame indices where flightState changes.
+    int                   m_pendingBatches = 0; ///< Injected batches the I/O thread has not finished.
+
+    size_t m_next  = 0;                  ///< Next frame to inject.
+    double m_speed = 1.0;
+    bool   m_fast  = false;
+
+    QTimer        m_timer;
+    QElapsedTimer m_clock;               ///< Wall time since resetClock().
+    qint64        m_anchorNs = 0;        ///< Recorded rxNs that corresponds to m_clock == 0.
+};
+
+#endif // REPLAYENGINE_H
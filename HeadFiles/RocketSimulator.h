@@ -0,0 +1,150 @@
+#ifndef ROCKETSIMULATOR_H
+#define ROCKETSIMULATOR_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+#include <random>
+#include <vector>
+
+#include "RxRing.h"
+
+extern "C" {
+    #include "downlink.pb.h"
+}
+
+class Transport;
+
+/**
+ * @brief RocketSimulator
+ * Fake vehicle for end-to-end tests without a radio. Streams COBS+protobuf tvr_Downlink
+ * (TelemetryState and SystemStatus at independent rates, up to kHz) into a Transport —
+ * by default a new pty whose slave path the GCS opens like a serial port — following a
+ * scripted flight profile. Uplink tvr_FlightCommand frames are decoded, counted in
+ * cmd_rx_count and steer the profile (Launch / Abort / Land).
+ *
+ * Impairments are applied to the encoded byte stream: independent bit errors at a given
+ * bit error rate and dropped bytes at a given per-byte rate.
+ *
+ * With stampMonotonic, timestamp_ms carries the low 32 bits of the steady clock in ms
+ * (the same clock as the ground's monotonicNs()) taken when the frame is encoded, so
+ * the GCS can measure true end-to-end latency on the same machine.
+ */
+class RocketSimulator : public QObject {
+    Q_OBJECT
+
+public:
+    enum class Profile {
+        Pad,     ///< IDLE on the pad forever (status + telemetry only).
+        Hop,     ///< IDLE → RISE → HOVER → LOWER → IDLE.
+        Hover,   ///< RISE then HOVER indefinitely.
+        Abort,   ///< RISE interrupted by ESTOP.
+    };
+
+    struct Options {
+        QString link  = QStringLiteral("pty");  ///< Transport spec (see Transport::create()).
+        int     baud  = 57600;
+        double  telemetryHz  = 10.0;
+        double  statusHz     = 1.0;
+        Profile profile      = Profile::Hop;
+        bool    loop         = true;    ///< Restart the profile when it ends.
+        bool    waitLaunch   = false;   ///< Hold on the pad until a Launch command arrives.
+        double  bitErrorRate = 0.0;     ///< Probability each transmitted bit is flipped.
+        double  dropRate     = 0.0;     ///< Probability each transmitted byte is lost.
+        bool    stampMonotonic = false; ///< timestamp_ms = monotonic send time (see class doc).
+        quint32 seed = 1;
+    };
+
+    struct Stats {
+        quint64 telemetrySent  = 0;
+        quint64 statusSent     = 0;
+        quint64 bytesSent      = 0;
+        quint64 framesOverrun  = 0;   ///< Frames dropped because the peer wasn't reading.
+        quint64 bitsFlipped    = 0;
+        quint64 bytesDropped   = 0;
+        quint64 uplinkFrames   = 0;
+        quint64 commandsRx     = 0;   ///< Valid FlightCommands (reported as cmd_rx_count).
+        quint64 uplinkErrors   = 0;
+    };
+
+    explicit RocketSimulator(const Options& options, QObject* parent = nullptr);
+    ~RocketSimulator() override;
+
+    /// Parse a profile name (pad, hop, hover, abort).
+    static bool parseProfile(const QString& name, Profile* out);
+
+    /// Open the link and start streaming; *error receives the reason on failure.
+    bool start(QString* error = nullptr);
+    void stop();
+
+    /// What the GCS should open (pty slave path, udp spec, ...).
+    QString linkDescription() const;
+
+    const Stats& stats() const { return m_stats; }
+    int flightState() const { return m_phase.state; }
+
+signals:
+    /// A valid FlightCommand state command was received.
+    void commandReceived(int type);
+
+private:
+    /// One segment of the flight script: altitude eases from altFrom to altTo.
+    struct Phase {
+        int    state      = 0;     ///< Flight state reported while in this phase.
+        qint64 durationMs = 0;     ///< <= 0: hold forever.
+        float  altFrom    = 0.0f;
+        float  altTo      = 0.0f;
+        qint64 startMs    = 0;     ///< Filled in when the phase is entered.
+    };
+
+    void tick();
+    void onReadyRead();
+    void applyCommand(int type);
+
+    /// Replace the running script and enter its first phase at nowMs.
+    void runScript(std::vector<Phase> script, qint64 nowMs);
+    std::vector<Phase> profileScript(bool skipPad) const;
+    void advance(qint64 nowMs);
+
+    void fillTelemetry(tvr_Downlink& msg, qint64 nowMs);
+    void fillStatus(tvr_Downlink& msg, qint64 nowMs);
+
+    /// Encode, impair and queue one message; returns false if the TX backlog is full.
+    bool send(tvr_Downlink& msg);
+
+    /// Push the TX backlog into the transport.
+    void drainTx();
+
+    /// Bit errors and byte drops on an encoded frame (appended to m_tx).
+    void impairAndQueue(const uint8_t* data, size_t size);
+
+    /// Distance to the next event of a Bernoulli(p) process (geometric draw).
+    quint64 skip(double p);
+
+    Options       m_opt;
+    Transport*    m_link = nullptr;
+    QTimer        m_timer;
+    QElapsedTimer m_clock;
+    RxRing        m_rx;
+    QByteArray    m_tx;               ///< Bytes the transport hasn't accepted yet.
+
+    std::vector<Phase> m_script;
+    size_t        m_phaseIndex = 0;
+    Phase         m_phase;
+    float         m_altitude = 0.0f;
+    float         m_climbRate = 0.0f;
+
+    quint64 m_telemetrySlots = 0;     ///< Rate slots served since start (drift-free pacing).
+    quint64 m_statusSlots    = 0;
+
+    std::mt19937_64 m_rng;
+    quint64 m_bitPos     = 0;         ///< Bits sent so far (impairment positions are absolute).
+    quint64 m_nextFlip   = 0;         ///< Bit index of the next bit error.
+    quint64 m_bytePos    = 0;
+    quint64 m_nextDrop   = 0;         ///< Byte index of the next dropped byte.
+
+    Stats m_stats;
+};
+
+#endif // ROCKETSIMULATOR_H
@@ -0,0 +1,128 @@
+#ifndef RXRING_H
+#define RXRING_H
+
+#include <QtGlobal>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief FrameView
+ * Non-owning view of one delimited frame (delimiter included). Points either into the
+ * RxRing storage or into its wrap scratch buffer; valid until the ring is next modified.
+ */
+struct FrameView {
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+};
+
+/**
+ * @brief RxSegment
+ * One unit of a mixed text/COBS stream (RxRing::nextSegment()). Either a run of complete
+ * text lines (text = true, every byte of `bytes`), or a 0x00-terminated segment whose
+ * first textPrefix bytes are complete printable lines that may be debug text printed in
+ * front of the frame, or may be the start of the frame itself.
+ */
+struct RxSegment {
+    FrameView bytes;
+    size_t    textPrefix = 0;
+    bool      text = false;
+};
+
+/**
+ * @brief RxRing
+ * Fixed-capacity byte ring used as the per-port RX framer.
+ * The serial driver reads straight into writeSpan(). nextSegment() is the RX path: it
+ * classifies each byte once through a lookup table (delimiter / newline / printable /
+ * binary), splitting COBS frames from the firmware text lines between them, and hands
+ * both out as FrameViews without copying; only a segment that straddles the wrap point
+ * is copied once into a contiguous scratch buffer. Every byte is scanned exactly once,
+ * so a large backlog is linear, not quadratic. nextFrame() (memchr for the delimiter)
+ * is for pure-COBS links with no text, such as the simulator's uplink.
+ */
+class RxRing {
+public:
+    /// capacity is rounded up to a power of two; maxFrame bounds bytes without a delimiter.
+    explicit RxRing(size_t capacity = 64 * 1024, size_t maxFrame = 512);
+
+    // -----------------------
+    // Producer side (driver reads)
+    // -----------------------
+
+    /// Contiguous free region to read into; *len receives its size (0 when full).
+    uint8_t* writeSpan(size_t* len);
+
+    /// Mark n bytes of the last writeSpan() as filled.
+    void commit(size_t n);
+
+    // -----------------------
+    // Consumer side (framing)
+    // -----------------------
+
+    /**
+     * Pure-COBS framing: extract the next frame terminated by delim (delimiter included).
+     * Returns false when no complete frame is buffered. A run of more than maxFrame()
+     * bytes without a delimiter is discarded and counted in oversizeDrops().
+     */
+    bool nextFrame(uint8_t delim, FrameView& out);
+
+    /**
+     * Mixed-mode framing for firmware that prints text lines between COBS frames. Each
+     * byte is classified once (delimiter / newline / printable / binary) while looking
+     * for the 0x00 delimiter, tracking how far the segment is made of complete printable
+     * lines. Pending lines with no delimiter behind them are only returned as text when
+     * flushText is set (the link went quiet) or they would exceed maxFrame(); otherwise
+     * they might still be the head of a frame. Don't mix with nextFrame() on one ring
+     * without a clear() in between.
+     */
+    bool nextSegment(RxSegment& out, bool flushText = false);
+
+    /// True if complete printable lines are buffered with no delimiter behind them.
+    bool hasPendingText() const { return m_textEnd > m_tail; }
+
+    /// Drop all buffered bytes (port closed / reopened).
+    void clear();
+
+    // -----------------------
+    // Configuration / stats
+    // -----------------------
+
+    void setMaxFrame(size_t maxFrame);
+    size_t maxFrame() const { return m_maxFrame; }
+    size_t capacity() const { return m_buf.size(); }
+    size_t size() const { return m_head - m_tail; }
+
+    /// Number of undelimited runs discarded by the max-frame guard.
+    quint64 oversizeDrops() const { return m_oversizeDrops; }
+
+    /// Bytes discarded by the max-frame guard.
+    quint64 droppedBytes() const { return m_droppedBytes; }
+
+    /// Frames that had to be copied because they wrapped around the end of the ring.
+    quint64 wrappedFrames() const { return m_wrappedFrames; }
+
+private:
+    /// Find delim in [m_scan, m_head); returns its absolute index or m_head if absent.
+    size_t scan(uint8_t delim);
+
+    /// View of [start, start + len); copies once into m_scratch if it wraps.
+    FrameView viewOf(size_t start, size_t len);
+
+    std::vector<uint8_t> m_buf;     ///< Ring storage (power-of-two size).
+    std::vector<uint8_t> m_scratch; ///< Contiguous copy target for wrapped frames.
+    size_t m_mask     = 0;
+    size_t m_maxFrame = 0;
+
+    size_t m_head = 0;              ///< Absolute write index (monotonic).
+    size_t m_tail = 0;              ///< Absolute start of the oldest unconsumed frame.
+    size_t m_scan = 0;              ///< Bytes before this index hold no m_scanDelim.
+    uint8_t m_scanDelim = 0;        ///< Delimiter m_scan was computed for.
+    size_t m_textEnd  = 0;          ///< Mixed mode: [m_tail, m_textEnd) is complete printable lines.
+    bool   m_textOpen = true;       ///< Mixed mode: no binary byte since m_textEnd.
+
+    quint64 m_oversizeDrops = 0;
+    quint64 m_droppedBytes  = 0;
+    quint64 m_wrappedFrames = 0;
+};
+
+#endif // RXRING_H
@@ -2,14 +2,35 @@
 #define SENSORDATAMODEL_H
 
 #include <QObject>
+#include <QPointer>
+#include <QQuickWindow>
 #include <QString>
+#include <QTimer>
+#include <QVariantMap>
+#include <array>
 
+#include "DownlinkRecord.h"
+#include "LatencyMonitor.h"
+#include "RawPacketLogModel.h"
+#include "TelemetryHistory.h"
+
+class CommandTracker;
 class SerialBridge;
+class TelemetryAlarms;
+class VehicleRouter;
 
 /**
  * @brief SensorDataModel
  * Holds the latest parsed sensor values and exposes them to QML via properties.
- * Decodes both TelemetryState (10Hz) and SystemStatus (1Hz) from protobuf downlink.
+ * TelemetryState (10Hz) and SystemStatus (1Hz) are decoded on SerialBridge's I/O thread;
+ * this model drains the decoded records and picks up the latest published snapshot.
+ *
+ * With several vehicles (VehicleRouter) it shows vehicle 0; VehicleModel is the same
+ * model for any other vehicle.
+ *
+ * Every property has its own NOTIFY signal. Changes are tracked as a per-field dirty
+ * bitmask and, in coalescing mode, flushed at most once per rendered frame, so a burst
+ * of packets re-evaluates only the bindings whose value actually changed, once.
  */
 class SensorDataModel : public QObject {
     Q_OBJECT
@@ -18,77 +39,118 @@ public:
     explicit SensorDataModel(SerialBridge* bridge, QObject* parent = nullptr);
 
     // Position
-    Q_PROPERTY(double altitude READ altitude NOTIFY baroDataChanged)
-    Q_PROPERTY(double posX     READ posX     NOTIFY baroDataChanged)
-    Q_PROPERTY(double posY     READ posY     NOTIFY baroDataChanged)
+    Q_PROPERTY(double altitude READ altitude NOTIFY altitudeChanged)
+    Q_PROPERTY(double posX     READ posX     NOTIFY posXChanged)
+    Q_PROPERTY(double posY     READ posY     NOTIFY posYChanged)
 
     // Kalman Filter — raw = angular rate (deg/s), filtered = Euler angle (deg)
-    Q_PROPERTY(double rawAngleX      READ rawAngleX      NOTIFY kalmanDataChanged)
-    Q_PROPERTY(double filteredAngleX READ filteredAngleX NOTIFY kalmanDataChanged)
-    Q_PROPERTY(double rawAngleY      READ rawAngleY      NOTIFY kalmanDataChanged)
-    Q_PROPERTY(double filteredAngleY READ filteredAngleY NOTIFY kalmanDataChanged)
-    Q_PROPERTY(double rawAngleZ      READ rawAngleZ      NOTIFY kalmanDataChanged)
-    Q_PROPERTY(double filteredAngleZ READ filteredAngleZ NOTIFY kalmanDataChanged)
+    Q_PROPERTY(double rawAngleX      READ rawAngleX      NOTIFY rawAngleXChanged)
+    Q_PROPERTY(double filteredAngleX READ filteredAngleX NOTIFY filteredAngleXChanged)
+    Q_PROPERTY(double rawAngleY      READ rawAngleY      NOTIFY rawAngleYChanged)
+    Q_PROPERTY(double filteredAngleY READ filteredAngleY NOTIFY filteredAngleYChanged)
+    Q_PROPERTY(double rawAngleZ      READ rawAngleZ      NOTIFY rawAngleZChanged)
+    Q_PROPERTY(double filteredAngleZ READ filteredAngleZ NOTIFY filteredAngleZChanged)
 
     // Engine outputs
-    Q_PROPERTY(double thrustCmd READ thrustCmd NOTIFY engineDataChanged)
-    Q_PROPERTY(double gimbalX   READ gimbalX   NOTIFY engineDataChanged)
-    Q_PROPERTY(double gimbalY   READ gimbalY   NOTIFY engineDataChanged)
+    Q_PROPERTY(double thrustCmd READ thrustCmd NOTIFY thrustCmdChanged)
+    Q_PROPERTY(double gimbalX   READ gimbalX   NOTIFY gimbalXChanged)
+    Q_PROPERTY(double gimbalY   READ gimbalY   NOTIFY gimbalYChanged)
 
     // Telemetry
-    Q_PROPERTY(double velocity READ velocity NOTIFY telemetryDataChanged)
+    Q_PROPERTY(double velocity READ velocity NOTIFY velocityChanged)
+
+    // Raw packet log (bounded, lazily formatted list of every received packet)
+    Q_PROPERTY(RawPacketLogModel* packetLog READ packetLog CONSTANT)
 
-    // Raw packet log (hex dump of every received binary packet)
-    Q_PROPERTY(QString rawPacketLog READ rawPacketLog NOTIFY rawPacketLogChanged)
+    // Time-series history of the telemetry fields (decimated window queries)
+    Q_PROPERTY(TelemetryHistory* history READ history CONSTANT)
 
     // SystemStatus properties
-    Q_PROPERTY(int     flightState   READ flightState   NOTIFY statusReceived)
-    Q_PROPERTY(quint32 uptimeMs      READ uptimeMs      NOTIFY statusReceived)
-    Q_PROPERTY(bool    accelOk       READ accelOk       NOTIFY statusReceived)
-    Q_PROPERTY(bool    gyroOk        READ gyroOk        NOTIFY statusReceived)
-    Q_PROPERTY(bool    baro1Ok       READ baro1Ok       NOTIFY statusReceived)
-    Q_PROPERTY(bool    baro2Ok       READ baro2Ok       NOTIFY statusReceived)
-    Q_PROPERTY(bool    gpsConnected  READ gpsConnected  NOTIFY statusReceived)
-    Q_PROPERTY(quint32 radioRxCount  READ radioRxCount  NOTIFY statusReceived)
-    Q_PROPERTY(quint32 radioTxCount  READ radioTxCount  NOTIFY statusReceived)
-    Q_PROPERTY(quint32 cmdRxCount    READ cmdRxCount    NOTIFY statusReceived)
+    Q_PROPERTY(int     flightState   READ flightState   NOTIFY flightStateChanged)
+    Q_PROPERTY(quint32 uptimeMs      READ uptimeMs      NOTIFY uptimeMsChanged)
+    Q_PROPERTY(bool    accelOk       READ accelOk       NOTIFY accelOkChanged)
+    Q_PROPERTY(bool    gyroOk        READ gyroOk        NOTIFY gyroOkChanged)
+    Q_PROPERTY(bool    baro1Ok       READ baro1Ok       NOTIFY baro1OkChanged)
+    Q_PROPERTY(bool    baro2Ok       READ baro2Ok       NOTIFY baro2OkChanged)
+    Q_PROPERTY(bool    gpsConnected  READ gpsConnected  NOTIFY gpsConnectedChanged)
+    Q_PROPERTY(quint32 radioRxCount  READ radioRxCount  NOTIFY radioRxCountChanged)
+    Q_PROPERTY(quint32 radioTxCount  READ radioTxCount  NOTIFY radioTxCountChanged)
+    Q_PROPERTY(quint32 cmdRxCount    READ cmdRxCount    NOTIFY cmdRxCountChanged)
+
+    // Notification coalescing (at most one flush per rendered frame; latest value wins)
+    Q_PROPERTY(bool    coalesceNotifications READ coalesceNotifications WRITE setCoalesceNotifications NOTIFY coalesceNotificationsChanged)
+    Q_PROPERTY(quint64 notificationsEmitted    READ notificationsEmitted    NOTIFY notifyStatsChanged)
+    Q_PROPERTY(quint64 notificationsSuppressed READ notificationsSuppressed NOTIFY notifyStatsChanged)
+    Q_PROPERTY(quint64 notifyFlushes           READ notifyFlushes           NOTIFY notifyStatsChanged)
 
     // Simple getters used by QML properties
-    double altitude() const { return m_altitude; }
-    double posX()     const { return m_posX; }
-    double posY()     const { return m_posY; }
-
-    double rawAngleX()      const { return m_rawAngleX; }
-    double filteredAngleX() const { return m_filteredAngleX; }
-    double rawAngleY()      const { return m_rawAngleY; }
-    double filteredAngleY() const { return m_filteredAngleY; }
-    double rawAngleZ()      const { return m_rawAngleZ; }
-    double filteredAngleZ() const { return m_filteredAngleZ; }
-
-    double thrustCmd() const { return m_thrustCmd; }
-    double gimbalX()   const { return m_gimbalX; }
-    double gimbalY()   const { return m_gimbalY; }
-
-    double velocity() const { return m_velocity; }
-
-    int     flightState()  const { return m_flightState; }
-    quint32 uptimeMs()     const { return m_uptimeMs; }
-    bool    accelOk()      const { return m_accelOk; }
-    bool    gyroOk()       const { return m_gyroOk; }
-    bool    baro1Ok()      const { return m_baro1Ok; }
-    bool    baro2Ok()      const { return m_baro2Ok; }
-    bool    gpsConnected() const { return m_gpsConnected; }
-    quint32 radioRxCount() const { return m_radioRxCount; }
-    quint32 radioTxCount() const { return m_radioTxCount; }
-    quint32 cmdRxCount()   const { return m_cmdRxCount; }
-
-    QString rawPacketLog() const { return m_rawPacketLog; }
-    Q_INVOKABLE void clearRawPacketLog();
+    double altitude() const { return m_state.altitude; }
+    double posX()     const { return m_state.posX; }
+    double posY()     const { return m_state.posY; }
+
+    double rawAngleX()      const { return m_state.rawAngleX; }
+    double filteredAngleX() const { return m_state.filteredAngleX; }
+    double rawAngleY()      const { return m_state.rawAngleY; }
+    double filteredAngleY() const { return m_state.filteredAngleY; }
+    double rawAngleZ()      const { return m_state.rawAngleZ; }
+    double filteredAngleZ() const { return m_state.filteredAngleZ; }
+
+    double thrustCmd() const { return m_state.thrustCmd; }
+    double gimbalX()   const { return m_state.gimbalX; }
+    double gimbalY()   const { return m_state.gimbalY; }
+
+    double velocity() const { return m_state.velocity; }
+
+    int     flightState()  const { return m_state.flightState; }
+    quint32 uptimeMs()     const { return m_state.uptimeMs; }
+    bool    accelOk()      const { return m_state.accelOk; }
+    bool    gyroOk()       const { return m_state.gyroOk; }
+    bool    baro1Ok()      const { return m_state.baro1Ok; }
+    bool    baro2Ok()      const { return m_state.baro2Ok; }
+    bool    gpsConnected() const { return m_state.gpsConnected; }
+    quint32 radioRxCount() const { return m_state.radioRxCount; }
+    quint32 radioTxCount() const { return m_state.radioTxCount; }
+    quint32 cmdRxCount()   const { return m_state.cmdRxCount; }
+
+    RawPacketLogModel* packetLog() { return &m_packetLog; }
+    TelemetryHistory*  history()   { return &m_history; }
+
+    bool    coalesceNotifications() const { return m_coalesce; }
+    void    setCoalesceNotifications(bool on);
+    quint64 notificationsEmitted() const { return m_notifyEmitted; }
+    quint64 notificationsSuppressed() const { return m_notifySuppressed; }
+    quint64 notifyFlushes() const { return m_notifyFlushes; }
+
+    /// Flush pending notifications from this window's afterAnimating() (once per rendered frame).
+    /// Without a window, or while it is not exposed, a ~60 Hz timer is used instead; a
+    /// slower timer also backs up frames the window never renders.
+    void setFrameWindow(QQuickWindow* window);
+
+    /// Report per-record queue/model timing to monitor (nullptr disables).
+    void setLatencyMonitor(LatencyMonitor* monitor) { m_latency = monitor; }
+
+    /// Evaluate telemetry alarm rules on every decoded record (nullptr disables).
+    void setAlarmEngine(TelemetryAlarms* alarms);
+
+    /// Hand every drained record to router for per-vehicle tracking (nullptr disables).
+    void setVehicleRouter(VehicleRouter* router);
+
+    /// Confirm flight commands from every decoded record (nullptr disables).
+    void setCommandTracker(CommandTracker* tracker);
+
+    /// Per-property suppressed-notification counts, keyed by property name.
+    Q_INVOKABLE QVariantMap suppressedByField() const;
+
+    /// Reset the notification counters.
+    Q_INVOKABLE void resetNotifyStats();
 
 public slots:
-    /// Entry point for binary COBS packets; decode Downlink and update model.
+    /// Entry point for binary COBS packets decoded on the calling thread (no I/O thread).
     void onBinaryPacketReceived(int which, const QByteArray& packet);
 
+    /// Drain records queued by the I/O thread and apply the latest published snapshot.
+    void drainDownlink();
+
     /// Store Kalman filter angles and notify QML.
     void updateKalman(double rawAngleX, double filteredAngleX,
                       double rawAngleY, double filteredAngleY,
@@ -104,51 +166,117 @@ public slots:
     void updateTelemetry(double velocity);
 
 signals:
-    // NOTIFY signals for QML bindings
+    // Per-property NOTIFY signals for QML bindings (emitted only when the value changed)
+    void altitudeChanged();
+    void posXChanged();
+    void posYChanged();
+    void rawAngleXChanged();
+    void filteredAngleXChanged();
+    void rawAngleYChanged();
+    void filteredAngleYChanged();
+    void rawAngleZChanged();
+    void filteredAngleZChanged();
+    void thrustCmdChanged();
+    void gimbalXChanged();
+    void gimbalYChanged();
+    void velocityChanged();
+    void flightStateChanged();
+    void uptimeMsChanged();
+    void accelOkChanged();
+    void gyroOkChanged();
+    void baro1OkChanged();
+    void baro2OkChanged();
+    void gpsConnectedChanged();
+    void radioRxCountChanged();
+    void radioTxCountChanged();
+    void cmdRxCountChanged();
+
+    // Coarse group notifications for C++ listeners (once per flush if any member changed)
     void kalmanDataChanged();
     void baroDataChanged();
     void engineDataChanged();
     void telemetryDataChanged();
     void statusReceived();
-    void rawPacketLogChanged();
+
+    void coalesceNotificationsChanged();
+    void notifyStatsChanged();
+
+protected:
+    /// Per-packet work for one decoded record (raw packet log, history).
+    void onDownlinkRecord(const DownlinkRecord& rec);
+
+    /// Replace the display state and notify the property groups that changed.
+    void applySnapshot(const TelemetrySnapshot& snap);
+
+    /// Publish rows appended to the packet log and history since the last call.
+    void flushLogs();
+
+    int m_vehicle = 0;               ///< Vehicle whose records feed history and alarms.
 
 private:
+    /// One bit per notifying property (order matches the per-property signals).
+    enum Field {
+        Altitude = 0, PosX, PosY,
+        RawAngleX, FilteredAngleX, RawAngleY, FilteredAngleY, RawAngleZ, FilteredAngleZ,
+        ThrustCmd, GimbalX, GimbalY,
+        Velocity,
+        FlightState, UptimeMs, AccelOk, GyroOk, Baro1Ok, Baro2Ok, GpsConnected,
+        RadioRxCount, RadioTxCount, CmdRxCount,
+        FieldCount
+    };
+
+    /// Field ranges [first, last] as masks, one per legacy notification group.
+    static constexpr quint32 fieldRange(int first, int last) {
+        return ((2u << last) - 1u) & ~((1u << first) - 1u);
+    }
+    static constexpr quint32 kBaroFields      = fieldRange(Altitude, PosY);
+    static constexpr quint32 kKalmanFields    = fieldRange(RawAngleX, FilteredAngleZ);
+    static constexpr quint32 kEngineFields    = fieldRange(ThrustCmd, GimbalY);
+    static constexpr quint32 kTelemetryFields = fieldRange(Velocity, Velocity);
+    static constexpr quint32 kStatusFields    = fieldRange(FlightState, CmdRxCount);
+    static constexpr quint32 kAllFields       = fieldRange(0, FieldCount - 1);
+
     // Backing storage for the latest sensor values
-    double m_altitude = 0.0;
-    double m_posX     = 0.0;
-    double m_posY     = 0.0;
-
-    double m_rawAngleX      = 0.0;
-    double m_filteredAngleX = 0.0;
-    double m_rawAngleY      = 0.0;
-    double m_filteredAngleY = 0.0;
-    double m_rawAngleZ      = 0.0;
-    double m_filteredAngleZ = 0.0;
-
-    double m_thrustCmd = 0.0;
-    double m_gimbalX   = 0.0;
-    double m_gimbalY   = 0.0;
-
-    double m_velocity = 0.0;
-
-    // SystemStatus state
-    int     m_flightState  = 0;
-    quint32 m_uptimeMs     = 0;
-    bool    m_accelOk      = false;
-    bool    m_gyroOk       = false;
-    bool    m_baro1Ok      = false;
-    bool    m_baro2Ok      = false;
-    bool    m_gpsConnected = false;
-    quint32 m_radioRxCount = 0;
-    quint32 m_radioTxCount = 0;
-    quint32 m_cmdRxCount   = 0;
-
-    QString m_rawPacketLog;
+    TelemetrySnapshot m_state;
+
+    RawPacketLogModel m_packetLog;
+    TelemetryHistory  m_history;
+    TelemetrySnapshot m_recordState; ///< Per-record state used to feed m_history.
 
     /// Update model from decoded Downlink (TelemetryState or SystemStatus).
     void applyDownlink(int which, const void* downlinkStruct);
 
+    /// Store snap as the display state; `touched` are the fields the update would have
+    /// notified without coalescing (used for the suppression counters).
+    void commitState(const TelemetrySnapshot& snap, quint32 touched);
+
+    /// Emit the per-field (and group) signals for every dirty field, then clear them.
+    void flushNotifications();
+
+    /// Tell the latency monitor QML is up to date, unless a flush is still pending.
+    void stampModelUpdated();
+
+    /// Bitmask of fields that differ between a and b.
+    static quint32 diffMask(const TelemetrySnapshot& a, const TelemetrySnapshot& b);
+
+    /// Emit the NOTIFY signal of one field.
+    void emitFieldChanged(int field);
+
     SerialBridge* m_bridge = nullptr;
+    QPointer<LatencyMonitor> m_latency;
+    QPointer<TelemetryAlarms> m_alarms;
+    QPointer<VehicleRouter> m_router;
+    QPointer<CommandTracker> m_tracker;
+
+    bool    m_coalesce = true;
+    quint32 m_dirty    = 0;              ///< Fields changed since the last flush.
+    QPointer<QQuickWindow> m_frameWindow;
+    QTimer  m_flushTimer;                ///< Frame clock without an exposed window; backstop with one.
+
+    quint64 m_notifyEmitted    = 0;
+    quint64 m_notifySuppressed = 0;
+    quint64 m_notifyFlushes    = 0;
+    std::array<quint64, FieldCount> m_suppressed {};
 };
 
 #endif // SENSORDATAMODEL_H
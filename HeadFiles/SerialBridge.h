@@ -2,48 +2,153 @@
 #define SERIALBRIDGE_H
 
 #pragma once
+#include <QHash>
+#include <QMap>
 #include <QObject>
 #include <QSerialPort>
 #include <QSerialPortInfo>
-#include <QTimer>
-#include <QElapsedTimer>
+#include <QThread>
+#include <QVariantList>
+#include <QVariantMap>
+#include <functional>
+
+#include "SerialWorker.h"
+
+class PortDiscovery;
 
 class SerialBridge : public QObject {
     Q_OBJECT
 
 public:
+    /// TX priority classes (mirror TxQueue::Priority; lower is more urgent).
+    enum TxPriority { TxCritical = TxQueue::Critical, TxCommand = TxQueue::Command,
+                      TxNormal = TxQueue::Normal, TxPeriodic = TxQueue::Periodic };
+    Q_ENUM(TxPriority)
+
+    /// Completion callback for send(): receives a TxQueue::Result, runs on the GUI thread.
+    using TxCallback = std::function<void(int result)>;
+
+    /// One recorded COBS frame for injectFrames(): size bytes at base + offset, from port.
+    struct InjectedFrame {
+        quint64 offset = 0;
+        quint32 size = 0;
+        int     port = 0;
+    };
+
     /**
      * @brief SerialBridge constructor
-     * Creates the bridge object and (in .cpp) wires up serial signals and does initial refreshPorts().
+     * Creates the bridge object, starts the I/O thread that owns the serial ports and the
+     * discovery thread that lists radios (the port list fills in asynchronously).
      */
     explicit SerialBridge(QObject* parent = nullptr);
 
+    /// Stops the discovery and I/O threads (closing any open ports on them).
+    ~SerialBridge() override;
+
     Q_PROPERTY(QStringList ports READ ports NOTIFY portsChanged)
 
+    /// One entry per open link: {id, spec, description, open, bytesRx, framesRx, bytesTx, ...}.
+    Q_PROPERTY(QVariantList links READ links NOTIFY linksChanged)
+
+    /// Downlink combining across links: {enabled, unique, duplicates, multiLink, soloByLink, quality}.
+    Q_PROPERTY(QVariantMap diversity READ diversity NOTIFY linksChanged)
+
     // -----------------------
     // QML-callable API
     // -----------------------
 
-    /// Rescan system serial ports and update the cached port list (ports()).
+    /// Ask the discovery thread to rescan now; ports() follows through portsChanged().
+    /// Hotplug is picked up without it.
     Q_INVOKABLE void refreshPorts();
 
-    /// Open port 1 or 2 with the given name/baud; returns true on success.
+    /// Discovery details of a listed port: {serial, ident} (ident: ATI banner if probed).
+    Q_INVOKABLE QVariantMap portInfo(const QString& name) const { return m_portInfo.value(name); }
+
+    /// Open link `which` (1/2 = P1/P2, or any other id) from a port name or Transport spec
+    /// (see Transport.h: serial port, "pty", "udp:<port>[:<peer>]", "file:<path>").
     Q_INVOKABLE bool connectPort(int which, const QString& name, int baudRate);
 
-    /// Close port 1 or 2 if open and clean up handlers.
+    /// Close link `which` if open and clean up handlers.
     Q_INVOKABLE void disconnectPort(int which);
 
+    /// Open an additional link under the next free id (> 2); returns the id or -1.
+    Q_INVOKABLE int addLink(const QString& spec, int baudRate = 57600);
+
+    /// Close and forget an additional link.
+    Q_INVOKABLE void removeLink(int which) { disconnectPort(which); }
+
     /// Set which port index is used as the TX source; emits txToChanged() on success.
     Q_INVOKABLE bool setTxTo(int which);
 
     /// Set which port index is used as the RX source; emits rxFromChanged() on success.
     Q_INVOKABLE bool setRxFrom(int which);
 
-    /// Send a line of text out through the selected port (1 or 2); returns true on success.
-    Q_INVOKABLE bool sendText(int which, const QString& text);
+    /// Queue a line of text on link `which` and return immediately; false only if the link
+    /// is not open. A non-empty coalesceKey lets a newer line replace a still-queued one
+    /// (Periodic class). Write errors come back through errorMessage().
+    Q_INVOKABLE bool sendText(int which, const QString& text, int priority = TxNormal,
+                              const QString& coalesceKey = QString());
+
+    /// Queue raw binary data (encoded packets); same semantics as sendText().
+    Q_INVOKABLE bool sendBinary(int which, const QByteArray& data, int priority = TxNormal,
+                                const QString& coalesceKey = QString());
+
+    /// Depth and full-queue policy (TxQueue::Policy) of one priority class on every link.
+    Q_INVOKABLE void setTxLimit(int priority, int depth, int policy);
+
+    /// Longest accepted RX frame in bytes; a missing delimiter can't grow the buffer past it.
+    Q_INVOKABLE void setMaxFrameSize(int bytes);
+
+    /// Decode and merge the downlink of every open link (default), or only the primary one.
+    Q_INVOKABLE void setDiversity(bool enabled);
+
+    /// Route link `which` to a vehicle (0 = the default vehicle shown by sensorData).
+    Q_INVOKABLE void setLinkVehicle(int which, int vehicle);
+
+    // -----------------------
+    // I/O thread
+    // -----------------------
+
+    /// Pin the I/O thread to a CPU and/or request real-time priority (see SerialWorker).
+    void setIoThreadTuning(int cpu, int rtPriority);
+
+    /// Queue of decoded downlink records; SensorDataModel is the single consumer.
+    SerialWorker::RecordQueue& downlinkQueue() { return m_worker->records(); }
+
+    /// Latest display state published by the I/O thread.
+    const SnapshotBuffer<TelemetrySnapshot>& downlinkSnapshot() const { return m_worker->snapshot(); }
+
+    /// Re-arm downlinkAvailable(); call before draining downlinkQueue().
+    void ackDownlink() { m_worker->ackRecords(); }
+
+    /**
+     * Queue bytes (text: an LF-terminated line, else an encoded packet) on link `which`.
+     * done, if set, is called exactly once on the GUI thread when the message leaves the
+     * queue (sent, dropped, superseded, failed or link closed). Returns the message id,
+     * or 0 if the link is not open (done is not called then).
+     */
+    quint64 send(int which, const QByteArray& bytes, bool text, int priority,
+                 const QByteArray& coalesceKey = QByteArray(), TxCallback done = TxCallback());
+
+    /// Fire-and-forget form of send() that may be called from any thread (timing threads):
+    /// no link check and no completion; a closed link is reported through errorMessage().
+    void post(int which, const QByteArray& bytes, bool text, int priority,
+              const QByteArray& coalesceKey = QByteArray());
+
+    /**
+     * Feed frames[0, count) through the I/O thread's decode path, in order. The bytes are
+     * read in place at base + offset, never copied: base and frames must stay valid until
+     * done runs (on the GUI thread, after the last frame was decoded) or waitInjected().
+     * primed frames only restore state (see SerialWorker::injectFrame()).
+     */
+    void injectFrames(const uchar* base, const InjectedFrame* frames, size_t count, bool primed = false,
+                      std::function<void()> done = std::function<void()>());
 
-    /// Send raw binary data (for encoded packets)
-    Q_INVOKABLE bool sendBinary(int which, const QByteArray& data);
+    /// Block until every injectFrames() batch queued so far has been decoded.
+    void waitInjected();
+
+    /// Record every live RX frame into recorder (must outlive the bridge); nullptr disables.
+    void setRecorder(FlightRecorder* recorder) { m_worker->setRecorder(recorder); }
 
     // -----------------------
     // Property getters
@@ -52,19 +157,28 @@ public:
     /// Return the current list of available OS serial port names.
     Q_INVOKABLE QStringList ports() const { return m_ports; }
 
+    /// Latest per-link status/counters (refreshed about once a second).
+    QVariantList links() const { return m_linkStats; }
+
+    /// Latest combiner totals (refreshed with links).
+    QVariantMap diversity() const { return m_diversity; }
+
+    /// Ids of the currently open links, ascending.
+    Q_INVOKABLE QList<int> linkIds() const { return m_linkState.keys(); }
+
     /// Return true if the given port (1 or 2) is currently open.
     Q_INVOKABLE bool isConnected(int which) const {
-        return (which == 1) ? m_p1.isOpen() : m_p2.isOpen();
+        return portState(which).open;
     }
 
-    /// Return the OS name of the given port (empty if closed or unset).
+    /// Return the OS name / link description of the given port (empty if closed or unset).
     Q_INVOKABLE QString portName(int which) const {
-        return (which == 1) ? m_p1.portName() : m_p2.portName();
+        return portState(which).name;
     }
 
     /// Return the current baud rate for the given port.
     Q_INVOKABLE int baudRate(int which) const {
-        return (which == 1) ? m_p1.baudRate() : m_p2.baudRate();
+        return portState(which).baud;
     }
 
 signals:
@@ -72,9 +186,12 @@ signals:
     // Property/Model change notifications (for QML bindings)
     // -----------------------
 
-    /// Emitted when the available port list changes after a refreshPorts() call.
+    /// Emitted for every radio port that appears or disappears (hotplug or refreshPorts()).
     void portsChanged();
 
+    /// Emitted when links open/close and when their counters refresh.
+    void linksChanged();
+
     /// Emitted whenever port 1 or 2 opens or closes.
     void connectedChanged(int which, bool connected);
 
@@ -102,87 +219,65 @@ signals:
     /// Emitted when a complete binary (COBS) packet has been received (0x00-delimited).
     void binaryPacketReceived(int which, const QByteArray &packet);
 
+    /// Emitted (coalesced) when decoded records are waiting in downlinkQueue().
+    void downlinkAvailable();
+
     /// Emitted for user-visible error messages (shown in QML popup).
     void errorMessage(const QString &msg);
 
+protected:
+    /// Only forward raw frames from the I/O thread while binaryPacketReceived has listeners.
+    void connectNotify(const QMetaMethod& signal) override;
+    void disconnectNotify(const QMetaMethod& signal) override;
+
 private:
-    /// Helper bundle to access port-specific members (port, RX buffer, connections) by index.
-    struct PortBundle {
-        QSerialPort& port;
-        QByteArray& rxBuf;
-        QMetaObject::Connection& readyConnect;
-        QMetaObject::Connection& errorConnect;
+    /// GUI-side cache of a port's state so QML bindings never block on the I/O thread.
+    struct PortState {
+        bool    open = false;
+        QString name;
+        int     baud = 0;
+        QString serial;              ///< USB serial number when discovery knows it.
     };
 
-    /// Non-const bundle selector for port 1 or 2.
-    PortBundle bundle(int which);
+    /// Discovery found a radio port: list it, and reopen a link that lost this device.
+    void onPortAdded(const QString& name, const QString& serial, const QString& ident);
 
-    /// Const bundle selector for port 1 or 2 (wraps non-const version).
-    const PortBundle bundle(int which) const {
-        return const_cast<SerialBridge*>(this)->bundle(which);
-    }
+    /// Discovery lost a port: unlist it; a link on it is closed and waits for its return.
+    void onPortRemoved(const QString& name);
+
+    /// Tell discovery which ports are ours (plus `opening`) without waiting for its thread;
+    /// false if a probe still holds one of them (it lets go shortly).
+    bool updateBusyPorts(const QString& opening = QString());
 
-    /// Configure and open a QSerialPort with the given name/baud; returns true on success.
-    bool openPort(QSerialPort& port, const QString& name, int baud);
+    /// Cached state of a link (default-constructed, i.e. closed, if unknown).
+    PortState portState(int which) const { return m_linkState.value(which); }
 
     /// Convenience wrapper to emit an errorMessage().
     void emitError(const QString& msg) { emit errorMessage(msg); }
 
-    /// Heuristic check whether a QSerialPortInfo looks like an RFD900x (VID/PID, etc.).
-    static bool looksLikeRadio(const QSerialPortInfo &info);
-
-    /// Active probe using AT command to verify attached device is a radio modem.
-    static bool probeRadio_AT(QSerialPort &port);
-
-    /// Connect readyRead/error handlers for the given port.
-    void attachRx(int which);
-
-    /// Disconnect readyRead/error handlers for the given port.
-    void detachRx(int which);
-
-    /// Slot-like handler for readyRead on a given port; buffers and parses lines.
-    void handleReadyRead(int which);
-
-    /// Slot-like handler for low-level serial errors on a given port.
-    void handleError(int which, QSerialPort::SerialPortError e);
-
-    /// Start a short RX pause window (used while transmitting on half-duplex links).
-    void beginRxPause(int ms);
-
-    /// Force end of RX pause and re-enable RX processing.
-    void endRxPause();
-
-    /// Return true if we are currently in an active RX pause window.
-    bool isRxPause() const {
-        if (!m_rxPaused) return false;
-        return m_rxPauseTimer.isValid() && (m_rxPauseTimer.elapsed() < m_rxPauseMs);
-    }
-
-    /// Split accumulated RX buffer into complete lines and emit textReceivedFrom().
-    void parseBufferedLines(int which);
-
-    /// Split RX buffer on COBS delimiter (0x00), emit binaryPacketReceived() for each packet.
-    void parseBufferedBinary(int which);
-
     // -----------------------
     // Members
     // -----------------------
 
-    QSerialPort m_p1, m_p2;          ///< Underlying serial ports for channel 1 and 2.
-    QByteArray m_rx1_buffer, m_rx2_buffer;  ///< Line-assembly buffers for each port.
+    QThread       m_ioThread;        ///< Dedicated RX/TX thread (owns every link).
+    SerialWorker* m_worker = nullptr; ///< Port owner living on m_ioThread; deleted when it stops.
+    QMetaObject::Connection m_rawFrameForward; ///< worker frameReceived → binaryPacketReceived.
 
-    int m_rxFrom = 1;                ///< Current port index used as RX source.
-    int m_txTo   = 2;                ///< Current port index used as TX destination.
+    QThread        m_discoveryThread; ///< Port enumeration, hotplug watch and AT probes.
+    PortDiscovery* m_discovery = nullptr; ///< Lives on m_discoveryThread; deleted when it stops.
+    QHash<QString, QVariantMap> m_portInfo; ///< Listed port → {serial, ident}.
+    QMap<int, PortState> m_lostLinks; ///< Links whose device was unplugged, by id.
 
-    bool m_rxPaused = false;         ///< Flag indicating RX is temporarily paused.
-    QElapsedTimer m_rxPauseTimer;    ///< Timer used to measure RX pause duration.
-    int m_rxPauseMs = 0;             ///< RX pause length in milliseconds.
+    QMap<int, PortState> m_linkState; ///< Cached state of every open link, by id.
+    QHash<quint64, TxCallback> m_txCallbacks; ///< Pending send() completions, by message id.
+    quint64 m_nextTxId = 1;
+    QVariantList m_linkStats;         ///< Last per-link counters from the worker.
+    QVariantMap  m_diversity;         ///< Last combiner totals from the worker.
 
-    QMetaObject::Connection m_readyConnect1, m_error1; ///< Connections for port 1 signals.
-    QMetaObject::Connection m_readyConnect2, m_error2; ///< Connections for port 2 signals.
-    QMetaObject::Connection m_activeReadyConnect;      ///< Currently active RX connection in single-RX mode.
+    int m_rxFrom = 1;                ///< Current port index used as RX source.
+    int m_txTo   = 2;                ///< Current port index used as TX destination.
 
-    QStringList m_ports;             ///< Cached list of discovered serial port names for UI.
+    QStringList m_ports;             ///< Discovered radio port names for the UI, sorted.
 };
 
 #endif // SERIALBRIDGE_H
@@ -0,0 +1,35 @@
+#ifndef SERIALTRANSPORT_H
+#define SERIALTRANSPORT_H
+
+#include <QSerialPort>
+
+#include "Transport.h"
+
+/**
+ * @brief SerialTransport
+ * QSerialPort link (8N1, no flow control) — the radio modem case.
+ */
+class SerialTransport : public Transport {
+    Q_OBJECT
+
+public:
+    SerialTransport(const QString& portName, int baud, QObject* parent = nullptr);
+
+    bool open() override;
+    void close() override;
+    bool isOpen() const override { return m_port.isOpen(); }
+
+    qint64 read(char* dst, qint64 max) override { return m_port.read(dst, max); }
+    qint64 write(const char* data, qint64 size) override { return m_port.write(data, size); }
+    qint64 bytesToWrite() const override { return m_port.bytesToWrite(); }
+    void flush() override;
+
+    int baudRate() const override { return m_port.baudRate(); }
+    QString describe() const override { return m_port.portName(); }
+    QString errorString() const override { return m_port.errorString(); }
+
+private:
+    QSerialPort m_port;
+};
+
+#endif // SERIALTRANSPORT_H
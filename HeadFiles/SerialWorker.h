@@ -0,0 +1,257 @@
+#ifndef SERIALWORKER_H
+#define SERIALWORKER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QVariantList>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "DiversityCombiner.h"
+#include "DownlinkRecord.h"
+#include "LinkQuality.h"
+#include "RxRing.h"
+#include "SnapshotBuffer.h"
+#include "SpscQueue.h"
+#include "Transport.h"
+#include "TxQueue.h"
+
+class FlightRecorder;
+
+/**
+ * @brief SerialWorker
+ * Lives on SerialBridge's dedicated I/O thread. Owns every link (a Transport plus its
+ * own framer and counters, keyed by link id; 1 and 2 are the classic P1/P2), does all
+ * reads/writes, COBS framing and protobuf decode, so nothing on the RX path runs on
+ * the GUI thread. The RX stream may interleave firmware text lines with COBS frames;
+ * both are split out of the same ring in one pass (RxRing::nextSegment()). Frames from
+ * every link are decoded and merged by a DiversityCombiner (first copy wins). Decoded
+ * records are handed to the UI through a lock-free SPSC queue; the latest display state
+ * is published through a double-buffered snapshot.
+ *
+ * Every public slot must be called on the worker's own thread (SerialBridge uses
+ * QMetaObject::invokeMethod); the queue consumer side and snapshot reader are the
+ * only members meant to be touched from the GUI thread.
+ */
+class SerialWorker : public QObject {
+    Q_OBJECT
+
+public:
+    /// Decoded-record queue (producer = I/O thread, consumer = GUI thread).
+    using RecordQueue = SpscQueue<DownlinkRecord, 1024>;
+
+    explicit SerialWorker(QObject* parent = nullptr);
+
+    // -----------------------
+    // GUI-thread accessors (thread-safe by construction)
+    // -----------------------
+
+    /// Queue of decoded records; only one consumer may drain it.
+    RecordQueue& records() { return m_records; }
+
+    /// Latest display state; readable from any single reader thread.
+    const SnapshotBuffer<TelemetrySnapshot>& snapshot() const { return m_snapshot; }
+
+    /// Consumer calls this before draining so the next push re-arms recordsAvailable().
+    void ackRecords() { m_notifyPending.store(false, std::memory_order_release); }
+
+    /// Number of records dropped because the UI fell a full queue behind.
+    quint64 droppedRecords() const { return m_droppedRecords.load(std::memory_order_relaxed); }
+
+    /// Tee every live RX frame (all ports, before decode) into recorder; nullptr disables.
+    void setRecorder(FlightRecorder* recorder) { m_recorder.store(recorder, std::memory_order_release); }
+
+public slots:
+    // -----------------------
+    // I/O-thread API (invoked from SerialBridge)
+    // -----------------------
+
+    /// Create and open link `which` from a Transport spec; returns true on success.
+    /// On success *description receives the transport's description (e.g. a pty path).
+    bool openLink(int which, const QString& spec, int baud, QString* description = nullptr);
+
+    /// Close link `which`, drop any partially received data and forget the link.
+    void closeLink(int which);
+
+    /// Set which port index is the RX source for half-duplex RX pausing.
+    void setRxFrom(int which) { m_rxFrom = which; }
+
+    /// Queue an outgoing message on link `which` (msg.text: LF-terminated line that pauses
+    /// RX while it goes out on a shared link; otherwise an encoded packet). Never blocks;
+    /// messages with an id report back through writeFinished().
+    void enqueueWrite(int which, int priority, TxQueue::Message msg);
+
+    /// Replace the depth/policy of one priority class on every current and future link.
+    void setTxLimit(int priority, int depth, int policy);
+
+    /// Feed a complete COBS frame through the same decode path as live RX (always decoded).
+    void injectFrame(int which, const QByteArray& frame);
+
+    /// Same for size bytes at data, read in place (valid for the duration of the call).
+    /// A primed frame only restores state: it reaches no raw-frame listener and its
+    /// record is marked DownlinkRecord::primed.
+    void injectFrame(int which, const uint8_t* data, size_t size, bool primed = false);
+
+    /// Longest accepted frame in bytes; longer undelimited runs are discarded.
+    void setMaxFrameSize(int bytes);
+
+    /// Combine the downlink of all links (default) or decode the primary link only.
+    void setDiversity(bool enabled);
+
+    /// Assign link `which` (open or not yet) to a vehicle; 0 is the default vehicle, the
+    /// only one published through snapshot(). Links of one vehicle are combined together.
+    void setLinkVehicle(int which, int vehicle);
+
+    /**
+     * Pin the I/O thread to a CPU (cpu < 0 leaves affinity alone) and optionally raise it
+     * to real-time priority (rtPriority > 0, SCHED_FIFO on Linux). Failures are reported
+     * through errorMessage() and leave the thread running with default scheduling.
+     */
+    void applyThreadTuning(int cpu, int rtPriority);
+
+signals:
+    /// Emitted (at most once until ackRecords()) when new records are queued.
+    void recordsAvailable();
+
+    /// Emitted on the I/O thread for every raw COBS frame (0x00-delimited).
+    /// Only materialized as a QByteArray while something is connected.
+    void frameReceived(int which, const QByteArray& frame);
+
+    /// Emitted on the I/O thread for each text line found between frames (CR/LF stripped).
+    void textReceivedFrom(int which, const QString& line);
+
+    /// Emitted when a port closes unexpectedly or a write fails.
+    void errorMessage(const QString& msg);
+
+    /// A queued message with a non-zero id left the TX queue (result is a TxQueue::Result).
+    void writeFinished(quint64 id, int which, int result);
+
+    /// Periodic per-link counters: [{id, spec, open, bytesRx, framesRx, bytesTx, ..., quality}].
+    void linkStatsUpdated(const QVariantList& stats);
+
+    /// Periodic combiner totals: {enabled, unique, duplicates, multiLink, soloByLink, quality}.
+    void diversityStatsUpdated(const QVariantMap& stats);
+
+private:
+    /// Per-link state owned by the I/O thread.
+    struct Link {
+        int        id = 0;
+        int        vehicle = 0;          ///< From m_linkVehicle when opened.
+        QString    spec;
+        Transport* transport = nullptr;  ///< Child of the worker.
+        RxRing     rx;                   ///< Framer; the transport reads straight into it.
+        quint64    bytesRx  = 0;
+        quint64    framesRx = 0;
+        quint64    textLines = 0;
+        quint64    badFrameBytes = 0;    ///< Delimited segments that failed to decode.
+        qint64     lastRxNs = 0;         ///< When bytes last arrived (text idle flush).
+        quint64    bytesTx  = 0;
+        quint64    txErrors = 0;
+        LinkQuality quality;             ///< Sliding-window rates, decode failures and loss.
+
+        TxQueue          txq;            ///< Messages waiting for room in the transport.
+        TxQueue::Message txCur;          ///< Message being written (valid while txBusy).
+        qint64           txOffset = 0;   ///< Bytes of txCur already accepted.
+        bool             txBusy = false;
+    };
+
+    /// Link by id, or nullptr if it doesn't exist.
+    Link* link(int which);
+    const Link* link(int which) const;
+
+    /// True if the link exists and its transport is open.
+    bool isOpen(int which) const;
+
+    /// readyRead handler; buffers and frames incoming bytes.
+    void handleReadyRead(int which);
+
+    /// Move as much as fits from the transport into the link's ring; returns bytes read.
+    qint64 fillRing(Link& l);
+
+    /// Move queued messages into the transport while its own buffer is below the low-water
+    /// mark; resumes from the transport's bytesWritten().
+    void pumpTx(int which);
+
+    /// Report a message that left the queue (only those with an id are signalled).
+    void finishTx(int which, const TxQueue::Message& msg, TxQueue::Result result);
+
+    /// Publish the per-link counters (linkStatsUpdated()).
+    void publishLinkStats();
+
+    /// Read the driver dry, demultiplexing text lines and COBS frames as we go; with
+    /// flushText, complete lines still waiting for a delimiter are emitted as text too.
+    void parseBuffered(int which, bool flushText = false);
+
+    /// Emit textReceivedFrom() for each non-empty line in data (CR/LF stripped).
+    void emitTextLines(Link& l, const uint8_t* data, size_t size);
+
+    /// Flush text on links that have been quiet for a while (m_textIdleTimer).
+    void flushIdleText();
+
+    /// True if data decodes as a downlink packet (used to split text glued to a frame).
+    bool decodes(const uint8_t* data, size_t size);
+
+    /// Publish a framed packet to raw-frame listeners, then decode it if it feeds the model.
+    /// Returns the decode status (RP_CODEC_OK when the frame isn't decoded here).
+    int dispatchFrame(int which, const FrameView& frame, qint64 rxNs, bool injected = false,
+                      bool primed = false);
+
+    /// Decode one COBS frame of `vehicle`, publish state and queue the record for the UI;
+    /// the decode result is also reported to quality (nullptr for injected frames).
+    /// Returns the rp_codec status.
+    int processFrame(int which, int vehicle, const uint8_t* data, size_t size, qint64 rxNs,
+                     qint64 framedNs, LinkQuality* quality, bool primed = false);
+
+    /// True if frames from this link feed the model without diversity (the lowest open
+    /// link id of its vehicle wins).
+    bool isPrimary(int which, int vehicle) const;
+
+    /// Number of open links assigned to the vehicle.
+    int openLinks(int vehicle) const;
+
+    /// Vehicle link `which` is assigned to (0 unless setLinkVehicle() said otherwise).
+    int vehicleOf(int which) const;
+
+    void beginRxPause(int ms);
+    void endRxPause();
+    bool isRxPause() const {
+        if (!m_rxPaused) return false;
+        return m_rxPauseTimer.isValid() && (m_rxPauseTimer.elapsed() < m_rxPauseMs);
+    }
+
+    // -----------------------
+    // Members
+    // -----------------------
+
+    std::vector<std::unique_ptr<Link>> m_links; ///< Open links, sorted by id.
+    int    m_rxFrom = 1;             ///< Link id used as RX source (for RX pausing).
+    size_t m_maxFrame = 512;         ///< Applied to every link's framer.
+    QTimer m_statsTimer;             ///< Drives linkStatsUpdated().
+    QTimer m_textIdleTimer;          ///< Flushes text lines left pending on a quiet link.
+    std::array<std::pair<int, int>, TxQueue::PriorityCount> m_txLimits{}; ///< Overrides (depth 0 = default).
+
+    bool m_rxPaused = false;         ///< RX is temporarily paused while transmitting.
+    QElapsedTimer m_rxPauseTimer;    ///< Measures the RX pause window.
+    int m_rxPauseMs = 0;             ///< RX pause length in milliseconds.
+
+    std::vector<std::pair<int, int>> m_linkVehicle; ///< (link id, vehicle) assignments.
+
+    TelemetrySnapshot m_state;                   ///< I/O-thread copy of the default vehicle's state.
+    SnapshotBuffer<TelemetrySnapshot> m_snapshot; ///< Published copy for the GUI thread.
+    RecordQueue m_records;                       ///< Decoded records for the GUI thread.
+    DownlinkRecord m_overflow;                   ///< Decode target when the queue is full.
+    tvr_Downlink   m_probe;                      ///< Scratch target for decodes().
+
+    bool              m_diversityEnabled = true;
+    DiversityCombiner m_diversity;               ///< Dedup of live frames across links.
+    LinkQuality       m_combined;                ///< Combined stream of the default vehicle.
+
+    std::atomic<bool>    m_notifyPending{false}; ///< recordsAvailable() queued but not yet acked.
+    std::atomic<quint64> m_droppedRecords{0};
+    std::atomic<FlightRecorder*> m_recorder{nullptr}; ///< Raw-frame tee (not owned).
+};
+
+#endif // SERIALWORKER_H
@@ -0,0 +1,54 @@
+#ifndef SNAPSHOTBUFFER_H
+#define SNAPSHOTBUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief SnapshotBuffer
+ * Double-buffered "latest value" mailbox between one writer and one reader thread.
+ * The writer always fills the slot the reader is not pointed at and then flips the
+ * sequence number; the reader copies the published slot and retries if the writer
+ * lapped it mid-copy. Intermediate values are intentionally skipped (latest wins).
+ * T must be trivially copyable.
+ */
+template <typename T>
+class SnapshotBuffer {
+public:
+    /// Writer side: copy value into the back slot and make it the published one.
+    void publish(const T& value) {
+        const std::uint32_t seq = m_seq.load(std::memory_order_relaxed);
+        // The back slot is the one published at seq - 1. Keep our earlier publish of seq
+        // ordered before overwriting it, so a reader still copying that slot and seeing the
+        // new bytes also sees m_seq move on and retries (weakly ordered CPUs, e.g. ARM).
+        std::atomic_thread_fence(std::memory_order_release);
+        m_slots[(seq + 1) & 1u] = value;
+        m_seq.store(seq + 1, std::memory_order_release);
+    }
+
+    /**
+     * Reader side: copy the latest published value into out.
+     * Returns false if nothing has been published yet.
+     */
+    bool read(T& out) const {
+        for (;;) {
+            const std::uint32_t seq = m_seq.load(std::memory_order_acquire);
+            if (seq == 0)
+                return false;
+            out = m_slots[seq & 1u];
+            std::atomic_thread_fence(std::memory_order_acquire);
+            // The writer only touches slot (seq & 1) again once it has published seq + 1.
+            if (m_seq.load(std::memory_order_relaxed) == seq)
+                return true;
+        }
+    }
+
+    /// Number of values published so far (cheap change check for the reader).
+    std::uint32_t sequence() const { return m_seq.load(std::memory_order_acquire); }
+
+private:
+    T m_slots[2] {};                    ///< Front/back slots, selected by the low bit of m_seq.
+    std::atomic<std::uint32_t> m_seq{0}; ///< Publish counter; 0 means "never published".
+};
+
+#endif // SNAPSHOTBUFFER_H
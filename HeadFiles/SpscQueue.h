@@ -0,0 +1,91 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @brief SpscQueue
+ * Fixed-capacity, lock-free single-producer/single-consumer ring.
+ * The producer thread only advances m_head, the consumer thread only advances m_tail,
+ * so neither side ever blocks or allocates. Slots are reused in place.
+ */
+template <typename T, std::size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscQueue capacity must be a power of two");
+
+public:
+    // -----------------------
+    // Producer side
+    // -----------------------
+
+    /// Return the next free slot to fill in place, or nullptr when the queue is full.
+    T* beginPush() {
+        const std::size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) >= Capacity)
+            return nullptr;
+        return &m_slots[head & (Capacity - 1)];
+    }
+
+    /// Publish the slot returned by beginPush() to the consumer.
+    void endPush() {
+        m_head.store(m_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /// Copy an item in; returns false (item dropped) when the queue is full.
+    bool push(const T& item) {
+        T* slot = beginPush();
+        if (!slot)
+            return false;
+        *slot = item;
+        endPush();
+        return true;
+    }
+
+    // -----------------------
+    // Consumer side
+    // -----------------------
+
+    /// Return the oldest published item without removing it, or nullptr when empty.
+    T* front() {
+        const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire))
+            return nullptr;
+        return &m_slots[tail & (Capacity - 1)];
+    }
+
+    /// Release the item returned by front() back to the producer.
+    void popFront() {
+        m_tail.store(m_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /// Copy out the oldest item; returns false when empty.
+    bool pop(T& out) {
+        T* slot = front();
+        if (!slot)
+            return false;
+        out = *slot;
+        popFront();
+        return true;
+    }
+
+    // -----------------------
+    // Either side
+    // -----------------------
+
+    /// Approximate number of queued items (exact only when both sides are idle).
+    std::size_t sizeApprox() const {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+
+    static constexpr std::size_t capacity() { return Capacity; }
+
+private:
+    alignas(64) std::atomic<std::size_t> m_head{0}; ///< Next slot the producer will fill.
+    alignas(64) std::atomic<std::size_t> m_tail{0}; ///< Next slot the consumer will read.
+    alignas(64) std::array<T, Capacity> m_slots{};  ///< Ring storage, reused in place.
+};
+
+#endif // SPSCQUEUE_H
@@ -0,0 +1,115 @@
+#ifndef TELEMETRYALARMS_H
+#define TELEMETRYALARMS_H
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QVariantList>
+#include <array>
+#include <vector>
+
+#include "DownlinkRecord.h"
+
+/**
+ * @brief TelemetryAlarms
+ * Alarm rules evaluated on decoded downlink fields instead of firmware text. Each rule
+ * watches one input (a SystemStatus flag, a TelemetryState derived value or the age of
+ * the last TelemetryState) and raises when it crosses raiseAt, clearing only once it is
+ * back past clearAt (hysteresis). Both transitions must hold for debounceMs first.
+ *
+ * The rules are compiled into a flat table grouped by the packet type that updates their
+ * input: a SystemStatus evaluates only the status rules, a TelemetryState the telemetry
+ * and silence rules, and a 100 ms clock the silence rules. Evaluation is a loop over
+ * plain structs per record; text is only touched on a transition.
+ *
+ * Transitions are emitted as alarmRaised / alarmCleared with an AlarmRules severity
+ * (clears are reported as Success) and the rule name.
+ */
+class TelemetryAlarms : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(QVariantList rules READ rules NOTIFY rulesChanged)
+    Q_PROPERTY(int activeCount READ activeCount NOTIFY rulesChanged)
+
+public:
+    explicit TelemetryAlarms(QObject* parent = nullptr);
+
+    /// Evaluate the rules fed by this record; state is the per-record snapshot after it.
+    void evaluate(const DownlinkRecord& rec, const TelemetrySnapshot& state);
+
+    /// Change a rule's thresholds and debounce; false if no rule has this name.
+    Q_INVOKABLE bool configure(const QString& name, double raiseAt, double clearAt, int debounceMs);
+
+    /// Enable or disable a rule (disabling clears it silently).
+    Q_INVOKABLE bool setEnabled(const QString& name, bool enabled);
+
+    /// Forget all rule state and the telemetry clock (e.g. a new flight or replay).
+    Q_INVOKABLE void reset();
+
+    /// [{name, input, enabled, active, raiseAt, clearAt, debounceMs, severity, raised, value}]
+    QVariantList rules() const { return m_rows; }
+
+    int activeCount() const { return m_activeCount; }
+
+signals:
+    void alarmRaised(int severity, const QString& text, const QString& rule);
+    void alarmCleared(int severity, const QString& text, const QString& rule);
+    void rulesChanged();
+
+private:
+    /// Values rules can watch.
+    enum Input {
+        AccelOk = 0, GyroOk, Baro1Ok, Baro2Ok, GpsConnected,  // SystemStatus
+        GimbalAbs, TiltRate,                                   // TelemetryState
+        TelemetryAgeMs,                                        // clock
+        InputCount
+    };
+
+    /// Rule groups, each evaluated by one kind of update.
+    enum Group { StatusGroup = 0, TelemetryGroup, ClockGroup, GroupCount };
+
+    /// One row of the evaluation table.
+    struct Rule {
+        quint8  input = 0;
+        bool    above = true;        ///< Raise when value > raiseAt (else value < raiseAt).
+        bool    enabled = true;
+        bool    active = false;
+        double  raiseAt = 0.0;
+        double  clearAt = 0.0;
+        qint64  debounceNs = 0;
+        qint64  pendingNs = 0;       ///< When the opposite condition started to hold (0 = not).
+        qint32  severity = 0;
+        quint32 raised = 0;          ///< Times raised.
+    };
+
+    struct RuleText {
+        QString name;
+        QString raiseText;
+        QString clearText;
+    };
+
+    static Group groupOf(int input);
+    static QString inputName(int input);
+
+    /// Run the rules of one group against m_inputs at time nowNs.
+    void evaluateGroup(int group, qint64 nowNs);
+
+    /// Rule index by name, or -1.
+    int find(const QString& name) const;
+
+    void onClock();
+    void publish();
+
+    std::vector<Rule>     m_rules;            ///< Sorted by group.
+    std::vector<RuleText> m_text;             ///< Parallel to m_rules.
+    std::array<int, GroupCount + 1> m_groupBegin {};
+    std::array<double, InputCount> m_inputs {};
+    std::array<bool, InputCount>   m_known {}; ///< Input has been seen since reset().
+
+    qint64  m_lastTelemetryNs = 0;
+    int     m_activeCount = 0;
+    bool    m_dirty = false;
+    QTimer  m_clock;
+    QVariantList m_rows;
+};
+
+#endif // TELEMETRYALARMS_H
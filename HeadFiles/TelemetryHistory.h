@@ -0,0 +1,106 @@
+#ifndef TELEMETRYHISTORY_H
+#define TELEMETRYHISTORY_H
+
+#include <QObject>
+#include <QVariantMap>
+#include <array>
+#include <vector>
+
+#include "DownlinkRecord.h"
+
+/**
+ * @brief TelemetryHistory
+ * Columnar in-memory time series of the TelemetryState display fields, keyed by the
+ * rocket's timestamp_ms. Each field is one contiguous ring; on top of the raw rings sit
+ * min/max/mean pyramid levels (4, 16, 64, ... samples per bucket) that are updated
+ * incrementally on every append. A window query picks the coarsest level that still
+ * gives maxPoints buckets, so fetching any span costs O(pixels), not O(samples).
+ */
+class TelemetryHistory : public QObject {
+    Q_OBJECT
+
+    Q_PROPERTY(int    sampleCount READ sampleCount NOTIFY samplesAppended)
+    Q_PROPERTY(double oldestMs    READ oldestMs    NOTIFY samplesAppended)
+    Q_PROPERTY(double newestMs    READ newestMs    NOTIFY samplesAppended)
+
+public:
+    /// Recorded fields; names match the SensorDataModel properties they mirror.
+    enum Field {
+        Altitude = 0, PosX, PosY,
+        Velocity,
+        FilteredAngleX, FilteredAngleY, FilteredAngleZ,
+        RawAngleX, RawAngleY, RawAngleZ,
+        ThrustCmd, GimbalX, GimbalY,
+        FieldCount
+    };
+    Q_ENUM(Field)
+
+    /// One output point of a window query.
+    struct Bucket {
+        double tMs;   ///< timestamp_ms of the first sample in the bucket.
+        float  min;
+        float  max;
+        float  mean;
+    };
+
+    /// Keeps the newest 2^capacityLog2 samples per field.
+    explicit TelemetryHistory(int capacityLog2 = 16, QObject* parent = nullptr);
+
+    /// Append one TelemetryState sample (values taken from the already converted snapshot).
+    void append(quint32 timestampMs, const TelemetrySnapshot& s);
+
+    /// Emit samplesAppended() once if anything was appended since the last flush.
+    void flush();
+
+    /**
+     * Fill out with at most ~maxPoints buckets covering [fromMs, toMs] for field.
+     * Returns the pyramid level used (0 = raw samples).
+     */
+    int query(Field field, double fromMs, double toMs, int maxPoints, std::vector<Bucket>& out) const;
+
+    // -----------------------
+    // QML API
+    // -----------------------
+
+    /// {t, min, max, mean} arrays for field over [fromMs, toMs], decimated to maxPoints.
+    Q_INVOKABLE QVariantMap window(const QString& field, double fromMs, double toMs, int maxPoints) const;
+
+    /// Same as window() for the last `seconds` before the newest sample.
+    Q_INVOKABLE QVariantMap recent(const QString& field, double seconds, int maxPoints) const;
+
+    /// Forget all samples.
+    Q_INVOKABLE void clear();
+
+    int    sampleCount() const { return int(m_next - m_first); }
+    double oldestMs() const;
+    double newestMs() const;
+
+signals:
+    void samplesAppended();
+
+private:
+    /// One decimation level: bucket = 2^shift raw samples.
+    struct Level {
+        int    shift = 0;
+        size_t mask  = 0;
+        std::vector<double> t;
+        std::array<std::vector<float>, FieldCount> mn, mx, mean;
+        std::array<double, FieldCount> sum {};   ///< Running sum of the open bucket.
+    };
+
+    /// Absolute index of the first retained sample with time >= ms (binary search).
+    quint64 lowerBound(double ms) const;
+
+    static int fieldFromName(const QString& name);
+
+    size_t m_mask = 0;                                    ///< Raw ring mask (capacity - 1).
+    std::vector<double> m_time;                           ///< timestamp_ms column.
+    std::array<std::vector<float>, FieldCount> m_values;  ///< One column per field.
+    std::vector<Level> m_levels;                          ///< Pyramid, finest first.
+
+    quint64 m_first = 0;   ///< Absolute index of the oldest retained sample.
+    quint64 m_next  = 0;   ///< Absolute index of the next sample to append.
+    bool    m_dirty = false;
+};
+
+#endif // TELEMETRYHISTORY_H
@@ -0,0 +1,66 @@
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <QObject>
+#include <QString>
+
+/**
+ * @brief Transport
+ * Byte-stream link used by SerialWorker (one per link, living on the I/O thread).
+ * Implementations only move bytes; COBS framing, decoding and statistics stay in the
+ * worker so every link type goes through the same RX pipeline.
+ *
+ * Link specs accepted by create():
+ *   "<port>" or "serial:<port>"     QSerialPort (COM3, ttyUSB0, /dev/pts/4, ...)
+ *   "pty"                           new pseudo-terminal; peers open the slave path (Unix)
+ *   "udp:<localPort>[:<peerPort>]"  datagrams on 127.0.0.1; replies go to the last sender
+ *                                   unless peerPort is given
+ *   "file:<path>"                   raw byte capture played as RX, paced at baud/10 B/s
+ *                                   (baud <= 0: as fast as possible); TX is discarded
+ */
+class Transport : public QObject {
+    Q_OBJECT
+
+public:
+    explicit Transport(QObject* parent = nullptr) : QObject(parent) {}
+
+    /// Build the transport for spec (not opened yet).
+    static Transport* create(const QString& spec, int baud, QObject* parent = nullptr);
+
+    virtual bool open() = 0;
+    virtual void close() = 0;
+    virtual bool isOpen() const = 0;
+
+    /// Non-blocking read of up to max bytes; returns bytes read (0 if none, < 0 on error).
+    virtual qint64 read(char* dst, qint64 max) = 0;
+
+    /// Queue bytes for sending without blocking; returns bytes accepted (possibly fewer
+    /// than size, then bytesWritten() follows once there is room) or < 0 on error.
+    virtual qint64 write(const char* data, qint64 size) = 0;
+
+    /// Bytes accepted by write() but not yet handed to the OS.
+    virtual qint64 bytesToWrite() const { return 0; }
+
+    /// Push queued bytes towards the device as far as possible without blocking.
+    virtual void flush() {}
+
+    /// Line rate in baud, or 0 for links without a meaningful bit rate.
+    virtual int baudRate() const { return 0; }
+
+    /// Human-readable spec of the open link (e.g. the pty slave path).
+    virtual QString describe() const = 0;
+
+    virtual QString errorString() const = 0;
+
+signals:
+    /// New bytes can be read.
+    void readyRead();
+
+    /// Queued bytes went out or room became available for more (bytes may be 0).
+    void bytesWritten(qint64 bytes);
+
+    /// Runtime failure (device unplugged, socket error, ...).
+    void errorOccurred(const QString& msg);
+};
+
+#endif // TRANSPORT_H
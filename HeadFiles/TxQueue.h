@@ -0,0 +1,93 @@
+#ifndef TXQUEUE_H
+#define TXQUEUE_H
+
+#include <QByteArray>
+#include <QtGlobal>
+#include <array>
+#include <deque>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief TxQueue
+ * Per-link outgoing message queue drained by SerialWorker as the transport's write
+ * buffer empties. Messages are kept in priority classes; pop() always returns the
+ * oldest message of the most urgent non-empty class, so an ABORT queued behind a burst
+ * of periodic test lines still goes out next.
+ *
+ * Every class has a bounded depth and a policy for when it is full:
+ *   DropNewest  the new message is refused
+ *   DropOldest  the oldest queued message of that class is evicted
+ *   Coalesce    a queued message with the same key is replaced in place (keeping its
+ *               turn); without a match the oldest is evicted as for DropOldest
+ *
+ * Not thread-safe; owned and used by the I/O thread only.
+ */
+class TxQueue {
+public:
+    enum Priority {
+        Critical = 0,   ///< Abort / safety state commands.
+        Command,        ///< Other flight commands.
+        Normal,         ///< One-off operator traffic.
+        Periodic,       ///< Repeating test traffic.
+        PriorityCount
+    };
+
+    enum Policy { DropNewest, DropOldest, Coalesce };
+
+    /// How a message left the queue (reported to completion callbacks).
+    enum Result {
+        Sent = 0,       ///< Handed completely to the transport.
+        Failed,         ///< The transport reported a write error.
+        Dropped,        ///< Refused or evicted because its class was full.
+        Superseded,     ///< Replaced by a newer message with the same coalesce key.
+        Closed          ///< The link closed before it was sent.
+    };
+
+    struct Message {
+        quint64    id = 0;          ///< Caller's handle (0: nobody waits for completion).
+        QByteArray data;
+        QByteArray key;             ///< Coalesce key; empty never coalesces.
+        bool       text = false;    ///< Text line (pauses RX on a shared half-duplex link).
+        qint64     enqueuedNs = 0;
+    };
+
+    TxQueue();
+
+    void setLimit(Priority p, int depth, Policy policy);
+
+    /**
+     * Queue msg in class p. Messages pushed out by it (evicted or superseded) are
+     * appended to *displaced together with their Result. Returns false if msg itself
+     * was refused (DropNewest on a full class).
+     */
+    bool push(Priority p, Message&& msg, std::vector<std::pair<Message, Result>>* displaced);
+
+    /// Take the next message to send; false if every class is empty.
+    bool pop(Message* out);
+
+    /// Remove everything (link closed), oldest-first per class, most urgent class first.
+    void clear(std::vector<Message>* removed);
+
+    bool   empty() const { return size() == 0; }
+    size_t size() const;
+    size_t size(Priority p) const { return m_classes[size_t(p)].queue.size(); }
+
+    quint64 dropped() const { return m_dropped; }
+    quint64 superseded() const { return m_superseded; }
+
+    static Priority clampPriority(int p) { return Priority(qBound(0, p, int(PriorityCount) - 1)); }
+
+private:
+    struct Class {
+        std::deque<Message> queue;
+        int    depth  = 64;
+        Policy policy = DropOldest;
+    };
+
+    std::array<Class, PriorityCount> m_classes;
+    quint64 m_dropped = 0;
+    quint64 m_superseded = 0;
+};
+
+#endif // TXQUEUE_H
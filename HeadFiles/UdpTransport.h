@@ -0,0 +1,43 @@
+#ifndef UDPTRANSPORT_H
+#define UDPTRANSPORT_H
+
+#include <QHostAddress>
+#include <QUdpSocket>
+
+#include "Transport.h"
+
+/**
+ * @brief UdpTransport
+ * Datagram link on 127.0.0.1 (simulators, test harnesses, link bridges). Each datagram
+ * is appended to the RX byte stream as-is, so senders keep the COBS 0x00 delimiters.
+ * TX goes to peerPort if given, otherwise to whoever sent the last datagram.
+ * A datagram larger than the caller's buffer (e.g. the contiguous room left before an
+ * RxRing wraps) is read whole into a spill buffer and handed out over the next reads.
+ */
+class UdpTransport : public Transport {
+    Q_OBJECT
+
+public:
+    UdpTransport(quint16 localPort, quint16 peerPort, QObject* parent = nullptr);
+
+    bool open() override;
+    void close() override;
+    bool isOpen() const override { return m_socket.state() == QAbstractSocket::BoundState; }
+
+    qint64 read(char* dst, qint64 max) override;
+    qint64 write(const char* data, qint64 size) override;
+
+    QString describe() const override;
+    QString errorString() const override { return m_error.isEmpty() ? m_socket.errorString() : m_error; }
+
+private:
+    QUdpSocket m_socket;
+    quint16    m_localPort;
+    quint16    m_peerPort;          ///< Fixed peer, or 0 to answer the last sender.
+    quint16    m_lastSenderPort = 0;
+    QByteArray m_spill;             ///< Rest of a datagram that did not fit the last read().
+    qsizetype  m_spillPos = 0;
+    QString    m_error;
+};
+
+#endif // UDPTRANSPORT_H
@@ -0,0 +1,52 @@
+#ifndef VEHICLEMODEL_H
+#define VEHICLEMODEL_H
+
+#include <QPointer>
+
+#include "SensorDataModel.h"
+
+class VehicleRouter;
+
+/**
+ * @brief VehicleModel
+ * A SensorDataModel for one vehicle, created from QML:
+ *
+ *     VehicleModel { router: vehicleRouter; vehicle: 2 }
+ *
+ * Same properties, packet log and history as sensorData, fed by VehicleRouter with the
+ * records of its vehicle only. Changing router or vehicle re-seeds the display state
+ * from the router's table.
+ */
+class VehicleModel : public SensorDataModel {
+    Q_OBJECT
+    Q_PROPERTY(VehicleRouter* router READ router WRITE setRouter NOTIFY routerChanged)
+    Q_PROPERTY(int vehicle READ vehicle WRITE setVehicle NOTIFY vehicleChanged)
+
+public:
+    explicit VehicleModel(QObject* parent = nullptr);
+    ~VehicleModel() override;
+
+    VehicleRouter* router() const { return m_router; }
+    void setRouter(VehicleRouter* router);
+
+    int  vehicle() const { return m_vehicle; }
+    void setVehicle(int vehicle);
+
+    /// Per-record work for one record of this vehicle (called by VehicleRouter::route()).
+    void ingest(const DownlinkRecord& rec) { onDownlinkRecord(rec); }
+
+    /// Latest state of the vehicle after a drain (called by VehicleRouter::flush()).
+    void applyBatch(const TelemetrySnapshot& state);
+
+signals:
+    void routerChanged();
+    void vehicleChanged();
+
+private:
+    /// Follow (router, vehicle) and take over the vehicle's current state.
+    void resubscribe();
+
+    QPointer<VehicleRouter> m_router;
+};
+
+#endif // VEHICLEMODEL_H
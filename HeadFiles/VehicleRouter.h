@@ -0,0 +1,98 @@
+#ifndef VEHICLEROUTER_H
+#define VEHICLEROUTER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QQuickWindow>
+#include <QTimer>
+#include <QVariantList>
+#include <utility>
+#include <vector>
+
+#include "DownlinkRecord.h"
+
+class SerialBridge;
+class VehicleModel;
+
+/**
+ * @brief VehicleRouter
+ * Splits the decoded downlink by vehicle so one ground station can follow several test
+ * articles at once (e.g. a static-fire stand and a hop vehicle on their own radios).
+ * The downlink carries no vehicle id, so a vehicle is the set of links assigned to it
+ * (assignLink(); unassigned links belong to vehicle 0, the one shown by sensorData).
+ * The I/O thread stamps every record with its vehicle and combines links per vehicle.
+ *
+ * SensorDataModel hands every drained record to route(), which folds it into a flat
+ * table of per-vehicle state and forwards it to the VehicleModel instances following
+ * that vehicle; flush() then gives each of them the vehicle's latest state once per
+ * drain. Each VehicleModel is its own object with its own notifications, so panels
+ * bound to different vehicles never share (or wait on) one model.
+ */
+class VehicleRouter : public QObject {
+    Q_OBJECT
+    Q_PROPERTY(QVariantList vehicles READ vehicles NOTIFY vehiclesChanged)
+
+public:
+    explicit VehicleRouter(SerialBridge* bridge, QObject* parent = nullptr);
+
+    /// Fold one decoded record into its vehicle and forward it to that vehicle's models.
+    void route(const DownlinkRecord& rec);
+
+    /// Hand every vehicle updated since the last flush its latest state (once per drain).
+    void flush();
+
+    /// Assign a link (open or not yet) to a vehicle; 0 returns it to the default vehicle.
+    Q_INVOKABLE void assignLink(int link, int vehicle);
+
+    /// Vehicle a link is assigned to.
+    Q_INVOKABLE int vehicleOfLink(int link) const;
+
+    /// One row per vehicle heard or assigned: {vehicle, links, packets, decodeErrors,
+    /// ageMs, flightState, uptimeMs, models} (refreshed once a second).
+    QVariantList vehicles() const { return m_rows; }
+
+    /// Latest state of a vehicle, or nullptr if nothing was heard from it yet.
+    const TelemetrySnapshot* state(int vehicle) const;
+
+    /// Window whose frames flush the models' notifications (see SensorDataModel). Models
+    /// attached before the window exists (created while QML loads) get it here.
+    void setFrameWindow(QQuickWindow* window);
+    QQuickWindow* frameWindow() const { return m_frameWindow; }
+
+    /// Called by VehicleModel when it starts/stops following `vehicle`.
+    void attach(VehicleModel* model, int vehicle);
+    void detach(VehicleModel* model);
+
+signals:
+    void vehiclesChanged();
+
+private:
+    /// One row of the state table; hot counters first, the snapshot last.
+    struct VehicleState {
+        int     id = 0;
+        bool    dirty = false;       ///< Updated since the last flush().
+        quint32 packets = 0;
+        quint32 decodeErrors = 0;
+        qint64  lastRxNs = 0;
+        TelemetrySnapshot state;
+    };
+
+    /// Table index of a vehicle, appended on first use.
+    int slotOf(int vehicle);
+
+    void publish();
+
+    QPointer<SerialBridge> m_bridge;
+    std::vector<VehicleState> m_table;
+    int m_lastVehicle = 0;           ///< Lookup cache: records arrive in runs per vehicle.
+    int m_lastSlot = -1;
+
+    std::vector<std::pair<int, int>>            m_assign;  ///< (link, vehicle) for non-default links.
+    std::vector<std::pair<int, VehicleModel*>>  m_models;  ///< (vehicle, model) subscriptions.
+
+    QPointer<QQuickWindow> m_frameWindow;
+    QTimer       m_publishTimer;
+    QVariantList m_rows;
+};
+
+#endif // VEHICLEROUTER_H
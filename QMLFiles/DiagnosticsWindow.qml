@@ -0,0 +1,232 @@
+import QtQuick 2.15
+import QtQuick.Controls 2.15
+import QtQuick.Layouts 1.15
+import QtQuick.Window 2.15
+import "Items"
+
+ApplicationWindow {
+    id: diagWin
+    width: 760
+    height: 640
+    visible: false
+    title: "Downlink Diagnostics"
+    modality: Qt.NonModal
+    flags: Qt.Window
+
+    font.family: Theme.fontFamily
+
+    palette {
+        window:          Theme.background
+        base:            Theme.surfaceInset
+        alternateBase:   Theme.surfaceElevated
+        text:            Theme.textPrimary
+        windowText:      Theme.textPrimary
+        button:          Theme.btnSecondaryBg
+        buttonText:      Theme.btnSecondaryText
+        highlight:       Theme.accent
+        highlightedText: Theme.background
+        placeholderText: Theme.textTertiary
+        mid:             Theme.border
+        dark:            Theme.border
+        light:           Theme.borderLight
+    }
+
+    // 0 = all links aggregated, otherwise a link id
+    property int linkFilter: 0
+
+    readonly property var linkIds: {
+        const ids = []
+        for (const row of latency.stages)
+            if (row.link !== 0 && ids.indexOf(row.link) < 0)
+                ids.push(row.link)
+        return ids.sort((a, b) => a - b)
+    }
+
+    readonly property var rows: latency.stages.filter(r => r.link === linkFilter)
+
+    readonly property var columns: [
+        { title: "Stage",    width: 110 },
+        { title: "Samples",  width: 100 },
+        { title: "p50 (ms)", width: 100 },
+        { title: "p99 (ms)", width: 100 },
+        { title: "max (ms)", width: 100 },
+        { title: "mean (ms)", width: 100 }
+    ]
+
+    function ms(us) { return (us / 1000).toFixed(us < 10000 ? 3 : 1) }
+    function pct(x) { return (100 * x).toFixed(1) + " %" }
+
+    // Link quality window shown below (index into each link's quality.windows: 1 s / 10 s / 60 s)
+    property int qualityWindow: 1
+
+    ColumnLayout {
+        anchors.fill: parent
+        anchors.margins: Theme.paddingMd
+        spacing: Theme.paddingSm
+
+        RowLayout {
+            Layout.fillWidth: true
+            spacing: Theme.paddingSm
+
+            Label { text: "Link" }
+            ComboBox {
+                id: linkSel
+                model: ["All"].concat(linkIds.map(id => "P" + id))
+                onActivated: linkFilter = currentIndex === 0 ? 0 : linkIds[currentIndex - 1]
+            }
+
+            CheckBox {
+                text: "Sender clock is monotonic (simulator)"
+                checked: latency.senderClockMonotonic
+                onToggled: latency.senderClockMonotonic = checked
+            }
+
+            Item { Layout.fillWidth: true }
+
+            Button {
+                text: "Reset"
+                onClicked: latency.reset()
+            }
+        }
+
+        // Header row
+        Row {
+            Layout.fillWidth: true
+            Repeater {
+                model: columns
+                delegate: Label {
+                    width: modelData.width
+                    text: modelData.title
+                    color: Theme.textSecondary
+                    font.bold: true
+                }
+            }
+        }
+
+        ListView {
+            Layout.fillWidth: true
+            Layout.fillHeight: true
+            clip: true
+            model: rows
+            delegate: Row {
+                readonly property var r: modelData
+                Label { width: columns[0].width; text: r.stage }
+                Label { width: columns[1].width; text: r.count }
+                Label { width: columns[2].width; text: ms(r.p50Us) }
+                Label { width: columns[3].width; text: ms(r.p99Us) }
+                Label { width: columns[4].width; text: ms(r.maxUs) }
+                Label { width: columns[5].width; text: ms(r.meanUs) }
+            }
+        }
+
+        Label {
+            Layout.fillWidth: true
+            wrapMode: Text.WordWrap
+            color: Theme.textTertiary
+            text: "link: sender → readyRead · framing: readyRead → delimiter · decode: I/O-thread decode · "
+                  + "handoff: queue → model · render: model → frame swap · total: readyRead → frame swap"
+                  + (latency.unrenderedDropped > 0 ? "   (" + latency.unrenderedDropped + " never rendered)" : "")
+        }
+
+        // Link quality (sliding windows computed on the I/O thread)
+        RowLayout {
+            Layout.fillWidth: true
+            spacing: Theme.paddingSm
+
+            Label { text: "Link quality"; font.bold: true }
+            Item { Layout.fillWidth: true }
+            Label { text: "Window" }
+            ComboBox {
+                model: ["1 s", "10 s", "60 s"]
+                currentIndex: qualityWindow
+                onActivated: qualityWindow = currentIndex
+            }
+        }
+
+        Repeater {
+            model: bridge.links
+            delegate: GridLayout {
+                readonly property var q: modelData.quality ? modelData.quality.windows[qualityWindow] : null
+                Layout.fillWidth: true
+                columns: 4
+                columnSpacing: Theme.paddingMd
+                visible: q !== null
+
+                Label { Layout.columnSpan: 4; text: "P" + modelData.id + "  " + modelData.description; color: Theme.textSecondary }
+                Label { text: q ? q.framesPerSec.toFixed(1) + " frames/s" : "" }
+                Label { text: q ? (q.bytesPerSec / 1024).toFixed(2) + " KiB/s" : "" }
+                Label { text: q ? "decode errors " + q.decodeErrors + " (" + pct(q.decodeErrorRate) + ")" : "" }
+                Label { text: q ? "missed telemetry " + q.missedTelemetry : "" }
+                Label { text: q ? "downlink loss " + pct(q.downlinkLoss) + " (" + q.downlinkReceived + "/" + q.downlinkSent + ")" : "" }
+                Label { text: q ? "uplink loss " + pct(q.uplinkLoss) + " (" + q.uplinkReceived + "/" + q.uplinkSent + ")" : "" }
+                Label { text: "oversize drops " + modelData.oversizeDrops }
+                Label { text: "tx errors " + modelData.txErrors }
+                Label { text: "text lines " + modelData.textLines }
+                Label { text: "discarded " + modelData.discardedBytes + " B" }
+                Label {
+                    Layout.columnSpan: 4
+                    readonly property var d: modelData.diversity
+                    visible: bridge.diversity.enabled === true && d !== undefined && d.offered !== undefined
+                    text: d && d.offered !== undefined
+                          ? "diversity: first " + d.first + " · duplicate " + d.duplicates
+                            + " (+" + d.lagMs.toFixed(1) + " ms) · only link " + d.solo
+                          : ""
+                }
+            }
+        }
+
+        // Combined downlink (first copy of each packet across all links)
+        Label {
+            readonly property var d: bridge.diversity
+            readonly property var q: d.quality ? d.quality.windows[qualityWindow] : null
+            visible: d.enabled === true && bridge.links.length > 1
+            text: "Combined  " + (q ? q.framesPerSec.toFixed(1) + " frames/s · downlink loss "
+                                      + pct(q.downlinkLoss) + " · " : "")
+                  + d.unique + " unique · " + d.duplicates + " duplicates · "
+                  + d.multiLink + " heard by several links"
+        }
+
+        // Vehicles (links are assigned with vehicleRouter.assignLink(link, vehicle))
+        Label { text: "Vehicles"; font.bold: true; visible: vehicleRouter.vehicles.length > 1 }
+        Repeater {
+            model: vehicleRouter.vehicles.length > 1 ? vehicleRouter.vehicles : []
+            delegate: Label {
+                text: "Vehicle " + modelData.vehicle + "  links [" + modelData.links.join(", ") + "]"
+                      + " · " + modelData.packets + " packets · " + modelData.decodeErrors + " errors"
+                      + (modelData.ageMs >= 0 ? " · last " + modelData.ageMs.toFixed(0) + " ms ago" : "")
+                      + " · state " + modelData.flightState + " · " + modelData.models + " views"
+            }
+        }
+
+        // Flight command delivery (confirmed through cmd_rx_count / flight state)
+        Label { text: "Command round trip"; font.bold: true; visible: commandTracker.rttStats.length > 0 }
+        Repeater {
+            model: commandTracker.rttStats
+            delegate: Label {
+                text: modelData.name + "  sent " + modelData.sent + " · acked " + modelData.acked
+                      + " · failed " + modelData.failed + " · retries " + modelData.retries
+                      + (modelData.acked > 0 ? "  ·  p50 " + modelData.p50Ms.toFixed(0) + " ms, p99 "
+                                               + modelData.p99Ms.toFixed(0) + " ms, max "
+                                               + modelData.maxMs.toFixed(0) + " ms" : "")
+            }
+        }
+
+        RowLayout {
+            Layout.fillWidth: true
+            spacing: Theme.paddingSm
+
+            TextField {
+                id: dumpPath
+                Layout.fillWidth: true
+                placeholderText: "/tmp/latency.json"
+                selectByMouse: true
+            }
+            Button {
+                text: "Dump JSON"
+                enabled: dumpPath.text.length > 0
+                onClicked: dumpStatus.text = latency.dump(dumpPath.text) ? "Written" : "Write failed"
+            }
+            Label { id: dumpStatus; color: Theme.textSecondary }
+        }
+    }
+}
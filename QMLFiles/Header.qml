@@ -1,4 +1,5 @@
 import QtQuick
+import QtQuick.Controls
 import "Items"
 
 Rectangle {
@@ -64,6 +65,53 @@ Rectangle {
         color: Theme.textSecondary
     }
 
+    // Last recorder error; cleared once a recording runs again
+    property string recorderError: ""
+
+    Connections {
+        target: recorder
+        function onErrorMessage(msg) { header.recorderError = msg }
+        function onRecordingChanged() {
+            if (recorder.recording)
+                header.recorderError = ""
+        }
+    }
+
+    // Recording badge — left of the flight state badge
+    Rectangle {
+        id: recordingBadge
+        anchors.right: flightStateBadge.left
+        anchors.verticalCenter: parent.verticalCenter
+        anchors.rightMargin: 12
+        width: recordingText.implicitWidth + 24
+        height: 32
+        radius: Theme.radiusPanel
+        color: recorder.recording ? Theme.danger
+             : header.recorderError !== "" ? Theme.warn
+             : Theme.textTertiary
+
+        Text {
+            id: recordingText
+            anchors.centerIn: parent
+            text: recorder.recording ? "● REC"
+                : header.recorderError !== "" ? "REC FAILED"
+                : "NOT RECORDING"
+            font.family: Theme.fontFamily
+            font.pixelSize: Theme.fontH2
+            font.bold: true
+            color: Theme.textPrimary
+        }
+
+        // Full error text on hover
+        MouseArea {
+            id: recordingHover
+            anchors.fill: parent
+            hoverEnabled: true
+        }
+        ToolTip.visible: recordingHover.containsMouse && header.recorderError !== ""
+        ToolTip.text: header.recorderError
+    }
+
     // Flight state badge — top-right of header
     Rectangle {
         id: flightStateBadge
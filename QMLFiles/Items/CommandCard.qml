@@ -14,6 +14,19 @@ Component {
         property string cmd: ""         // Actual single-letter code to emit (e.g., "H").
 
         readonly property bool hovered: ma.containsMouse // Centralized hover state for styling.
+
+        // Delivery of the last command of this type: {state: 0 queued, 1 sent, 2 acked, 3 failed, ...}.
+        readonly property var track: commandTracker.latest[cmd]
+        readonly property string trackText: {
+            if (!track)
+                return 'sends "' + cmd + '"'
+            switch (track.state) {
+            case 0: return "queued"
+            case 1: return track.attempts > 1 ? "sent, retry " + (track.attempts - 1) : "sent, awaiting ack"
+            case 2: return "acked in " + track.rttMs.toFixed(0) + " ms (" + track.via + ")"
+            default: return "NOT CONFIRMED: " + track.reason
+            }
+        }
         Behavior on color { ColorAnimation { duration: Theme.transitionFast } } // Smooth hover color transition.
         Behavior on scale { NumberAnimation { duration: 90 } } // Brief press/release animation.
 
@@ -36,8 +49,8 @@ Component {
             }
 
             Text {
-                text: 'sends "' + cmd + '"' // Secondary hint: shows the code that will be sent.
-                color: Theme.textSecondary
+                text: trackText // Secondary hint: the code to send, then whether the rocket got it.
+                color: track && track.state === 3 ? Theme.danger : Theme.textSecondary
                 font.family: Theme.fontFamily
                 font.pixelSize: 12
                 horizontalAlignment: Text.AlignHCenter
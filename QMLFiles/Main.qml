@@ -43,6 +43,8 @@ ApplicationWindow {
 
     property var radioConsole: null
     property var radioOutput: null
+    property var replayWindow: null
+    property var diagnosticsWindow: null
 
     Component {
         id: radioConsoleComponent
@@ -54,6 +56,16 @@ ApplicationWindow {
         RadioOutputWindow { }
     }
 
+    Component {
+        id: replayComponent
+        ReplayWindow { }
+    }
+
+    Component {
+        id: diagnosticsComponent
+        DiagnosticsWindow { }
+    }
+
     function openRadioConsole() {
         if (!radioConsole) {
             radioConsole = radioConsoleComponent.createObject(window, {
@@ -79,6 +91,96 @@ ApplicationWindow {
         radioOutput.requestActivate()
     }
 
+    function openReplay() {
+        if (!replayWindow) {
+            replayWindow = replayComponent.createObject(window, {
+                x: window.x + 80,
+                y: window.y + 80
+            })
+        }
+        replayWindow.show()
+        replayWindow.raise()
+        replayWindow.requestActivate()
+    }
+
+    function openDiagnostics() {
+        if (!diagnosticsWindow) {
+            diagnosticsWindow = diagnosticsComponent.createObject(window, {
+                x: window.x + 100,
+                y: window.y + 100
+            })
+        }
+        diagnosticsWindow.show()
+        diagnosticsWindow.raise()
+        diagnosticsWindow.requestActivate()
+    }
+
+    // Bottom-right button to open the downlink diagnostics window (latency, link quality)
+    Basic.Button {
+        id: openDiagnosticsBtn
+        text: "Diagnostics"
+        anchors.bottom: parent.bottom
+        anchors.right: openReplayBtn.left
+        anchors.margins: 8
+        z: 9999
+        hoverEnabled: true
+        padding: 10
+        font.family: Theme.fontFamily
+        font.pixelSize: Theme.fontBody
+
+        background: Rectangle {
+            radius: Theme.radiusControl
+            color: openDiagnosticsBtn.down    ? Theme.btnPrimaryPress
+                 : openDiagnosticsBtn.hovered ? Theme.btnPrimaryHover
+                 :                              Theme.btnPrimaryBg
+            border.width: Theme.strokeControl
+            border.color: Theme.btnPrimaryBorder
+            Behavior on color { ColorAnimation { duration: Theme.transitionFast } }
+        }
+        contentItem: Text {
+            text: openDiagnosticsBtn.text
+            color: Theme.btnPrimaryText
+            font: openDiagnosticsBtn.font
+            horizontalAlignment: Text.AlignHCenter
+            verticalAlignment: Text.AlignVCenter
+        }
+
+        onClicked: openDiagnostics()
+    }
+
+    // Bottom-right button to open the replay window
+    Basic.Button {
+        id: openReplayBtn
+        text: "Replay"
+        anchors.bottom: parent.bottom
+        anchors.right: openRadioOutputBtn.left
+        anchors.margins: 8
+        z: 9999
+        hoverEnabled: true
+        padding: 10
+        font.family: Theme.fontFamily
+        font.pixelSize: Theme.fontBody
+
+        background: Rectangle {
+            radius: Theme.radiusControl
+            color: openReplayBtn.down    ? Theme.btnPrimaryPress
+                 : openReplayBtn.hovered ? Theme.btnPrimaryHover
+                 :                         Theme.btnPrimaryBg
+            border.width: Theme.strokeControl
+            border.color: Theme.btnPrimaryBorder
+            Behavior on color { ColorAnimation { duration: Theme.transitionFast } }
+        }
+        contentItem: Text {
+            text: openReplayBtn.text
+            color: Theme.btnPrimaryText
+            font: openReplayBtn.font
+            horizontalAlignment: Text.AlignHCenter
+            verticalAlignment: Text.AlignVCenter
+        }
+
+        onClicked: openReplay()
+    }
+
     // Bottom-right button to open the radio output window
     Basic.Button {
         id: openRadioOutputBtn
@@ -51,7 +51,7 @@ BasePanel {
                 color: Theme.btnSecondaryText
                 font: clearBtn.font
             }
-            onClicked: alertModel.clear()
+            onClicked: alarmreceiver.log.clear()
         }
     }
 
@@ -71,17 +71,25 @@ BasePanel {
         border.color: Theme.border
 
         // --------- Model & View (only classified messages) ----------
-        ListModel { id: alertModel }  // { ts: Date, level: "error|warning|success", text: string }
-
+        // C++ AlertLogModel: bounded ring, repeats collapsed, batched inserts.
+        // Roles: ts, lastTs (Date), level ("error|warning|success"), text, source, repeats
         ListView {
             id: list
             anchors.fill: parent
             anchors.margins: 10
             clip: true
             spacing: 10
-            model: alertModel
+            model: alarmreceiver.log
             boundsBehavior: Flickable.StopAtBounds
 
+            // Follow new alerts while the view is at the bottom.
+            property bool following: true
+            onMovementEnded: following = atYEnd
+            Connections {
+                target: alarmreceiver.log
+                function onRowsInserted() { if (list.following) Qt.callLater(list.positionViewAtEnd) }
+            }
+
             ScrollBar.vertical: Basic.ScrollBar {
                 id: control
                 policy: ScrollBar.AsNeeded
@@ -95,7 +103,6 @@ BasePanel {
                 background: Rectangle { color: "transparent" }
             }
 
-            function trim() { const max = 400; if (alertModel.count > max) alertModel.remove(0, alertModel.count - max); }
             Component.onCompleted: positionViewAtEnd()
 
             // ===== Delegate (uses exact red/yellow you specified) =====
@@ -123,7 +130,7 @@ BasePanel {
 
                 property int padX: 12
                 property int padY: 9
-                height: Math.max(56, body.implicitHeight + padY*2)
+                height: Math.max(56, body.implicitHeight + padY*2, meta.implicitHeight + padY*2)
 
                 // left stripe (exact color)
                 Rectangle {
@@ -150,6 +157,7 @@ BasePanel {
 
                     // timestamp + chip stacked
                     Column {
+                        id: meta
                         Layout.alignment: Qt.AlignTop
                         Layout.preferredWidth: 78
                         spacing: 6
@@ -162,6 +170,16 @@ BasePanel {
                             horizontalAlignment: Text.AlignLeft
                         }
 
+                        // collapsed repeats: count + last seen
+                        Text {
+                            visible: repeats > 1
+                            text: "×" + repeats + " " + Qt.formatTime(lastTs, "hh:mm:ss")
+                            color: card.timeText
+                            font.family: Theme.monoFamily
+                            font.pixelSize: 11
+                            horizontalAlignment: Text.AlignLeft
+                        }
+
                         Rectangle {
                             id: chip
                             radius: 9
@@ -203,19 +221,4 @@ BasePanel {
             }
         }
     }
-
-    // ===== Helper to append & autoscroll =====
-    function appendLine(level, line) {
-        alertModel.append({ ts: new Date(), level: level, text: line })
-        list.trim()
-        list.positionViewAtEnd()
-    }
-
-    // ===== Listen to classified signals =====
-    Connections {
-        target: alarmreceiver
-        function onRxError(line)   { appendLine("error",   line) }
-        function onRxWarning(line) { appendLine("warning", line) }
-        function onRxSuccess(line) { appendLine("success", line) }
-    }
 }
@@ -36,36 +36,73 @@ ApplicationWindow {
         anchors.margins: Theme.paddingMd
         spacing: Theme.paddingSm
 
-        Flickable {
+        // Filter / retention / follow controls for the packet log model
+        RowLayout {
+            Layout.fillWidth: true
+            spacing: Theme.paddingSm
+
+            ComboBox {
+                id: filterSel
+                model: ["All packets", "Telemetry", "Status", "Decode errors"]
+                currentIndex: sensorData.packetLog.filter
+                onActivated: sensorData.packetLog.filter = currentIndex
+            }
+
+            Label { text: "Keep" }
+            SpinBox {
+                id: retentionSel
+                from: 100
+                to: 100000
+                stepSize: 1000
+                editable: true
+                value: sensorData.packetLog.retention
+                onValueModified: sensorData.packetLog.retention = value
+            }
+
+            CheckBox {
+                text: "Auto-scroll"
+                checked: sensorData.packetLog.following
+                onToggled: sensorData.packetLog.following = checked
+            }
+
+            Item { Layout.fillWidth: true }
+
+            Label {
+                text: sensorData.packetLog.count + " shown / " + sensorData.packetLog.totalReceived + " received"
+                color: Theme.textSecondary
+            }
+        }
+
+        // Only visible rows are instantiated (and formatted) by the model.
+        ListView {
+            id: outputList
             Layout.fillWidth: true
             Layout.fillHeight: true
-            contentWidth: width
-            contentHeight: outputText.paintedHeight
             clip: true
+            model: sensorData.packetLog
+            boundsBehavior: Flickable.StopAtBounds
+            reuseItems: true
 
             ScrollBar.vertical: ScrollBar { policy: ScrollBar.AsNeeded }
 
-            TextEdit {
-                id: outputText
-                width: parent.width
-                readOnly: true
-                selectByMouse: true
-                wrapMode: TextEdit.WrapAnywhere
+            delegate: Text {
+                width: ListView.view.width
+                wrapMode: Text.WrapAnywhere
                 font.family: Theme.monoFamily
                 font.pixelSize: Theme.fontBody
-                color: Theme.textPrimary
-                text: sensorData.rawPacketLog
-
-                onTextChanged: {
-                    parent.contentY = Math.max(0, parent.contentHeight - parent.height)
-                }
+                color: kind === "ERROR" ? Theme.danger : Theme.textPrimary
+                text: display
             }
+
+            // Scrolling away from the bottom pauses auto-scroll; returning resumes it.
+            onMovementEnded: sensorData.packetLog.following = atYEnd
+            onCountChanged: if (sensorData.packetLog.following) positionViewAtEnd()
         }
 
         Button {
             text: "Clear"
             Layout.alignment: Qt.AlignRight
-            onClicked: sensorData.clearRawPacketLog()
+            onClicked: sensorData.packetLog.clear()
         }
     }
 }
@@ -178,9 +178,9 @@ ApplicationWindow {
                         p2Connected = false
                         singleConnected = false
 
-                        // Stop periodic timers if present (dual-mode senders)
-                        if (typeof timerP1 !== "undefined") timerP1.stop()
-                        if (typeof timerP2 !== "undefined") timerP2.stop()
+                        // Stop periodic senders (dual-mode)
+                        commandsender.stopPeriodic(1)
+                        commandsender.stopPeriodic(2)
 
                         // Set new mode and default mapping
                         singleMode = (currentIndex === 0)
@@ -476,7 +476,7 @@ ApplicationWindow {
                                     if (p1Connected) {
                                         bridge.disconnectPort(1)
                                         p1Connected = false
-                                        timerP1.stop()
+                                        commandsender.stopPeriodic(1)
                                     } else {
                                         if (portSel1.currentIndex >= 0) {
                                             if (bridge.connectPort(1,
@@ -532,10 +532,18 @@ ApplicationWindow {
                                 RowLayout {
                                     spacing: 10
 
+                                    // Text line, or a pre-encoded binary FlightCommand (index = command type)
+                                    ComboBox {
+                                        id: periodicKind1
+                                        model: ["Text", "ARM", "LAUNCH", "ABORT", "LAND"]
+                                        Layout.preferredWidth: 110
+                                    }
+
                                     TextField {
                                         id: periodicMsg1
                                         placeholderText: "Periodic message (P1)…"
                                         Layout.preferredWidth: 230
+                                        enabled: periodicKind1.currentIndex === 0
                                     }
 
                                     // Frequency selection (Hz) for periodic sends
@@ -543,7 +551,7 @@ ApplicationWindow {
                                         spacing: 6
                                         SpinBox {
                                             id: hz1
-                                            from: 1; to: 200; value: 50
+                                            from: 1; to: 1000; value: 50
                                             editable: true
                                         }
                                         Label { text: "Hz"; Layout.alignment: Qt.AlignVCenter }
@@ -555,27 +563,27 @@ ApplicationWindow {
                                         text: "Start"
                                         enabled: p1Connected
                                         onClicked: {
-                                            timerP1.interval = Math.max(1, Math.floor(1000 / hz1.value))
-                                            timerP1.start()
+                                            if (periodicKind1.currentIndex > 0)
+                                                commandsender.startPeriodicCommand(1, periodicKind1.currentIndex, hz1.value)
+                                            else if (periodicMsg1.text.length)
+                                                commandsender.startPeriodic(1, periodicMsg1.text, hz1.value)
                                         }
                                     }
                                     Button {
                                         text: "Stop"
-                                        onClicked: timerP1.stop()
+                                        onClicked: commandsender.stopPeriodic(1)
                                     }
                                 }
 
-                                // Timer to drive P1 periodic sending
-                                Timer {
-                                    id: timerP1
-                                    repeat: true
-                                    running: false
-                                    interval: 20
-                                    onTriggered: {
-                                        if (p1Connected && periodicMsg1.text.length) {
-                                            bridge.sendText(1, periodicMsg1.text)
-                                        }
-                                    }
+                                // Achieved rate and timing of the P1 stream (scheduler thread, refreshed once a second)
+                                Label {
+                                    readonly property var st: scheduler.streams.find(r => r.id === commandsender.periodicStream(1))
+                                    visible: st !== undefined
+                                    color: Theme.textSecondary
+                                    text: st ? (st.running ? "Sending " : "Stopped ") + st.sent + " · " + st.achievedHz.toFixed(2)
+                                              + " Hz achieved · lateness p50 " + st.latenessP50Us.toFixed(0) + " µs, p99 "
+                                              + st.latenessP99Us.toFixed(0) + " µs" + (st.missed > 0 ? " · " + st.missed + " missed" : "")
+                                             : ""
                                 }
                             }
                         }
@@ -681,7 +689,7 @@ ApplicationWindow {
                                     if (p2Connected) {
                                         bridge.disconnectPort(2)
                                         p2Connected = false
-                                        timerP2.stop()
+                                        commandsender.stopPeriodic(2)
                                     } else {
                                         if (portSel2.currentIndex >= 0) {
                                             if (bridge.connectPort(2,
@@ -737,10 +745,18 @@ ApplicationWindow {
                                 RowLayout {
                                     spacing: 10
 
+                                    // Text line, or a pre-encoded binary FlightCommand (index = command type)
+                                    ComboBox {
+                                        id: periodicKind2
+                                        model: ["Text", "ARM", "LAUNCH", "ABORT", "LAND"]
+                                        Layout.preferredWidth: 110
+                                    }
+
                                     TextField {
                                         id: periodicMsg2
                                         placeholderText: "Periodic message (P2)…"
                                         Layout.preferredWidth: 230
+                                        enabled: periodicKind2.currentIndex === 0
                                     }
 
                                     // Frequency selection (Hz) for P2 periodic send
@@ -748,7 +764,7 @@ ApplicationWindow {
                                         spacing: 6
                                         SpinBox {
                                             id: hz2
-                                            from: 1; to: 200; value: 50
+                                            from: 1; to: 1000; value: 50
                                             editable: true
                                         }
                                         Label { text: "Hz"; Layout.alignment: Qt.AlignVCenter }
@@ -760,27 +776,27 @@ ApplicationWindow {
                                         text: "Start"
                                         enabled: p2Connected
                                         onClicked: {
-                                            timerP2.interval = Math.max(1, Math.floor(1000 / hz2.value))
-                                            timerP2.start()
+                                            if (periodicKind2.currentIndex > 0)
+                                                commandsender.startPeriodicCommand(2, periodicKind2.currentIndex, hz2.value)
+                                            else if (periodicMsg2.text.length)
+                                                commandsender.startPeriodic(2, periodicMsg2.text, hz2.value)
                                         }
                                     }
                                     Button {
                                         text: "Stop"
-                                        onClicked: timerP2.stop()
+                                        onClicked: commandsender.stopPeriodic(2)
                                     }
                                 }
 
-                                // Timer to drive P2 periodic sending
-                                Timer {
-                                    id: timerP2
-                                    repeat: true
-                                    running: false
-                                    interval: 20
-                                    onTriggered: {
-                                        if (p2Connected && periodicMsg2.text.length) {
-                                            bridge.sendText(2, periodicMsg2.text)
-                                        }
-                                    }
+                                // Achieved rate and timing of the P2 stream (scheduler thread, refreshed once a second)
+                                Label {
+                                    readonly property var st: scheduler.streams.find(r => r.id === commandsender.periodicStream(2))
+                                    visible: st !== undefined
+                                    color: Theme.textSecondary
+                                    text: st ? (st.running ? "Sending " : "Stopped ") + st.sent + " · " + st.achievedHz.toFixed(2)
+                                              + " Hz achieved · lateness p50 " + st.latenessP50Us.toFixed(0) + " µs, p99 "
+                                              + st.latenessP99Us.toFixed(0) + " µs" + (st.missed > 0 ? " · " + st.missed + " missed" : "")
+                                             : ""
                                 }
                             }
                         }
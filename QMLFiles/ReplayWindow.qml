@@ -0,0 +1,165 @@
+import QtQuick 2.15
+import QtQuick.Controls 2.15
+import QtQuick.Layouts 1.15
+import QtQuick.Window 2.15
+import "Items"
+
+ApplicationWindow {
+    id: replayWin
+    width: 760
+    height: 260
+    visible: false
+    title: "Flight Replay"
+    modality: Qt.NonModal
+    flags: Qt.Window
+
+    font.family: Theme.fontFamily
+
+    palette {
+        window:          Theme.background
+        base:            Theme.surfaceInset
+        alternateBase:   Theme.surfaceElevated
+        text:            Theme.textPrimary
+        windowText:      Theme.textPrimary
+        button:          Theme.btnSecondaryBg
+        buttonText:      Theme.btnSecondaryText
+        highlight:       Theme.accent
+        highlightedText: Theme.background
+        placeholderText: Theme.textTertiary
+        mid:             Theme.border
+        dark:            Theme.border
+        light:           Theme.borderLight
+    }
+
+    // Same labels as Header.qml
+    readonly property var stateNames: ["IDLE", "ESTOP", "RISE", "HOVER", "LOWER"]
+
+    function formatMs(ms) {
+        const s = Math.floor(ms / 1000)
+        const m = Math.floor(s / 60)
+        return m + ":" + String(s % 60).padStart(2, "0") + "." + String(Math.floor(ms % 1000)).padStart(3, "0")
+    }
+
+    ColumnLayout {
+        anchors.fill: parent
+        anchors.margins: Theme.paddingMd
+        spacing: Theme.paddingSm
+
+        // Recording selection
+        RowLayout {
+            Layout.fillWidth: true
+            spacing: Theme.paddingSm
+
+            TextField {
+                id: pathField
+                Layout.fillWidth: true
+                placeholderText: "/path/to/flight-yyyyMMdd-HHmmss.ulog"
+                text: recorder.filePath
+                selectByMouse: true
+            }
+
+            Button {
+                text: replay.loaded ? "Reload" : "Open"
+                onClicked: replay.open(pathField.text)
+            }
+
+            Button {
+                text: "Close"
+                enabled: replay.loaded
+                onClicked: replay.close()
+            }
+        }
+
+        // Scrub bar; flight-state transitions are drawn as ticks above it
+        Item {
+            Layout.fillWidth: true
+            Layout.preferredHeight: 40
+            enabled: replay.loaded
+
+            Repeater {
+                id: marks
+                model: replay.loaded ? replay.flightStateMarks() : []
+                delegate: Rectangle {
+                    x: replay.durationMs > 0 ? (modelData.positionMs / replay.durationMs) * (scrub.availableWidth) + scrub.leftPadding : 0
+                    y: 0
+                    width: 2
+                    height: 10
+                    color: Theme.accent
+                }
+            }
+
+            Slider {
+                id: scrub
+                anchors.left: parent.left
+                anchors.right: parent.right
+                anchors.bottom: parent.bottom
+                from: 0
+                to: Math.max(1, replay.durationMs)
+                value: replay.positionMs
+                onMoved: replay.seek(value)
+            }
+        }
+
+        // Transport controls
+        RowLayout {
+            Layout.fillWidth: true
+            spacing: Theme.paddingSm
+            enabled: replay.loaded
+
+            Button { text: "◀◀"; onClicked: replay.step(-10) }
+            Button { text: "◀";  onClicked: replay.step(-1) }
+            Button {
+                text: replay.playing ? "Pause" : "Play"
+                onClicked: replay.playing ? replay.pause() : replay.play()
+            }
+            Button { text: "▶";  onClicked: replay.step(1) }
+            Button { text: "▶▶"; onClicked: replay.step(10) }
+
+            Label { text: "Speed" }
+            ComboBox {
+                id: speedSel
+                readonly property var speeds: [0.1, 0.25, 0.5, 1, 2, 5, 10, 25, 50, 100, 0]
+                model: ["0.1×", "0.25×", "0.5×", "1×", "2×", "5×", "10×", "25×", "50×", "100×", "Max"]
+                currentIndex: 3
+                onActivated: {
+                    const s = speeds[currentIndex]
+                    replay.fastAsPossible = (s === 0)
+                    if (s > 0)
+                        replay.speed = s
+                }
+            }
+
+            Item { Layout.fillWidth: true }
+
+            Label {
+                text: formatMs(replay.positionMs) + " / " + formatMs(replay.durationMs)
+                      + "   frame " + replay.frameIndex + " / " + replay.frameCount
+                color: Theme.textSecondary
+            }
+        }
+
+        // Jump to flight-state transitions
+        RowLayout {
+            Layout.fillWidth: true
+            spacing: Theme.paddingSm
+            enabled: replay.loaded
+
+            Label { text: "Jump to" }
+            Repeater {
+                model: stateNames
+                delegate: Button {
+                    text: modelData
+                    onClicked: replay.seekToFlightState(index)
+                }
+            }
+
+            Item { Layout.fillWidth: true }
+
+            Label {
+                text: "State: " + (replay.flightState >= 0 && replay.flightState < stateNames.length
+                                   ? stateNames[replay.flightState] : "—")
+                color: Theme.textSecondary
+            }
+        }
+    }
+}
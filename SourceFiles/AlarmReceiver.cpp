@@ -5,39 +5,44 @@ AlarmReceiver::AlarmReceiver(SerialBridge* bridge, QObject* parent)
     : QObject(parent)
     , m_bridge(bridge)
 {
+    m_ruleStats = m_rules.stats();
+    m_statsTimer.setInterval(1000);
+    connect(&m_statsTimer, &QTimer::timeout, this, &AlarmReceiver::publishStats);
+    m_statsTimer.start();
+
     if (!m_bridge)
         return; // Nothing to hook into if bridge is null.
 
-    // Single connection: classify only the "active" RX source based on connection state.
+    // Every open link carries the same firmware text when several radios hear the
+    // vehicle; classify each line once, whichever link delivers it first.
     QObject::connect(
         m_bridge,
         &SerialBridge::textReceivedFrom,
         this,
         [this](int which, const QString &line) {
-            if (!m_bridge)
-                return; // Bridge was cleared or destroyed.
-
-            const bool p1 = m_bridge->isConnected(1);
-            const bool p2 = m_bridge->isConnected(2);
+            if (!m_bridge || !m_bridge->isConnected(which))
+                return; // Bridge was cleared, or the line raced a close.
+            if (isEchoOfOtherLink(which, line))
+                return;
+            onLineReceived(line);
+        }
+        );
+}
 
-            bool listen = false;
+bool AlarmReceiver::isEchoOfOtherLink(int which, const QString& line)
+{
+    if (!m_lineClock.isValid())
+        m_lineClock.start();
+    const qint64 nowMs = m_lineClock.elapsed();
+    const size_t hash = qHash(line);
 
-            if (p1 && p2) {
-                // Both ports connected → treat P1 as the canonical source for alarms.
-                listen = (which == 1);
-            } else if (p1 || p2) {
-                // Exactly one port connected → listen only to that one.
-                listen = m_bridge->isConnected(which);
-            } else {
-                // No ports connected → ignore everything.
-                listen = false;
-            }
+    for (const RecentLine& r : m_recentLines)
+        if (r.ms >= 0 && r.hash == hash && r.which != which && nowMs - r.ms <= kEchoWindowMs)
+            return true;
 
-            if (listen) {
-                onLineReceived(line); // Forward to classifier only if this port is the chosen source.
-            }
-        }
-        );
+    m_recentLines[m_recentNext] = { hash, which, nowMs };
+    m_recentNext = (m_recentNext + 1) % m_recentLines.size();
+    return false;
 }
 
 void AlarmReceiver::onLineReceived(const QString& line)
@@ -47,18 +52,56 @@ void AlarmReceiver::onLineReceived(const QString& line)
 
 void AlarmReceiver::classifyAndEmit(const QString& line)
 {
-    // Priority: error → warning → success. First match wins; rest are skipped.
-    if (m_reErr.match(line).hasMatch()) {
-        emit rxError(line);
+    // Priority: error → warning → success, decided by the automaton in a single pass.
+    const AlarmRules::Severity severity = m_rules.classify(QStringView(line));
+    if (severity == AlarmRules::None)
+        return; // No match → silent ignore.
+
+    m_hitsDirty = true;
+    postAlarm(severity, line, QStringLiteral("firmware"));
+}
+
+void AlarmReceiver::postAlarm(int severity, const QString& text, const QString& source)
+{
+    if (severity < AlarmRules::Error || severity > AlarmRules::Success)
         return;
+
+    m_log.append(severity, text, source);
+    switch (severity) {
+    case AlarmRules::Error:   emit rxError(text);   break;
+    case AlarmRules::Warning: emit rxWarning(text); break;
+    case AlarmRules::Success: emit rxSuccess(text); break;
+    default: break;
     }
-    if (m_reWarn.match(line).hasMatch()) {
-        emit rxWarning(line);
-        return;
+}
+
+bool AlarmReceiver::loadRules(const QString& path)
+{
+    QString error;
+    if (!m_rules.load(path, &error)) {
+        qWarning("Alarm rules not loaded: %s", qPrintable(error));
+        emit rulesError(error);
+        return false;
     }
-    if (m_reSucc.match(line).hasMatch()) {
-        emit rxSuccess(line);
+    m_rulesSource = path;
+    m_hitsDirty = true;
+    publishStats();
+    return true;
+}
+
+void AlarmReceiver::resetRules()
+{
+    m_rules = AlarmRules();
+    m_rulesSource.clear();
+    m_hitsDirty = true;
+    publishStats();
+}
+
+void AlarmReceiver::publishStats()
+{
+    if (!m_hitsDirty)
         return;
-    }
-    // No match → silent ignore.
+    m_hitsDirty = false;
+    m_ruleStats = m_rules.stats();
+    emit ruleStatsChanged();
 }
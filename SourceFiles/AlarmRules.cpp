@@ -0,0 +1,177 @@
+#include "AlarmRules.h"
+#include <QFile>
+#include <QRegularExpression>
+#include <QVariantMap>
+#include <deque>
+
+namespace {
+const char kDefaultRules[] =
+    "error    error failure failed fault\n"
+    "warning  warn warning caution\n"
+    "success  success succeeded ok passed\n";
+}
+
+AlarmRules::AlarmRules()
+{
+    parse(QString::fromLatin1(kDefaultRules));
+}
+
+QString AlarmRules::severityName(int severity)
+{
+    switch (severity) {
+    case Error:   return QStringLiteral("error");
+    case Warning: return QStringLiteral("warning");
+    case Success: return QStringLiteral("success");
+    default:      return QString();
+    }
+}
+
+bool AlarmRules::load(const QString& path, QString* error)
+{
+    QFile f(path);
+    if (!f.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        if (error)
+            *error = QStringLiteral("%1: %2").arg(path, f.errorString());
+        return false;
+    }
+    return parse(QString::fromUtf8(f.readAll()), error);
+}
+
+bool AlarmRules::parse(const QString& text, QString* error)
+{
+    auto fail = [error](int lineNo, const QString& why) {
+        if (error)
+            *error = QStringLiteral("line %1: %2").arg(lineNo).arg(why);
+        return false;
+    };
+
+    static const QRegularExpression kSpace(QStringLiteral("\\s+"));
+    std::vector<Keyword> keywords;
+    const QStringList lines = text.split('\n');
+    for (int i = 0; i < lines.size(); ++i) {
+        const QString line = lines[i].section('#', 0, 0).trimmed();
+        if (line.isEmpty())
+            continue;
+        const QStringList words = line.split(kSpace, Qt::SkipEmptyParts);
+
+        const QString sev = words.first().toLower();
+        int severity = None;
+        if (sev == QLatin1String("error"))        severity = Error;
+        else if (sev == QLatin1String("warning")) severity = Warning;
+        else if (sev == QLatin1String("success")) severity = Success;
+        else return fail(i + 1, QStringLiteral("unknown severity \"%1\"").arg(words.first()));
+        if (words.size() < 2)
+            return fail(i + 1, QStringLiteral("no keywords"));
+
+        for (int w = 1; w < words.size(); ++w) {
+            Keyword k;
+            k.severity = severity;
+            QString kw = words[w].toLower();
+            if (kw.endsWith('*')) {
+                k.prefix = true;
+                kw.chop(1);
+            }
+            for (QChar c : kw)
+                if (c.unicode() >= 128 || c.unicode() <= ' ')
+                    return fail(i + 1, QStringLiteral("keyword \"%1\" is not printable ASCII").arg(words[w]));
+            if (kw.isEmpty())
+                return fail(i + 1, QStringLiteral("empty keyword"));
+            k.text = kw.toLatin1();
+            keywords.push_back(k);
+        }
+    }
+
+    compile(std::move(keywords));
+    return true;
+}
+
+void AlarmRules::compile(std::vector<Keyword> keywords)
+{
+    // Compact alphabet: one column per character used by any keyword, column 0 for the rest.
+    m_classOf.fill(0);
+    m_classes = 1;
+    for (const Keyword& k : keywords)
+        for (char c : k.text)
+            if (!m_classOf[uchar(c)])
+                m_classOf[uchar(c)] = quint8(m_classes++);
+
+    // Trie (-1 = no edge yet).
+    std::vector<qint32> next(size_t(m_classes), -1);
+    std::vector<std::vector<qint32>> outs(1);
+    for (size_t k = 0; k < keywords.size(); ++k) {
+        qint32 s = 0;
+        for (char c : keywords[k].text) {
+            const size_t at = size_t(s) * size_t(m_classes) + m_classOf[uchar(c)];
+            if (next[at] < 0) {
+                next[at] = qint32(outs.size());
+                outs.emplace_back();
+                next.resize(next.size() + size_t(m_classes), -1);
+            }
+            s = next[at];
+        }
+        outs[size_t(s)].push_back(qint32(k));
+    }
+
+    // Breadth-first: fold failure links into the table so scanning never backtracks, and
+    // inherit the outputs of each state's failure state.
+    std::vector<qint32> fail(outs.size(), 0);
+    std::deque<qint32> queue;
+    for (int c = 0; c < m_classes; ++c) {
+        qint32& t = next[size_t(c)];
+        if (t < 0) {
+            t = 0;
+        } else {
+            fail[size_t(t)] = 0;
+            queue.push_back(t);
+        }
+    }
+    while (!queue.empty()) {
+        const qint32 s = queue.front();
+        queue.pop_front();
+        const auto& inherited = outs[size_t(fail[size_t(s)])];
+        outs[size_t(s)].insert(outs[size_t(s)].end(), inherited.begin(), inherited.end());
+        for (int c = 0; c < m_classes; ++c) {
+            qint32& t = next[size_t(s) * size_t(m_classes) + size_t(c)];
+            const qint32 viaFail = next[size_t(fail[size_t(s)]) * size_t(m_classes) + size_t(c)];
+            if (t < 0) {
+                t = viaFail;
+            } else {
+                fail[size_t(t)] = viaFail;
+                queue.push_back(t);
+            }
+        }
+    }
+
+    // Flatten the outputs.
+    m_outStart.assign(outs.size() + 1, 0);
+    m_out.clear();
+    for (size_t s = 0; s < outs.size(); ++s) {
+        m_outStart[s] = qint32(m_out.size());
+        m_out.insert(m_out.end(), outs[s].begin(), outs[s].end());
+    }
+    m_outStart[outs.size()] = qint32(m_out.size());
+
+    m_next = std::move(next);
+    m_keywords = std::move(keywords);
+}
+
+QVariantList AlarmRules::stats() const
+{
+    QVariantList out;
+    for (const Keyword& k : m_keywords) {
+        out.append(QVariantMap {
+            { QStringLiteral("keyword"),  QString::fromLatin1(k.text) },
+            { QStringLiteral("severity"), severityName(k.severity) },
+            { QStringLiteral("prefix"),   k.prefix },
+            { QStringLiteral("hits"),     k.hits },
+        });
+    }
+    return out;
+}
+
+void AlarmRules::resetHits()
+{
+    for (Keyword& k : m_keywords)
+        k.hits = 0;
+    m_lines = 0;
+}
@@ -0,0 +1,230 @@
+#include "AlertLogModel.h"
+#include "AlarmRules.h"
+#include "DownlinkRecord.h"
+
+#include <QDateTime>
+
+namespace {
+constexpr int kDefaultRetention = 400;
+constexpr int kMinRetention     = 50;
+constexpr int kMaxRetention     = 100000;
+constexpr int kFlushMs          = 50;
+}
+
+AlertLogModel::AlertLogModel(QObject* parent)
+    : QAbstractListModel(parent)
+    , m_ring(kDefaultRetention)
+{
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(kFlushMs);
+    connect(&m_flushTimer, &QTimer::timeout, this, &AlertLogModel::flush);
+}
+
+int AlertLogModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : count();
+}
+
+QVariant AlertLogModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() < 0 || index.row() >= count())
+        return {};
+
+    const Entry& e = entryAt(m_viewFirst + quint64(index.row()));
+    switch (role) {
+    case Qt::DisplayRole:
+    case TextRole:     return e.text;
+    case LevelRole:    return AlarmRules::severityName(e.level);
+    case SourceRole:   return e.source;
+    case TimeRole:     return QDateTime::fromMSecsSinceEpoch(e.firstMs);
+    case LastTimeRole: return QDateTime::fromMSecsSinceEpoch(e.lastMs);
+    case RepeatRole:   return e.repeats;
+    default:           return {};
+    }
+}
+
+QHash<int, QByteArray> AlertLogModel::roleNames() const {
+    return {
+        { TextRole,     "text" },
+        { LevelRole,    "level" },
+        { SourceRole,   "source" },
+        { TimeRole,     "ts" },
+        { LastTimeRole, "lastTs" },
+        { RepeatRole,   "repeats" },
+    };
+}
+
+void AlertLogModel::append(int level, const QString& text, const QString& source) {
+    ++m_received;
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    const QString key = source + QChar(0x1f) + QChar(u'0' + level) + text;
+
+    // Same alert still on screen → bump its row instead of adding one.
+    auto it = m_bySeq.constFind(key);
+    if (it != m_bySeq.constEnd() && *it >= m_firstSeq) {
+        Entry& e = entryAt(*it);
+        if (nowMs - e.lastMs <= m_dedupWindowMs) {
+            ++e.repeats;
+            e.lastMs = nowMs;
+            ++m_collapsed;
+            if (*it < m_viewEnd) {
+                m_changedLo = qMin(m_changedLo, *it);
+                m_changedHi = qMax(m_changedHi, *it);
+            }
+            scheduleFlush();
+            return;
+        }
+    }
+
+    const qint64 nowNs = monotonicNs();
+    Bucket& b = m_buckets[source];
+    if (!admit(b, nowNs)) {
+        ++b.suppressed;
+        b.level = b.suppressed == 1 ? level : qMin(b.level, level);
+        ++m_suppressed;
+        m_anySuppressed = true;
+        scheduleFlush();
+        return;
+    }
+
+    push(level, text, source, key, nowMs);
+    scheduleFlush();
+}
+
+bool AlertLogModel::admit(Bucket& b, qint64 nowNs) {
+    if (b.refillNs == 0) {
+        b.tokens = m_burst;
+    } else {
+        b.tokens = qMin(double(m_burst), b.tokens + double(nowNs - b.refillNs) * m_ratePerSecond / 1e9);
+    }
+    b.refillNs = nowNs;
+    if (b.tokens < 1.0)
+        return false;
+    b.tokens -= 1.0;
+    return true;
+}
+
+void AlertLogModel::push(int level, const QString& text, const QString& source,
+                         const QString& key, qint64 nowMs) {
+    // Overwrite the oldest slot once the ring is full.
+    Entry& slot = entryAt(m_nextSeq);
+    if (m_nextSeq - m_firstSeq == m_ring.size()) {
+        auto old = m_bySeq.find(slot.key);
+        if (old != m_bySeq.end() && *old == m_firstSeq)
+            m_bySeq.erase(old);
+        ++m_firstSeq;
+    }
+
+    slot.level   = level;
+    slot.text    = text;
+    slot.source  = source;
+    slot.key     = key;
+    slot.firstMs = slot.lastMs = nowMs;
+    slot.repeats = 1;
+    if (!key.isEmpty())
+        m_bySeq.insert(key, m_nextSeq);
+    ++m_nextSeq;
+}
+
+void AlertLogModel::reportSuppressed(qint64 nowNs) {
+    m_anySuppressed = false;
+    const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+    for (auto it = m_buckets.begin(); it != m_buckets.end(); ++it) {
+        Bucket& b = it.value();
+        if (!b.suppressed)
+            continue;
+        if (!admit(b, nowNs)) {
+            m_anySuppressed = true; // Still storming: report on a later flush.
+            continue;
+        }
+        const QString from = it.key().isEmpty() ? QString() : QStringLiteral(" from %1").arg(it.key());
+        push(b.level, QStringLiteral("%1 more alerts%2 suppressed (rate limit)").arg(b.suppressed).arg(from),
+             it.key(), QString(), nowMs);
+        b.suppressed = 0;
+    }
+}
+
+void AlertLogModel::scheduleFlush() {
+    if (!m_flushTimer.isActive())
+        m_flushTimer.start();
+}
+
+void AlertLogModel::flush() {
+    if (m_anySuppressed)
+        reportSuppressed(monotonicNs());
+
+    // Rows whose alert was overwritten leave from the top.
+    const quint64 evicted = qMin(m_firstSeq, m_viewEnd) > m_viewFirst ? qMin(m_firstSeq, m_viewEnd) - m_viewFirst : 0;
+    if (evicted) {
+        beginRemoveRows(QModelIndex(), 0, int(evicted) - 1);
+        m_viewFirst += evicted;
+        endRemoveRows();
+    }
+    if (m_viewFirst < m_firstSeq)        // A burst longer than the ring also overwrote
+        m_viewFirst = m_viewEnd = m_firstSeq; // everything published (all removed above).
+
+    // Repeat counts of rows still published.
+    if (m_changedLo <= m_changedHi) {
+        const quint64 lo = qMax(m_changedLo, m_viewFirst);
+        if (lo <= m_changedHi && m_changedHi < m_viewEnd)
+            emit dataChanged(index(int(lo - m_viewFirst)), index(int(m_changedHi - m_viewFirst)),
+                             { RepeatRole, LastTimeRole });
+        m_changedLo = ~quint64(0);
+        m_changedHi = 0;
+    }
+
+    const quint64 inserted = m_nextSeq - m_viewEnd;
+    if (inserted) {
+        const int first = count();
+        beginInsertRows(QModelIndex(), first, first + int(inserted) - 1);
+        m_viewEnd = m_nextSeq;
+        endInsertRows();
+    }
+
+    if (evicted || inserted)
+        emit countChanged();
+    emit statsChanged();
+
+    if (m_anySuppressed)
+        scheduleFlush();
+}
+
+void AlertLogModel::clear() {
+    m_flushTimer.stop();
+    beginResetModel();
+    m_firstSeq = m_viewFirst = m_viewEnd = m_nextSeq;
+    m_changedLo = ~quint64(0);
+    m_changedHi = 0;
+    m_bySeq.clear();
+    endResetModel();
+    emit countChanged();
+}
+
+void AlertLogModel::setRateLimit(double perSecond, int burst) {
+    m_ratePerSecond = qMax(0.0, perSecond);
+    m_burst = qMax(1, burst);
+}
+
+void AlertLogModel::setRetention(int alerts) {
+    alerts = qBound(kMinRetention, alerts, kMaxRetention);
+    if (size_t(alerts) == m_ring.size())
+        return;
+
+    // Keep the newest alerts that still fit, re-slotted for the new ring size.
+    const quint64 keep = qMin<quint64>(m_nextSeq - m_firstSeq, quint64(alerts));
+    std::vector<Entry> ring(size_t(alerts));
+    for (quint64 seq = m_nextSeq - keep; seq < m_nextSeq; ++seq)
+        ring[seq % ring.size()] = entryAt(seq);
+
+    m_flushTimer.stop();
+    beginResetModel();
+    m_ring.swap(ring);
+    m_firstSeq = m_viewFirst = m_nextSeq - keep;
+    m_viewEnd = m_nextSeq;
+    m_changedLo = ~quint64(0);
+    m_changedHi = 0;
+    for (auto it = m_bySeq.begin(); it != m_bySeq.end();)
+        it = *it < m_firstSeq ? m_bySeq.erase(it) : std::next(it);
+    endResetModel();
+
+    emit retentionChanged();
+    emit countChanged();
+}
@@ -0,0 +1,189 @@
+#include "AllocCounter.h"
+
+#ifdef ULYSSES_ALLOC_CHECK
+
+#include <QtLogging>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+thread_local quint64 t_allocs = 0;   ///< Allocations by this thread.
+thread_local quint64 t_exempt = 0;   ///< Of those, made inside an AllocExemptScope.
+std::atomic<quint64> g_allocs{0};
+
+inline void countAlloc() {
+    ++t_allocs;
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+}
+
+} // namespace
+
+#if defined(__GLIBC__)
+
+// -----------------------
+// C allocator interposition (glibc)
+// -----------------------
+// Qt's QString/QByteArray/QList storage comes from ::malloc/::realloc inside libQt6Core, and
+// libstdc++'s operator new ends up there too. Definitions in the executable take precedence
+// over libc's for every shared library (ld --wrap would only reach our own objects), and
+// glibc exports its implementation as __libc_* to forward to.
+
+extern "C" {
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t n, std::size_t size);
+void* __libc_realloc(void* p, std::size_t size);
+void* __libc_memalign(std::size_t align, std::size_t size);
+void  __libc_free(void* p);
+
+void* malloc(std::size_t size) {
+    countAlloc();
+    return __libc_malloc(size);
+}
+
+void* calloc(std::size_t n, std::size_t size) {
+    countAlloc();
+    return __libc_calloc(n, size);
+}
+
+void* realloc(void* p, std::size_t size) {
+    countAlloc(); // Growing or shrinking: either way not something a hot path should do.
+    return __libc_realloc(p, size);
+}
+
+void* memalign(std::size_t align, std::size_t size) {
+    countAlloc();
+    return __libc_memalign(align, size);
+}
+
+void* aligned_alloc(std::size_t align, std::size_t size) {
+    countAlloc();
+    return __libc_memalign(align, size);
+}
+
+int posix_memalign(void** out, std::size_t align, std::size_t size) {
+    if (align < sizeof(void*) || (align & (align - 1)) != 0)
+        return EINVAL;
+    countAlloc();
+    void* p = __libc_memalign(align, size);
+    if (!p)
+        return ENOMEM;
+    *out = p;
+    return 0;
+}
+
+void free(void* p) {
+    __libc_free(p);
+}
+} // extern "C"
+
+#else
+
+// -----------------------
+// Global operator new/delete replacements
+// -----------------------
+// Without glibc only C++ allocations are seen; Qt container storage (::malloc) is not.
+
+namespace {
+
+void* countedAlloc(std::size_t size) {
+    countAlloc();
+    return std::malloc(size ? size : 1);
+}
+
+void* countedAlignedAlloc(std::size_t size, std::align_val_t align) {
+    countAlloc();
+    const std::size_t a = std::size_t(align);
+#ifdef _WIN32
+    return _aligned_malloc(size ? size : 1, a);
+#else
+    return std::aligned_alloc(a, ((size ? size : 1) + a - 1) / a * a); // Size must be a multiple.
+#endif
+}
+
+void alignedFree(void* p) noexcept {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+} // namespace
+
+void* operator new(std::size_t size) {
+    if (void* p = countedAlloc(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    if (void* p = countedAlloc(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+
+void* operator new(std::size_t size, std::align_val_t align) {
+    if (void* p = countedAlignedAlloc(size, align))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size, std::align_val_t align) {
+    if (void* p = countedAlignedAlloc(size, align))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { alignedFree(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { alignedFree(p); }
+
+#endif // __GLIBC__
+
+// -----------------------
+// Scopes
+// -----------------------
+
+NoAllocScope::NoAllocScope(Site& site)
+    : m_site(site), m_start(t_allocs - t_exempt)
+{
+}
+
+NoAllocScope::~NoAllocScope() {
+    const quint64 allocs = (t_allocs - t_exempt) - m_start;
+    if (++m_site.runs > kWarmup && allocs != 0)
+        qFatal("ULYSSES_ALLOC_CHECK: %llu heap allocation(s) in '%s' (run %llu, past warm-up)",
+               static_cast<unsigned long long>(allocs), m_site.name,
+               static_cast<unsigned long long>(m_site.runs));
+}
+
+AllocExemptScope::AllocExemptScope() : m_start(t_allocs) {}
+
+AllocExemptScope::~AllocExemptScope() {
+    t_exempt += t_allocs - m_start;
+}
+
+bool AllocCounter::enabled() { return true; }
+quint64 AllocCounter::threadCount() { return t_allocs; }
+quint64 AllocCounter::totalCount() { return g_allocs.load(std::memory_order_relaxed); }
+
+#else
+
+bool AllocCounter::enabled() { return false; }
+quint64 AllocCounter::threadCount() { return 0; }
+quint64 AllocCounter::totalCount() { return 0; }
+
+#endif // ULYSSES_ALLOC_CHECK
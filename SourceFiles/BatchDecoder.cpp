@@ -0,0 +1,359 @@
+#include "BatchDecoder.h"
+#include "DownlinkRecord.h"
+#include "RecordingFormat.h"
+#include <QFile>
+#include <QThread>
+#include <cmath>
+#include <limits>
+#include <memory>
+extern "C" {
+    #include "rp/codec.h"
+    #include "downlink.pb.h"
+}
+
+namespace {
+constexpr char    kColumnarMagic[8] = { 'U', 'L', 'Y', 'C', 'O', 'L', '1', '\0' };
+constexpr quint32 kColumnarVersion  = 1;
+constexpr float   kMissing          = std::numeric_limits<float>::quiet_NaN();
+
+// Column order of the telemetry table (see declareSchema()).
+enum TelemetryColumn {
+    T_RxMs = 0, T_Port, T_TimestampMs, T_FlightState,
+    T_ThrustCmd, T_GimbalX, T_GimbalY,
+    T_PosX, T_PosY, T_PosZ,
+    T_VelX, T_VelY, T_VelZ,
+    T_QuatW, T_QuatX, T_QuatY, T_QuatZ,
+    T_RollDeg, T_PitchDeg, T_YawDeg,
+    T_RateXDps, T_RateYDps, T_RateZDps,
+};
+
+// Column order of the status table.
+enum StatusColumn {
+    S_RxMs = 0, S_Port, S_TimestampMs, S_UptimeMs, S_FlightState,
+    S_AccelOk, S_GyroOk, S_Baro1Ok, S_Baro2Ok, S_GpsConnected,
+    S_RadioRxCount, S_RadioTxCount, S_CmdRxCount,
+};
+} // namespace
+
+// -----------------------
+// ColumnTable
+// -----------------------
+
+size_t ColumnTable::typeSize(Type t) {
+    switch (t) {
+    case F64: return 8;
+    case F32:
+    case U32:
+    case I32: return 4;
+    case U8:  return 1;
+    }
+    return 0;
+}
+
+void ColumnTable::append(const ColumnTable& other) {
+    for (size_t c = 0; c < m_columns.size(); ++c)
+        m_columns[c].data.insert(m_columns[c].data.end(),
+                                 other.m_columns[c].data.begin(), other.m_columns[c].data.end());
+    m_rows += other.m_rows;
+}
+
+bool ColumnTable::writeCsv(const QString& path) const {
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    QByteArray line;
+    for (size_t c = 0; c < m_columns.size(); ++c) {
+        if (c) line += ',';
+        line += m_columns[c].name;
+    }
+    line += '\n';
+    f.write(line);
+
+    // Missing floating-point values are written as empty fields.
+    QByteArray out;
+    out.reserve(1 << 20);
+    for (quint64 r = 0; r < m_rows; ++r) {
+        for (size_t c = 0; c < m_columns.size(); ++c) {
+            if (c) out += ',';
+            const Column& col = m_columns[c];
+            const uint8_t* p = col.data.data() + r * typeSize(col.type);
+            switch (col.type) {
+            case F64: { double v; std::memcpy(&v, p, 8); if (!std::isnan(v)) out += QByteArray::number(v, 'f', 3); break; }
+            case F32: { float v;  std::memcpy(&v, p, 4); if (!std::isnan(v)) out += QByteArray::number(double(v), 'g', 7); break; }
+            case U32: { quint32 v; std::memcpy(&v, p, 4); out += QByteArray::number(v); break; }
+            case I32: { qint32 v;  std::memcpy(&v, p, 4); out += QByteArray::number(v); break; }
+            case U8:  out += QByteArray::number(*p); break;
+            }
+        }
+        out += '\n';
+        if (out.size() > (1 << 20) - 4096) {
+            f.write(out);
+            out.clear();
+        }
+    }
+    f.write(out);
+    return f.error() == QFileDevice::NoError;
+}
+
+bool ColumnTable::writeColumnar(const QString& path) const {
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    struct DirEntry {
+        char    name[32];
+        quint32 type;
+        quint32 reserved;
+        quint64 offset;
+    };
+    static_assert(sizeof(DirEntry) == 48, "DirEntry layout");
+
+    const quint32 columnCount = quint32(m_columns.size());
+    f.write(kColumnarMagic, sizeof(kColumnarMagic));
+    f.write(reinterpret_cast<const char*>(&kColumnarVersion), 4);
+    f.write(reinterpret_cast<const char*>(&columnCount), 4);
+    f.write(reinterpret_cast<const char*>(&m_rows), 8);
+
+    quint64 offset = 24 + quint64(columnCount) * sizeof(DirEntry);
+    for (const Column& col : m_columns) {
+        DirEntry e {};
+        std::memcpy(e.name, col.name.constData(), size_t(qMin<qsizetype>(col.name.size(), 31)));
+        e.type   = col.type;
+        e.offset = offset;
+        f.write(reinterpret_cast<const char*>(&e), sizeof(e));
+        offset += col.data.size();
+    }
+    for (const Column& col : m_columns)
+        f.write(reinterpret_cast<const char*>(col.data.data()), qint64(col.data.size()));
+
+    return f.error() == QFileDevice::NoError;
+}
+
+// -----------------------
+// BatchDecoder
+// -----------------------
+
+void BatchDecoder::declareSchema(Shard& shard) {
+    ColumnTable& t = shard.telemetry;
+    t.addColumn("rx_ms", ColumnTable::F64);
+    t.addColumn("port", ColumnTable::U8);
+    t.addColumn("timestamp_ms", ColumnTable::U32);
+    t.addColumn("flight_state", ColumnTable::I32);
+    for (const char* name : { "thrust_cmd", "gimbal_x", "gimbal_y",
+                              "pos_x", "pos_y", "pos_z",
+                              "vel_x", "vel_y", "vel_z",
+                              "q_w", "q_x", "q_y", "q_z",
+                              "roll_deg", "pitch_deg", "yaw_deg",
+                              "rate_x_dps", "rate_y_dps", "rate_z_dps" })
+        t.addColumn(name, ColumnTable::F32);
+
+    ColumnTable& s = shard.status;
+    s.addColumn("rx_ms", ColumnTable::F64);
+    s.addColumn("port", ColumnTable::U8);
+    s.addColumn("timestamp_ms", ColumnTable::U32);
+    s.addColumn("uptime_ms", ColumnTable::U32);
+    s.addColumn("flight_state", ColumnTable::I32);
+    for (const char* name : { "accel_ok", "gyro_ok", "baro1_ok", "baro2_ok", "gps_connected" })
+        s.addColumn(name, ColumnTable::U8);
+    for (const char* name : { "radio_rx_count", "radio_tx_count", "cmd_rx_count" })
+        s.addColumn(name, ColumnTable::U32);
+}
+
+void BatchDecoder::decodeFrame(const uchar* frame, size_t size, int port, double rxMs, Shard& out) {
+    ++out.stats.frames;
+
+    tvr_Downlink msg = tvr_Downlink_init_default;
+    if (rp_packet_decode(frame, size, &tvr_Downlink_msg, &msg).status != RP_CODEC_OK) {
+        ++out.stats.decodeErrors;
+        return;
+    }
+
+    if (msg.which_payload == tvr_Downlink_telemetry_tag) {
+        const tvr_TelemetryState& m = msg.payload.telemetry;
+        ColumnTable& t = out.telemetry;
+        t.push(T_RxMs, rxMs);
+        t.push(T_Port, quint8(port));
+        t.push(T_TimestampMs, quint32(m.timestamp_ms));
+        t.push(T_FlightState, qint32(m.flight_state));
+        t.push(T_ThrustCmd, float(m.thrust_cmd));
+        t.push(T_GimbalX, float(m.gimbal_x));
+        t.push(T_GimbalY, float(m.gimbal_y));
+
+        t.push(T_PosX, m.has_position ? float(m.position.x) : kMissing);
+        t.push(T_PosY, m.has_position ? float(m.position.y) : kMissing);
+        t.push(T_PosZ, m.has_position ? float(m.position.z) : kMissing);
+        t.push(T_VelX, m.has_velocity ? float(m.velocity.x) : kMissing);
+        t.push(T_VelY, m.has_velocity ? float(m.velocity.y) : kMissing);
+        t.push(T_VelZ, m.has_velocity ? float(m.velocity.z) : kMissing);
+
+        // Same quaternion → Euler conversion the live panels use.
+        float roll = kMissing, pitch = kMissing, yaw = kMissing;
+        if (m.has_attitude) {
+            quatToEulerRad(m.attitude.w, m.attitude.x, m.attitude.y, m.attitude.z, &roll, &pitch, &yaw);
+            roll = radToDeg(roll);
+            pitch = radToDeg(pitch);
+            yaw = radToDeg(yaw);
+        }
+        t.push(T_QuatW, m.has_attitude ? float(m.attitude.w) : kMissing);
+        t.push(T_QuatX, m.has_attitude ? float(m.attitude.x) : kMissing);
+        t.push(T_QuatY, m.has_attitude ? float(m.attitude.y) : kMissing);
+        t.push(T_QuatZ, m.has_attitude ? float(m.attitude.z) : kMissing);
+        t.push(T_RollDeg, roll);
+        t.push(T_PitchDeg, pitch);
+        t.push(T_YawDeg, yaw);
+
+        t.push(T_RateXDps, m.has_angular_rate ? radToDeg(m.angular_rate.x) : kMissing);
+        t.push(T_RateYDps, m.has_angular_rate ? radToDeg(m.angular_rate.y) : kMissing);
+        t.push(T_RateZDps, m.has_angular_rate ? radToDeg(m.angular_rate.z) : kMissing);
+        t.endRow();
+        ++out.stats.telemetry;
+
+    } else if (msg.which_payload == tvr_Downlink_status_tag) {
+        const tvr_SystemStatus& m = msg.payload.status;
+        ColumnTable& s = out.status;
+        s.push(S_RxMs, rxMs);
+        s.push(S_Port, quint8(port));
+        s.push(S_TimestampMs, quint32(m.timestamp_ms));
+        s.push(S_UptimeMs, quint32(m.uptime_ms));
+        s.push(S_FlightState, qint32(m.flight_state));
+        s.push(S_AccelOk, quint8(m.accel_ok));
+        s.push(S_GyroOk, quint8(m.gyro_ok));
+        s.push(S_Baro1Ok, quint8(m.baro1_ok));
+        s.push(S_Baro2Ok, quint8(m.baro2_ok));
+        s.push(S_GpsConnected, quint8(m.gps_connected));
+        s.push(S_RadioRxCount, quint32(m.radio_rx_count));
+        s.push(S_RadioTxCount, quint32(m.radio_tx_count));
+        s.push(S_CmdRxCount, quint32(m.cmd_rx_count));
+        s.endRow();
+        ++out.stats.status;
+    }
+}
+
+bool BatchDecoder::indexRecording(const uchar* data, quint64 size, std::vector<FrameSpan>& frames) {
+    using namespace recording;
+
+    FileHeader fh;
+    if (size < sizeof(fh))
+        return false;
+    std::memcpy(&fh, data, sizeof(fh));
+    if (std::memcmp(fh.magic, kFileMagic, sizeof(fh.magic)) != 0 || fh.version != kVersion)
+        return false;
+
+    quint64 pos = sizeof(fh);
+    while (pos + sizeof(ChunkHeader) <= size) {
+        ChunkHeader ch;
+        std::memcpy(&ch, data + pos, sizeof(ch));
+        const quint64 end = pos + sizeof(ch) + ch.payloadBytes;
+        if (ch.magic != kChunkMagic || end > size)
+            break; // Torn tail after a crash.
+
+        quint64 at = pos + sizeof(ch);
+        for (quint32 i = 0; i < ch.frameCount && at + sizeof(FrameHeader) <= end; ++i) {
+            FrameHeader hdr;
+            std::memcpy(&hdr, data + at, sizeof(hdr));
+            if (at + sizeof(hdr) + hdr.length > end)
+                break;
+            frames.push_back({ at + sizeof(hdr), hdr.length, hdr.port, hdr.rxNs });
+            at += sizeof(hdr) + paddedLength(hdr.length);
+        }
+        pos = end;
+    }
+    return true;
+}
+
+std::vector<std::pair<quint64, quint64>> BatchDecoder::splitRaw(const uchar* data, quint64 size, int parts) {
+    std::vector<std::pair<quint64, quint64>> ranges;
+    quint64 begin = 0;
+    for (int p = 1; p <= parts && begin < size; ++p) {
+        quint64 end = (p == parts) ? size : qMax(begin, size * quint64(p) / quint64(parts));
+        // Move the cut to just past the next delimiter so no frame straddles two shards.
+        if (end < size) {
+            const void* d = std::memchr(data + end, 0x00, size_t(size - end));
+            end = d ? quint64(static_cast<const uchar*>(d) - data) + 1 : size;
+        }
+        ranges.emplace_back(begin, end);
+        begin = end;
+    }
+    return ranges;
+}
+
+bool BatchDecoder::decodeFile(const QString& path, bool forceRaw, QString* error) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    const quint64 size = quint64(file.size());
+    const uchar* data = size ? file.map(0, qint64(size)) : nullptr;
+    if (!data) {
+        if (error) *error = QStringLiteral("cannot map file (empty?)");
+        return false;
+    }
+
+    const int jobs = (m_jobs > 0) ? m_jobs : qMax(1, QThread::idealThreadCount());
+
+    std::vector<FrameSpan> frames;
+    const bool recording = !forceRaw && indexRecording(data, size, frames);
+    const qint64 baseNs = frames.empty() ? 0 : frames.front().rxNs;
+
+    // Work units: frame-index ranges for recordings, byte ranges for raw captures.
+    std::vector<std::pair<quint64, quint64>> units;
+    if (recording) {
+        const quint64 n = frames.size();
+        for (int p = 0; p < jobs; ++p) {
+            const quint64 a = n * quint64(p) / quint64(jobs), b = n * quint64(p + 1) / quint64(jobs);
+            if (a < b)
+                units.emplace_back(a, b);
+        }
+    } else {
+        units = splitRaw(data, size, jobs);
+    }
+
+    std::vector<Shard> shards(units.size());
+    std::vector<std::unique_ptr<QThread>> threads;
+    for (size_t i = 0; i < units.size(); ++i) {
+        threads.emplace_back(QThread::create([&, i] {
+            Shard& out = shards[i];
+            declareSchema(out);
+            const auto [a, b] = units[i];
+            if (recording) {
+                for (quint64 f = a; f < b; ++f) {
+                    const FrameSpan& fs = frames[size_t(f)];
+                    decodeFrame(data + fs.offset, fs.length, fs.port, double(fs.rxNs - baseNs) / 1e6, out);
+                }
+            } else {
+                // Raw captures have no receive time or port.
+                const double nan = std::numeric_limits<double>::quiet_NaN();
+                quint64 at = a;
+                while (at < b) {
+                    const void* d = std::memchr(data + at, 0x00, size_t(b - at));
+                    const quint64 end = d ? quint64(static_cast<const uchar*>(d) - data) + 1 : b;
+                    if (end - at > 1) // Skip lone delimiters.
+                        decodeFrame(data + at, size_t(end - at), 0, nan, out);
+                    at = end;
+                }
+            }
+        }));
+        threads.back()->start();
+    }
+    for (auto& t : threads)
+        t->wait();
+
+    // Merge in file order.
+    Shard merged;
+    declareSchema(merged); // Keeps the header even for an empty input.
+    merged.stats.shards = int(shards.size());
+    for (const Shard& s : shards) {
+        merged.telemetry.append(s.telemetry);
+        merged.status.append(s.status);
+        merged.stats.frames       += s.stats.frames;
+        merged.stats.telemetry    += s.stats.telemetry;
+        merged.stats.status       += s.stats.status;
+        merged.stats.decodeErrors += s.stats.decodeErrors;
+    }
+    m_telemetry = std::move(merged.telemetry);
+    m_status    = std::move(merged.status);
+    m_stats     = merged.stats;
+    return true;
+}
@@ -0,0 +1,62 @@
+#include "CommandCatalog.h"
+
+extern "C" {
+    #include "rp/codec.h"
+}
+
+namespace {
+constexpr int kFirstStateCmd = 1;   ///< ARM
+constexpr int kLastStateCmd  = 4;   ///< LAND
+constexpr size_t kMaxPacket  = 300;
+
+tvr_FlightCommand stateCommand(int commandType) {
+    tvr_FlightCommand cmd = tvr_FlightCommand_init_zero;
+    cmd.which_payload = tvr_FlightCommand_state_cmd_tag;
+    cmd.payload.state_cmd.type = (tvr_StateCommand_Type)commandType;
+    return cmd;
+}
+}
+
+CommandCatalog::CommandCatalog()
+{
+    for (int t = kFirstStateCmd; t <= kLastStateCmd; ++t)
+        m_state[size_t(t)] = encode(stateCommand(t));
+}
+
+QByteArray CommandCatalog::encode(const tvr_FlightCommand& cmd)
+{
+    uint8_t buf[kMaxPacket];
+    const rp_packet_encode_result_t r = rp_packet_encode(buf, sizeof(buf), tvr_FlightCommand_fields, &cmd);
+    if (r.status != RP_CODEC_OK)
+        return QByteArray();
+    return QByteArray(reinterpret_cast<const char*>(buf), qsizetype(r.written));
+}
+
+QByteArray CommandCatalog::statePacket(int commandType)
+{
+    if (commandType >= 0 && commandType < kStateSlots) {
+        QByteArray& slot = m_state[size_t(commandType)];
+        if (slot.isEmpty())
+            slot = encode(stateCommand(commandType));
+        return slot;
+    }
+
+    const QString name = QStringLiteral("state:%1").arg(commandType);
+    auto it = m_named.constFind(name);
+    if (it != m_named.constEnd())
+        return *it;
+    return define(name, stateCommand(commandType)) ? m_named.value(name) : QByteArray();
+}
+
+bool CommandCatalog::define(const QString& name, const tvr_FlightCommand& cmd)
+{
+    const QByteArray packet = encode(cmd);
+    if (packet.isEmpty())
+        return false;
+
+    // Keep the existing buffer (and everyone sharing it) if nothing changed.
+    QByteArray& slot = m_named[name];
+    if (slot != packet)
+        slot = packet;
+    return true;
+}
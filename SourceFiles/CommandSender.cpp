@@ -1,37 +1,18 @@
 #include "CommandSender.h"
+#include "CommandTracker.h"
 #include "SerialBridge.h"
-#include <QTimer>
 extern "C" {
     #include "rp/codec.h"
     #include "command.pb.h"
 }
 
+namespace {
+constexpr int kCmdAbort = 3; ///< StateCommand.Type ABORT
+}
+
 CommandSender::CommandSender(SerialBridge* bridge, QObject* parent)
-    : m_bridge(bridge), QObject(parent)
+    : QObject(parent), m_bridge(bridge)
 {
-    // Channel 1 periodic sender: fires at fixed rate, sends cached payload if bridge exists.
-    m_ch1.timer.setTimerType(Qt::PreciseTimer);
-    connect(&m_ch1.timer, &QTimer::timeout, this, [this]() {
-        if (!m_bridge) { emit errorOccurred("No Bridge"); return; }
-        if (!m_ch1.payload.isEmpty()) {
-            if (m_bridge->sendText(1, m_ch1.payload))
-                emit messageSent(m_ch1.payload);
-            else
-                emit errorOccurred("Periodic send failed (P1)");
-        }
-    });
-
-    // Channel 2 periodic sender: same idea but for channel 2 payload.
-    m_ch2.timer.setTimerType(Qt::PreciseTimer);
-    connect(&m_ch2.timer, &QTimer::timeout, this, [this]() {
-        if (!m_bridge) { emit errorOccurred("No Bridge"); return; }
-        if (!m_ch2.payload.isEmpty()) {
-            if (m_bridge->sendText(1, m_ch2.payload))
-                emit messageSent(m_ch2.payload);
-            else
-                emit errorOccurred("Periodic send failed (P1)");
-        }
-    });
 }
 
 bool CommandSender::sendCode(int which, const QString& code) {
@@ -56,7 +37,24 @@ bool CommandSender::sendCode(int which, const QString& code) {
     return ok;                             // Let caller know if it worked.
 }
 
-void CommandSender::startPeriodic(int which, const QString& code, int hz) {
+void CommandSender::startPeriodic(int which, const QString& code, double hz) {
+    QString line = code;
+    if (!line.endsWith('\n'))
+        line.append('\n');
+    startStream(which, line.toUtf8(), true, hz, code);
+}
+
+void CommandSender::startPeriodicCommand(int which, int commandType, double hz) {
+    const QByteArray packet = m_catalog.statePacket(commandType);
+    if (packet.isEmpty()) {
+        emit errorOccurred("Failed to encode packet");
+        return;
+    }
+    startStream(which, packet, false, hz, QString("FlightCommand %1").arg(commandType));
+}
+
+void CommandSender::startStream(int which, const QByteArray& payload, bool text, double hz,
+                                const QString& label) {
     if (!validWhich(which)) {
         emit errorOccurred("which must be 1 or 2");
         return;
@@ -67,11 +65,20 @@ void CommandSender::startPeriodic(int which, const QString& code, int hz) {
         return;
     }
 
-    // Store payload and frequency, then arm the channel timer.
+    if (!m_scheduler) {
+        emit errorOccurred("No scheduler");
+        return;
+    }
+
+    // Store payload and frequency, then (re)start the channel's drift-free stream.
     auto& c = chan(which);
-    c.payload = code;
+    if (c.stream)
+        m_scheduler->stop(c.stream);
+    c.payload = label;
     c.hz = hz;
-    c.timer.start(1000 / hz);             // Simple ms interval: 1000ms / Hz.
+    c.stream = m_scheduler->start(which, payload, text, hz, TxQueue::Periodic, label);
+    if (!c.stream)
+        emit errorOccurred(QString("Periodic send failed (P%1)").arg(which));
 }
 
 void CommandSender::stopPeriodic(int which) {
@@ -80,15 +87,18 @@ void CommandSender::stopPeriodic(int which) {
         return;
     }
 
-    // Just stop the underlying QTimer for that channel.
-    chan(which).timer.stop();
+    // The stream id is kept so its final statistics stay reachable via periodicStream().
+    const auto& c = chan(which);
+    if (c.stream && m_scheduler)
+        m_scheduler->stop(c.stream);
 }
 
 bool CommandSender::isPeriodicRunning(int which) const {
     if (!validWhich(which))
         return false;
 
-    return chan(which).timer.isActive();  // True if the periodic timer is currently running.
+    const auto& c = chan(which);
+    return c.stream && m_scheduler && m_scheduler->isRunning(c.stream);
 }
 
 bool CommandSender::sendFlightCommand(int which, int commandType) {
@@ -102,30 +112,20 @@ bool CommandSender::sendFlightCommand(int which, int commandType) {
         return false;
     }
     
-    // 1. Create FlightCommand message
-    tvr_FlightCommand cmd = tvr_FlightCommand_init_zero;
-    cmd.which_payload = tvr_FlightCommand_state_cmd_tag;  // Set oneof
-    cmd.payload.state_cmd.type = (tvr_StateCommand_Type)commandType;  // Set type
-
-    
-    // 2. Encode to COBS packet
-    uint8_t packet[300];
-    rp_packet_encode_result_t result = rp_packet_encode(
-        packet,
-        sizeof(packet),
-        tvr_FlightCommand_fields,
-        &cmd
-    );
-    
-    if (result.status != RP_CODEC_OK) {
+    // Encoded once by the catalogue; every send shares the same buffer.
+    const QByteArray data = m_catalog.statePacket(commandType);
+    if (data.isEmpty()) {
         emit errorOccurred("Failed to encode packet");
         return false;
     }
-    
-    // 3. Send binary packet
-    QByteArray data(reinterpret_cast<const char*>(packet), result.written);
-    
-    if (!m_bridge->sendBinary(which, data)) {
+
+    // An abort jumps ahead of everything already queued.
+    const int priority = (commandType == kCmdAbort) ? SerialBridge::TxCritical
+                                                    : SerialBridge::TxCommand;
+
+    const bool sent = m_tracker ? m_tracker->submit(which, commandType, data, priority) != 0
+                                : m_bridge->sendBinary(which, data, priority);
+    if (!sent) {
         emit errorOccurred("Failed to send binary packet");
         return false;
     }
@@ -0,0 +1,327 @@
+#include "CommandTracker.h"
+#include "AllocCounter.h"
+#include <algorithm>
+extern "C" {
+    #include "rp/codec.h"
+}
+
+namespace {
+// Flight states as reported by the vehicle
+constexpr int kEstop = 1;
+constexpr int kRise  = 2;
+constexpr int kLower = 4;
+
+// FlightCommand state command types (same numbering as the control panel)
+constexpr int kCmdArm    = 1;
+constexpr int kCmdLaunch = 2;
+constexpr int kCmdAbort  = 3;
+constexpr int kCmdLand   = 4;
+
+constexpr int kTickMs    = 50;
+constexpr int kRecentMax = 32;
+
+/// Flight state a command leads to, or -1 if it has no visible effect (ARM).
+int expectedState(int commandType) {
+    switch (commandType) {
+    case kCmdLaunch: return kRise;
+    case kCmdAbort:  return kEstop;
+    case kCmdLand:   return kLower;
+    default:         return -1;
+    }
+}
+
+double nsToMs(qint64 ns) { return double(ns) / 1e6; }
+
+/// Confirmation wait of attempt number `attempt` (0-based): each retry waits twice as long.
+qint64 attemptWaitNs(int timeoutMs, int attempt) { return qint64(timeoutMs) * 1000000 << qMin(attempt, 6); }
+}
+
+CommandTracker::CommandTracker(SerialBridge* bridge, SensorDataModel* model, QObject* parent)
+    : QObject(parent), m_bridge(bridge), m_model(model), m_tick(this)
+{
+    m_tick.setInterval(kTickMs);
+    connect(&m_tick, &QTimer::timeout, this, &CommandTracker::onTick);
+
+    if (model)
+        model->setCommandTracker(this);
+}
+
+QString CommandTracker::commandName(int commandType)
+{
+    switch (commandType) {
+    case kCmdArm:    return QStringLiteral("ARM");
+    case kCmdLaunch: return QStringLiteral("LAUNCH");
+    case kCmdAbort:  return QStringLiteral("ABORT");
+    case kCmdLand:   return QStringLiteral("LAND");
+    default:         return QStringLiteral("CMD %1").arg(commandType);
+    }
+}
+
+void CommandTracker::setTimeoutMs(int ms)
+{
+    ms = qMax(50, ms);
+    if (ms == m_timeoutMs)
+        return;
+    m_timeoutMs = ms;
+    emit settingsChanged();
+}
+
+void CommandTracker::setMaxRetries(int n)
+{
+    n = qMax(0, n);
+    if (n == m_maxRetries)
+        return;
+    m_maxRetries = n;
+    emit settingsChanged();
+}
+
+// -----------------------
+// Sending
+// -----------------------
+
+quint64 CommandTracker::submit(int which, int commandType, const QByteArray& packet, int priority)
+{
+    if (!m_bridge || !m_bridge->isConnected(which))
+        return 0;
+
+    Command c;
+    c.id = m_nextId++;
+    c.which = which;
+    c.type = commandType;
+    c.priority = priority;
+    c.packet = packet;
+    if (!transmit(c))
+        return 0;
+
+    ++m_stats[commandType].sent;
+    m_pending.push_back(c);
+    publishLatest(c, Queued);
+    if (!m_tick.isActive())
+        m_tick.start();
+    emit changed();
+    return c.id;
+}
+
+bool CommandTracker::transmit(Command& c)
+{
+    // Earlier attempts keep their send times: any of them may still land.
+    const int attempt = c.attempts++;
+    c.sentNs.push_back(0);
+    c.deadlineNs = monotonicNs() + attemptWaitNs(m_timeoutMs, attempt); // Also bounds the time spent in the TX queue.
+
+    QPointer<CommandTracker> self(this);
+    const quint64 id = c.id;
+    return m_bridge && m_bridge->send(c.which, c.packet, false, c.priority, QByteArray(),
+                                      [self, id, attempt](int result) {
+        if (self)
+            self->onTxResult(id, attempt, result);
+    }) != 0;
+}
+
+void CommandTracker::onTxResult(quint64 id, int attempt, int result)
+{
+    const qint64 now = monotonicNs();
+    const qint64 waitNs = attemptWaitNs(m_timeoutMs, attempt);
+    if (result == TxQueue::Sent) // The rocket will count this copy whether or not we still wait for it.
+        m_inFlight.push_back(Attempt { id, now, now + 2 * waitNs });
+
+    auto it = find(id);
+    if (it == m_pending.end())
+        return; // Already confirmed (e.g. by an earlier attempt).
+
+    const bool latest = attempt == it->attempts - 1;
+    if (result == TxQueue::Sent) {
+        it->sentNs[size_t(attempt)] = now;
+        if (latest) // The timeout runs from the moment the bytes reached the link.
+            it->deadlineNs = now + waitNs;
+        publishLatest(*it, Sent);
+        emit changed();
+    } else if (result == TxQueue::Closed) {
+        fail(it, QStringLiteral("link closed"));
+    } else if (latest) {
+        it->deadlineNs = now; // Never left the queue: retry on the next tick.
+    }
+}
+
+// -----------------------
+// Confirmation
+// -----------------------
+
+void CommandTracker::observe(const DownlinkRecord& rec, const TelemetrySnapshot& state)
+{
+    if (rec.status != RP_CODEC_OK)
+        return;
+    if (rec.downlink.which_payload == tvr_Downlink_status_tag)
+        onCmdRxCount(state.cmdRxCount);
+    onFlightState(state.flightState);
+}
+
+void CommandTracker::onCmdRxCount(quint32 count)
+{
+    if (count == m_lastCount && m_haveCount)
+        return;
+    if (!m_haveCount || count < m_lastCount) {
+        // First status, or the rocket rebooted: only a baseline.
+        m_haveCount = true;
+        m_lastCount = count;
+        return;
+    }
+    quint32 delta = count - m_lastCount;
+    m_lastCount = count;
+    // The rocket counts commands from every link in one counter, and a stream's TX link
+    // need not be the link the status came down on: while any stream runs, no increment
+    // can be attributed.
+    if (m_scheduler && m_scheduler->sendsPackets())
+        return;
+
+    // One increment per received copy: consume the oldest outstanding attempts. Copies of
+    // commands already confirmed (by state or an earlier copy) or failed are absorbed here.
+    const qint64 now = monotonicNs();
+    while (delta > 0 && !m_inFlight.empty()) {
+        const Attempt a = m_inFlight.front();
+        m_inFlight.pop_front();
+        if (a.expiresNs < now)
+            continue; // Lost on the way; it will never be counted.
+        --delta;
+        auto it = find(a.id);
+        if (it != m_pending.end())
+            ack(it, a.sentNs, QStringLiteral("counter"));
+    }
+}
+
+void CommandTracker::onFlightState(int state)
+{
+    if (state == m_lastState)
+        return;
+    m_lastState = state;
+
+    for (auto it = m_pending.begin(); it != m_pending.end(); ++it) {
+        if (expectedState(it->type) != state)
+            continue;
+        // Its attempts stay in m_inFlight to absorb their cmd_rx_count increments.
+        const auto sent = std::find_if(it->sentNs.rbegin(), it->sentNs.rend(), [](qint64 ns) { return ns != 0; });
+        if (sent != it->sentNs.rend()) {
+            ack(it, *sent, QStringLiteral("state"));
+            return;
+        }
+    }
+}
+
+void CommandTracker::onTick()
+{
+    const qint64 now = monotonicNs();
+    std::vector<quint64> due;
+    for (const Command& c : m_pending)
+        if (now >= c.deadlineNs)
+            due.push_back(c.id);
+
+    for (quint64 id : due) {
+        auto it = find(id);
+        if (it == m_pending.end())
+            continue;
+        if (it->attempts > m_maxRetries) {
+            fail(it, QStringLiteral("no confirmation after %1 attempts").arg(it->attempts));
+            continue;
+        }
+        ++m_stats[it->type].retries;
+        if (!transmit(*it))
+            fail(it, QStringLiteral("link closed"));
+        else
+            emit changed();
+    }
+
+    while (!m_inFlight.empty() && m_inFlight.front().expiresNs < now)
+        m_inFlight.pop_front();
+
+    if (m_pending.empty())
+        m_tick.stop();
+}
+
+void CommandTracker::ack(std::deque<Command>::iterator it, qint64 sentNs, const QString& via)
+{
+    ULYSSES_ALLOC_EXEMPT(); // Runs inside the drain loop's no-allocation scope.
+    const Command c = *it;
+    m_pending.erase(it);
+
+    const qint64 rttNs = monotonicNs() - sentNs;
+    TypeStats& st = m_stats[c.type];
+    ++st.acked;
+    st.rtt.record(rttNs);
+
+    finish(c, Acked, nsToMs(rttNs), via, QString());
+    emit commandAcked(c.id, c.type, nsToMs(rttNs), via);
+}
+
+void CommandTracker::fail(std::deque<Command>::iterator it, const QString& reason)
+{
+    const Command c = *it;
+    m_pending.erase(it);
+    ++m_stats[c.type].failed;
+
+    finish(c, Failed, 0.0, QString(), reason);
+    emit commandFailed(c.id, c.type, reason);
+}
+
+void CommandTracker::finish(const Command& c, State state, double rttMs, const QString& via,
+                            const QString& reason)
+{
+    publishLatest(c, state, rttMs, via, reason);
+
+    QVariantMap row = m_latest.value(QString::number(c.type)).toMap();
+    row.insert(QStringLiteral("type"), c.type);
+    row.insert(QStringLiteral("name"), commandName(c.type));
+    m_recent.prepend(row);
+    while (m_recent.size() > kRecentMax)
+        m_recent.removeLast();
+    emit changed();
+}
+
+void CommandTracker::publishLatest(const Command& c, State state, double rttMs, const QString& via,
+                                   const QString& reason)
+{
+    m_latest.insert(QString::number(c.type), QVariantMap {
+        { QStringLiteral("id"),       c.id },
+        { QStringLiteral("state"),    int(state) },
+        { QStringLiteral("attempts"), c.attempts },
+        { QStringLiteral("rttMs"),    rttMs },
+        { QStringLiteral("via"),      via },
+        { QStringLiteral("reason"),   reason },
+    });
+}
+
+std::deque<CommandTracker::Command>::iterator CommandTracker::find(quint64 id)
+{
+    return std::find_if(m_pending.begin(), m_pending.end(), [id](const Command& c) { return c.id == id; });
+}
+
+// -----------------------
+// Statistics
+// -----------------------
+
+QVariantList CommandTracker::rttStats() const
+{
+    QVariantList out;
+    for (auto it = m_stats.cbegin(); it != m_stats.cend(); ++it) {
+        const TypeStats& st = it.value();
+        out.append(QVariantMap {
+            { QStringLiteral("type"),    it.key() },
+            { QStringLiteral("name"),    commandName(it.key()) },
+            { QStringLiteral("sent"),    st.sent },
+            { QStringLiteral("acked"),   st.acked },
+            { QStringLiteral("failed"),  st.failed },
+            { QStringLiteral("retries"), st.retries },
+            { QStringLiteral("p50Ms"),   nsToMs(st.rtt.percentile(50.0)) },
+            { QStringLiteral("p99Ms"),   nsToMs(st.rtt.percentile(99.0)) },
+            { QStringLiteral("maxMs"),   nsToMs(st.rtt.max()) },
+            { QStringLiteral("meanMs"),  st.rtt.mean() / 1e6 },
+        });
+    }
+    return out;
+}
+
+void CommandTracker::resetStats()
+{
+    m_stats.clear();
+    m_recent.clear();
+    emit changed();
+}
@@ -0,0 +1,112 @@
+#include "DiversityCombiner.h"
+
+DiversityCombiner::DiversityCombiner()
+{
+    m_links.reserve(kMaxLinks); // A link seen for the first time must not allocate on the RX path.
+}
+
+int DiversityCombiner::slotOf(int which)
+{
+    for (size_t i = 0; i < m_links.size(); ++i)
+        if (m_links[i].id == which)
+            return int(i);
+    if (m_links.size() >= size_t(kMaxLinks))
+        return -1;
+    LinkCounters c;
+    c.id = which;
+    m_links.push_back(c);
+    return int(m_links.size()) - 1;
+}
+
+const DiversityCombiner::LinkCounters* DiversityCombiner::countersOf(int which) const
+{
+    for (const LinkCounters& c : m_links)
+        if (c.id == which)
+            return &c;
+    return nullptr;
+}
+
+bool DiversityCombiner::offer(int which, int vehicle, int payloadType, quint32 timestampMs, qint64 nowNs)
+{
+    const int slot = slotOf(which);
+    if (slot < 0)
+        return true; // Untracked link: never suppress its packets.
+    LinkCounters& lc = m_links[size_t(slot)];
+    ++lc.offered;
+
+    const quint64 bit = quint64(1) << slot;
+    for (Entry& e : m_window) {
+        if (e.payloadType != payloadType || e.timestampMs != timestampMs || e.vehicle != vehicle)
+            continue;
+        if (nowNs - e.firstNs > kWindowNs) {
+            settle(e);    // Same key long after: the sender restarted, treat as new.
+            continue;
+        }
+        if (e.links & bit)
+            continue;     // This link already delivered that one: a distinct packet, same key.
+        e.links |= bit;
+        ++lc.duplicates;
+        lc.lagNsSum += nowNs - e.firstNs;
+        ++m_duplicates;
+        return false;
+    }
+
+    Entry& e = m_window[size_t(m_next)];
+    m_next = (m_next + 1) % kWindow;
+    settle(e);
+    e.timestampMs = timestampMs;
+    e.payloadType = payloadType;
+    e.vehicle = vehicle;
+    e.links = bit;
+    e.firstNs = nowNs;
+    e.firstSlot = slot;
+    ++lc.first;
+    ++m_unique;
+    return true;
+}
+
+void DiversityCombiner::settle(Entry& e)
+{
+    if (e.payloadType < 0)
+        return;
+    if ((e.links & (e.links - 1)) == 0)
+        ++m_links[size_t(e.firstSlot)].solo;
+    else
+        ++m_multiLink;
+    e.payloadType = -1;
+}
+
+void DiversityCombiner::reset()
+{
+    m_window.fill(Entry());
+    m_next = 0;
+    m_links.clear();
+    m_unique = m_duplicates = m_multiLink = 0;
+}
+
+QVariantMap DiversityCombiner::linkStats(int which) const
+{
+    const LinkCounters* c = countersOf(which);
+    if (!c)
+        return {};
+    return {
+        { QStringLiteral("offered"),    c->offered },
+        { QStringLiteral("first"),      c->first },
+        { QStringLiteral("duplicates"), c->duplicates },
+        { QStringLiteral("solo"),       c->solo },
+        { QStringLiteral("lagMs"),      c->duplicates ? double(c->lagNsSum) / double(c->duplicates) / 1e6 : 0.0 },
+    };
+}
+
+QVariantMap DiversityCombiner::summary() const
+{
+    QVariantMap solo;
+    for (const LinkCounters& c : m_links)
+        solo.insert(QString::number(c.id), c.solo);
+    return {
+        { QStringLiteral("unique"),     m_unique },
+        { QStringLiteral("duplicates"), m_duplicates },
+        { QStringLiteral("multiLink"),  m_multiLink },
+        { QStringLiteral("soloByLink"), solo },
+    };
+}
@@ -0,0 +1,115 @@
+#include "DownlinkGenerator.h"
+#include <cmath>
+
+extern "C" {
+    #include "rp/codec.h"
+}
+
+DownlinkGenerator::DownlinkGenerator(const Options& options)
+    : m_opt(options), m_rng(options.seed)
+{
+}
+
+void DownlinkGenerator::next(tvr_Downlink& msg)
+{
+    msg = tvr_Downlink_init_zero;
+    m_timestampMs += m_opt.periodMs;
+    ++m_generated;
+
+    if (m_opt.statusEvery > 0 && m_sinceStatus >= m_opt.statusEvery) {
+        m_sinceStatus = 0;
+        fillStatus(msg);
+    } else {
+        ++m_sinceStatus;
+        fillTelemetry(msg);
+    }
+}
+
+void DownlinkGenerator::fillTelemetry(tvr_Downlink& msg)
+{
+    msg.which_payload = tvr_Downlink_telemetry_tag;
+    auto& t = msg.payload.telemetry;
+
+    // Slow hover-ish wobble so consecutive values differ like real data.
+    const float s = float(m_timestampMs) * 0.001f;
+    t.timestamp_ms = m_timestampMs;
+    t.flight_state = decltype(t.flight_state)(3); // HOVER
+    t.thrust_cmd   = 0.6f + 0.05f * std::sin(s);
+    t.gimbal_x     = 2.0f * std::sin(1.3f * s);
+    t.gimbal_y     = 2.0f * std::cos(1.1f * s);
+
+    if ((t.has_position = coin(m_opt.optionalRate))) {
+        t.position.x = 0.2f * std::sin(0.3f * s);
+        t.position.y = 0.2f * std::cos(0.3f * s);
+        t.position.z = 5.0f + 0.5f * std::sin(0.5f * s);
+    }
+    if ((t.has_velocity = coin(m_opt.optionalRate))) {
+        t.velocity.x = 0.06f * std::cos(0.3f * s);
+        t.velocity.y = -0.06f * std::sin(0.3f * s);
+        t.velocity.z = 0.25f * std::cos(0.5f * s);
+    }
+    if ((t.has_attitude = coin(m_opt.optionalRate))) {
+        // Small roll/pitch about level, as a unit quaternion.
+        const float hr = 0.02f * std::sin(1.7f * s);
+        const float hp = 0.02f * std::cos(1.9f * s);
+        t.attitude.w = std::cos(hr) * std::cos(hp);
+        t.attitude.x = std::sin(hr) * std::cos(hp);
+        t.attitude.y = std::cos(hr) * std::sin(hp);
+        t.attitude.z = -std::sin(hr) * std::sin(hp);
+    }
+    if ((t.has_angular_rate = coin(m_opt.optionalRate))) {
+        t.angular_rate.x = 0.068f * std::cos(1.7f * s);
+        t.angular_rate.y = -0.076f * std::sin(1.9f * s);
+        t.angular_rate.z = 0.01f * std::sin(s);
+    }
+}
+
+void DownlinkGenerator::fillStatus(tvr_Downlink& msg)
+{
+    msg.which_payload = tvr_Downlink_status_tag;
+    auto& st = msg.payload.status;
+    st.timestamp_ms   = m_timestampMs;
+    st.uptime_ms      = m_timestampMs;
+    st.flight_state   = decltype(st.flight_state)(3); // HOVER
+    st.accel_ok       = true;
+    st.gyro_ok        = true;
+    st.baro1_ok       = true;
+    st.baro2_ok       = coin(0.99);
+    st.gps_connected  = coin(m_opt.optionalRate);
+    st.radio_rx_count = quint32(m_generated / 50);
+    st.radio_tx_count = quint32(m_generated);
+    st.cmd_rx_count   = quint32(m_generated / 50);
+}
+
+size_t DownlinkGenerator::encode(const tvr_Downlink& msg, uint8_t* out, size_t capacity)
+{
+    if (capacity < 2)
+        return 0;
+    const rp_packet_encode_result_t r = rp_packet_encode(out, capacity - 1, &tvr_Downlink_msg, &msg);
+    if (r.status != RP_CODEC_OK || r.written == 0)
+        return 0;
+    size_t n = r.written;
+    if (out[n - 1] != 0x00)
+        out[n++] = 0x00; // Framers split on the delimiter; always ship it.
+    return n;
+}
+
+size_t DownlinkGenerator::nextFrame(uint8_t* out, size_t capacity, bool* corrupted)
+{
+    tvr_Downlink msg;
+    next(msg);
+    const size_t n = encode(msg, out, capacity);
+    const bool flip = n > 0 && coin(m_opt.corruptRate);
+    if (flip)
+        corrupt(out, n, m_rng);
+    if (corrupted)
+        *corrupted = flip;
+    return n;
+}
+
+QByteArray DownlinkGenerator::nextFrame(bool* corrupted)
+{
+    uint8_t buf[kMaxFrame];
+    const size_t n = nextFrame(buf, sizeof(buf), corrupted);
+    return QByteArray(reinterpret_cast<const char*>(buf), qsizetype(n));
+}
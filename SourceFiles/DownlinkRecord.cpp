@@ -0,0 +1,108 @@
+#include "DownlinkRecord.h"
+#include <QDebug>
+#include <QtMath>
+#include <cmath>
+
+namespace {
+static constexpr bool kDownlinkDebug = false;
+} // namespace
+
+void quatToEulerRad(float w, float x, float y, float z,
+                    float* roll_rad, float* pitch_rad, float* yaw_rad) {
+    double sinp = 2.0 * (w * y - z * x);
+    if (std::abs(sinp) >= 1) {
+        *pitch_rad = static_cast<float>(std::copysign(M_PI / 2, sinp));
+    } else {
+        *pitch_rad = static_cast<float>(std::asin(sinp));
+    }
+    double siny_cosp = 2.0 * (w * z + x * y);
+    double cosy_cosp = 1.0 - 2.0 * (y * y + z * z);
+    *yaw_rad = static_cast<float>(std::atan2(siny_cosp, cosy_cosp));
+    double sinr_cosp = 2.0 * (w * x + y * z);
+    double cosr_cosp = 1.0 - 2.0 * (x * x + y * y);
+    *roll_rad = static_cast<float>(std::atan2(sinr_cosp, cosr_cosp));
+}
+
+float radToDeg(float rad) {
+    return static_cast<float>(rad * 180.0 / M_PI);
+}
+
+void TelemetrySnapshot::apply(const tvr_Downlink& d)
+{
+    if (d.which_payload == tvr_Downlink_telemetry_tag) {
+        const tvr_TelemetryState* t = &d.payload.telemetry;
+
+        if (kDownlinkDebug) {
+            qDebug() << "TelemetryState: has_pos=" << t->has_position
+                     << "has_vel=" << t->has_velocity
+                     << "has_att=" << t->has_attitude
+                     << "flight_state=" << t->flight_state;
+        }
+
+        // Velocity magnitude [m/s] → km/h
+        if (t->has_velocity) {
+            const tvr_Vec3* v = &t->velocity;
+            double vx = static_cast<double>(v->x), vy = static_cast<double>(v->y), vz = static_cast<double>(v->z);
+            velocity = std::sqrt(vx * vx + vy * vy + vz * vz) * 3.6;
+        }
+
+        // Filtered Euler angles (deg) from attitude quaternion.
+        filteredAngleX = filteredAngleY = filteredAngleZ = 0.0;
+        if (t->has_attitude) {
+            float roll, pitch, yaw;
+            quatToEulerRad(t->attitude.w, t->attitude.x, t->attitude.y, t->attitude.z,
+                           &roll, &pitch, &yaw);
+            filteredAngleX = radToDeg(roll);
+            filteredAngleY = radToDeg(pitch);
+            filteredAngleZ = radToDeg(yaw);
+        }
+
+        // Raw angular rates (rad/s) → deg/s for display alongside Euler angles.
+        rawAngleX = rawAngleY = rawAngleZ = 0.0;
+        if (t->has_angular_rate) {
+            rawAngleX = radToDeg(t->angular_rate.x);
+            rawAngleY = radToDeg(t->angular_rate.y);
+            rawAngleZ = radToDeg(t->angular_rate.z);
+        }
+
+        // Position [m]: altitude from z, horizontal from x/y.
+        if (t->has_position) {
+            altitude = static_cast<double>(t->position.z);
+            posX     = static_cast<double>(t->position.x);
+            posY     = static_cast<double>(t->position.y);
+        }
+
+        // Flight state from TelemetryState (10Hz update).
+        flightState = static_cast<int>(t->flight_state);
+
+        thrustCmd = static_cast<double>(t->thrust_cmd);
+        gimbalX   = static_cast<double>(t->gimbal_x);
+        gimbalY   = static_cast<double>(t->gimbal_y);
+
+        ++telemetryCount;
+
+    } else if (d.which_payload == tvr_Downlink_status_tag) {
+        const tvr_SystemStatus* s = &d.payload.status;
+
+        if (kDownlinkDebug) {
+            qDebug() << "SystemStatus: flight_state=" << s->flight_state
+                     << "accel=" << s->accel_ok << "gyro=" << s->gyro_ok
+                     << "baro1=" << s->baro1_ok << "baro2=" << s->baro2_ok
+                     << "gps=" << s->gps_connected
+                     << "uptime=" << s->uptime_ms;
+        }
+
+        flightState  = static_cast<int>(s->flight_state);
+        uptimeMs     = s->uptime_ms;
+        accelOk      = s->accel_ok;
+        gyroOk       = s->gyro_ok;
+        baro1Ok      = s->baro1_ok;
+        baro2Ok      = s->baro2_ok;
+        gpsConnected = s->gps_connected;
+        radioRxCount = s->radio_rx_count;
+        radioTxCount = s->radio_tx_count;
+        cmdRxCount   = s->cmd_rx_count;
+
+        ++statusCount;
+    }
+}
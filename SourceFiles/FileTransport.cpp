@@ -0,0 +1,49 @@
+#include "FileTransport.h"
+#include <limits>
+
+namespace {
+constexpr int kTickMs = 10;
+}
+
+FileTransport::FileTransport(const QString& path, int baud, QObject* parent)
+    : Transport(parent), m_file(path), m_baud(baud), m_timer(this)
+{
+    m_timer.setInterval(kTickMs);
+    connect(&m_timer, &QTimer::timeout, this, &FileTransport::tick);
+}
+
+bool FileTransport::open() {
+    close();
+    if (!m_file.open(QIODevice::ReadOnly))
+        return false;
+    m_released = m_consumed = 0;
+    m_clock.start();
+    m_timer.start();
+    return true;
+}
+
+void FileTransport::close() {
+    m_timer.stop();
+    m_file.close();
+}
+
+void FileTransport::tick() {
+    if (m_file.atEnd()) {
+        m_timer.stop(); // Whole capture delivered; the link stays open (idle).
+        return;
+    }
+    m_released = (m_baud > 0) ? m_clock.elapsed() * m_baud / 10 / 1000
+                              : std::numeric_limits<qint64>::max();
+    if (m_released > m_consumed)
+        emit readyRead();
+}
+
+qint64 FileTransport::read(char* dst, qint64 max) {
+    const qint64 budget = qMin(max, m_released - m_consumed);
+    if (budget <= 0)
+        return 0;
+    const qint64 n = m_file.read(dst, budget);
+    if (n > 0)
+        m_consumed += n;
+    return n;
+}
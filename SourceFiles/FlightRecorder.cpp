@@ -0,0 +1,237 @@
+#include "FlightRecorder.h"
+#include "DownlinkRecord.h"
+#include "RecordingFormat.h"
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QStandardPaths>
+#include <QThread>
+#include <cstring>
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#elif defined(Q_OS_WIN)
+#include <io.h>
+#endif
+
+using namespace recording;
+
+FlightRecorder::FlightRecorder(QObject* parent)
+    : QObject(parent)
+    , m_defaultDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+                   + QStringLiteral("/recordings"))
+{
+    m_statsTimer.setInterval(500);
+    connect(&m_statsTimer, &QTimer::timeout, this, &FlightRecorder::statsChanged);
+}
+
+FlightRecorder::~FlightRecorder() {
+    stop();
+}
+
+bool FlightRecorder::start(const QString& path) {
+    if (m_writer)
+        stop();
+
+    QString target = path;
+    if (target.isEmpty()) {
+        QDir().mkpath(m_defaultDir);
+        target = QStringLiteral("%1/flight-%2.ulog")
+                     .arg(m_defaultDir, QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss"));
+    }
+
+    m_file.setFileName(target);
+    m_index.setFileName(target + QStringLiteral(".idx"));
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+        !m_index.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        emit errorMessage(QStringLiteral("Recorder: cannot open %1: %2").arg(target, m_file.errorString()));
+        m_file.close();
+        m_index.close();
+        return false;
+    }
+
+    FileHeader fh {};
+    std::memcpy(fh.magic, kFileMagic, sizeof(fh.magic));
+    fh.version      = kVersion;
+    fh.createdUtcMs = QDateTime::currentMSecsSinceEpoch();
+    fh.startRxNs    = monotonicNs();
+    m_file.write(reinterpret_cast<const char*>(&fh), sizeof(fh));
+
+    IndexHeader ih {};
+    std::memcpy(ih.magic, kIndexMagic, sizeof(ih.magic));
+    ih.version = kVersion;
+    m_index.write(reinterpret_cast<const char*>(&ih), sizeof(ih));
+
+    // Reserve both staging buffers up front so record() never allocates. A record() that
+    // passed its unlocked check before the last stop() may still be waiting for the lock.
+    const size_t reserve = size_t(m_options.maxStagingBytes);
+    {
+        QMutexLocker lock(&m_mutex);
+        m_stage = Stage{};
+        m_spare = Stage{};
+        m_stage.bytes.reserve(reserve);
+        m_spare.bytes.reserve(reserve);
+        m_stopping = false;
+    }
+
+    m_framesWritten = 0;
+    m_bytesWritten  = sizeof(fh);
+    m_framesDropped = 0;
+    m_path = target;
+
+    // The files belong to the writer thread from here on; we don't touch them again until stop().
+    m_writer = QThread::create([this] { writerLoop(); });
+    m_writer->setObjectName(QStringLiteral("FlightRecorder"));
+    m_writer->start(QThread::LowPriority);
+
+    m_recording.store(true, std::memory_order_release);
+    m_statsTimer.start();
+    emit recordingChanged();
+    return true;
+}
+
+void FlightRecorder::stop() {
+    if (!m_writer)
+        return;
+
+    m_recording.store(false, std::memory_order_release);
+    {
+        QMutexLocker lock(&m_mutex);
+        m_stopping = true;
+        m_wake.wakeOne();
+    }
+    m_writer->wait();
+    delete m_writer;
+    m_writer = nullptr;
+
+    m_statsTimer.stop();
+    emit statsChanged();
+    emit recordingChanged();
+}
+
+void FlightRecorder::record(int which, qint64 rxNs, const uint8_t* data, size_t size) {
+    if (!isRecording() || size == 0 || size > 0xFFFF)
+        return;
+
+    const size_t padded = paddedLength(quint32(size));
+    FrameHeader hdr {};
+    hdr.rxNs   = rxNs;
+    hdr.length = quint16(size);
+    hdr.port   = quint8(which);
+
+    QMutexLocker lock(&m_mutex);
+    if (!isRecording())
+        return; // Stopped (or restarting) while we waited for the lock.
+    Stage& st = m_stage;
+    if (st.bytes.size() + sizeof(hdr) + padded > st.bytes.capacity()) {
+        m_framesDropped.fetch_add(1, std::memory_order_relaxed); // Writer is stalled; never block RX.
+        return;
+    }
+
+    const size_t at = st.bytes.size();
+    st.bytes.resize(at + sizeof(hdr) + padded); // Within reserved capacity: no allocation.
+    std::memcpy(st.bytes.data() + at, &hdr, sizeof(hdr));
+    std::memcpy(st.bytes.data() + at + sizeof(hdr), data, size);
+    std::memset(st.bytes.data() + at + sizeof(hdr) + size, 0, padded - size);
+
+    if (st.frames++ == 0)
+        st.firstRxNs = rxNs;
+    st.lastRxNs = rxNs;
+
+    if (st.bytes.size() >= size_t(m_options.chunkBytes))
+        m_wake.wakeOne();
+}
+
+void FlightRecorder::writerLoop() {
+    QElapsedTimer sinceSync;
+    sinceSync.start();
+    bool unsynced = false;
+    bool ok = true;
+
+    QMutexLocker lock(&m_mutex);
+    for (;;) {
+        if (m_stage.frames == 0 && !m_stopping)
+            m_wake.wait(&m_mutex, ulong(m_options.flushIntervalMs));
+
+        if (m_stage.frames > 0) {
+            std::swap(m_stage, m_spare);
+            m_stage.bytes.clear();   // Keeps its capacity.
+            m_stage.frames = 0;
+
+            lock.unlock();
+            if (ok) {
+                ok = writeChunk(m_spare);
+                unsynced = true;
+            }
+            lock.relock();
+        }
+
+        const bool stopping = m_stopping && m_stage.frames == 0;
+        const bool syncDue =
+            unsynced && ok &&
+            (stopping || m_options.sync == SyncEveryChunk ||
+             (m_options.sync == SyncInterval && sinceSync.elapsed() >= m_options.syncIntervalMs));
+        if (syncDue) {
+            lock.unlock();
+            syncFiles();
+            lock.relock();
+            unsynced = false;
+            sinceSync.restart();
+        }
+
+        if (stopping)
+            break;
+    }
+    lock.unlock();
+
+    m_file.close();
+    m_index.close();
+}
+
+bool FlightRecorder::writeChunk(const Stage& stage) {
+    ChunkHeader ch {};
+    ch.magic        = kChunkMagic;
+    ch.frameCount   = stage.frames;
+    ch.payloadBytes = quint32(stage.bytes.size());
+    ch.firstRxNs    = stage.firstRxNs;
+    ch.lastRxNs     = stage.lastRxNs;
+
+    IndexEntry ie {};
+    ie.offset       = quint64(m_file.pos());
+    ie.firstRxNs    = stage.firstRxNs;
+    ie.lastRxNs     = stage.lastRxNs;
+    ie.frameCount   = stage.frames;
+    ie.payloadBytes = ch.payloadBytes;
+
+    const bool ok =
+        m_file.write(reinterpret_cast<const char*>(&ch), sizeof(ch)) == qint64(sizeof(ch)) &&
+        m_file.write(reinterpret_cast<const char*>(stage.bytes.data()), qint64(stage.bytes.size()))
+            == qint64(stage.bytes.size()) &&
+        m_file.flush() &&
+        m_index.write(reinterpret_cast<const char*>(&ie), sizeof(ie)) == qint64(sizeof(ie)) &&
+        m_index.flush();
+
+    if (!ok) {
+        const QString err = m_file.errorString();
+        QMetaObject::invokeMethod(this, [this, err] {
+            emit errorMessage(QStringLiteral("Recorder: write failed, recording stopped: %1").arg(err));
+            stop();
+        }, Qt::QueuedConnection);
+        m_recording.store(false, std::memory_order_release);
+        return false;
+    }
+
+    m_framesWritten.fetch_add(stage.frames, std::memory_order_relaxed);
+    m_bytesWritten.fetch_add(sizeof(ch) + stage.bytes.size(), std::memory_order_relaxed);
+    return true;
+}
+
+void FlightRecorder::syncFiles() {
+#ifdef Q_OS_UNIX
+    ::fsync(m_file.handle());
+    ::fsync(m_index.handle());
+#elif defined(Q_OS_WIN)
+    ::_commit(m_file.handle());
+    ::_commit(m_index.handle());
+#endif
+}
@@ -0,0 +1,58 @@
+#include "LatencyHistogram.h"
+#include <algorithm>
+
+void LatencyHistogram::bucketRange(int i, quint64* lo, quint64* hi)
+{
+    if (i < kLinearMax) {
+        *lo = *hi = quint64(i);
+        return;
+    }
+    const int j     = i - kLinearMax;
+    const int shift = j / kSubCount + 1;
+    const quint64 sub = quint64(j % kSubCount + kSubCount);
+    *lo = sub << shift;
+    *hi = ((sub + 1) << shift) - 1;
+}
+
+qint64 LatencyHistogram::percentile(double p) const
+{
+    if (m_count == 0)
+        return 0;
+    if (p >= 100.0)
+        return qint64(m_max);
+    p = std::max(p, 0.0);
+
+    // Rank of the sample we want (1-based), then walk the buckets up to it.
+    const quint64 rank = qMax<quint64>(1, quint64(p / 100.0 * double(m_count) + 0.5));
+    quint64 seen = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        seen += m_counts[i];
+        if (seen >= rank) {
+            quint64 lo = 0, hi = 0;
+            bucketRange(i, &lo, &hi);
+            return qint64(std::clamp(lo + (hi - lo) / 2, m_min, m_max));
+        }
+    }
+    return qint64(m_max);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other)
+{
+    if (other.m_count == 0)
+        return;
+    for (int i = 0; i < kBuckets; ++i)
+        m_counts[i] += other.m_counts[i];
+    m_count += other.m_count;
+    m_sum   += other.m_sum;
+    m_min    = std::min(m_min, other.m_min);
+    m_max    = std::max(m_max, other.m_max);
+}
+
+void LatencyHistogram::reset()
+{
+    m_counts.fill(0);
+    m_count = 0;
+    m_sum   = 0;
+    m_min   = std::numeric_limits<quint64>::max();
+    m_max   = 0;
+}
@@ -0,0 +1,232 @@
+#include "LatencyMonitor.h"
+#include "AllocCounter.h"
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QVariantMap>
+
+extern "C" {
+    #include "rp/codec.h"
+}
+
+namespace {
+constexpr size_t kMaxPending = 4096;  ///< Records awaiting a frame swap (≈ 4 s at 1 kHz).
+constexpr int    kPublishMs  = 1000;
+
+double toUs(qint64 ns) { return double(ns) / 1000.0; }
+}
+
+LatencyMonitor::LatencyMonitor(QObject* parent)
+    : QObject(parent), m_publishTimer(this)
+{
+    m_pending.reserve(kMaxPending);
+    m_publishTimer.setInterval(kPublishMs);
+    connect(&m_publishTimer, &QTimer::timeout, this, &LatencyMonitor::publish);
+    m_publishTimer.start();
+}
+
+QString LatencyMonitor::stageName(int stage)
+{
+    static const char* const kNames[StageCount] = { "link", "framing", "decode", "handoff", "render", "total" };
+    return (stage >= 0 && stage < StageCount) ? QString::fromLatin1(kNames[stage]) : QString();
+}
+
+void LatencyMonitor::setWindow(QQuickWindow* window)
+{
+    if (m_swapConn)
+        disconnect(m_swapConn);
+    m_window = window;
+    if (!window)
+        return;
+
+    // frameSwapped() fires on the render thread: stamp there, account on our thread.
+    m_swapConn = connect(window, &QQuickWindow::frameSwapped, this, [this]() {
+        const qint64 ns = monotonicNs();
+        QMetaObject::invokeMethod(this, [this, ns]() { onFrameShown(ns); }, Qt::QueuedConnection);
+    }, Qt::DirectConnection);
+}
+
+void LatencyMonitor::setSenderClockMonotonic(bool on)
+{
+    if (m_senderMonotonic == on)
+        return;
+    m_senderMonotonic = on;
+    m_all[Link].reset();
+    for (auto& set : m_links)
+        set[Link].reset();
+    m_dirty = true;
+    emit senderClockMonotonicChanged();
+}
+
+LatencyMonitor::StageSet& LatencyMonitor::forLink(int which)
+{
+    auto it = m_links.find(which);
+    if (it == m_links.end()) {
+        ULYSSES_ALLOC_EXEMPT(); // First frame of a link.
+        it = m_links.insert(which, StageSet());
+    }
+    return *it;
+}
+
+void LatencyMonitor::add(int which, int stage, qint64 ns)
+{
+    m_all[stage].record(ns);
+    forLink(which)[stage].record(ns);
+    m_dirty = true;
+}
+
+void LatencyMonitor::recordDecoded(const DownlinkRecord& rec)
+{
+    if (m_senderMonotonic && rec.status == RP_CODEC_OK) {
+        // Sender put its steady-clock ms in timestamp_ms; compare modulo 2^32 ms.
+        const quint32 sentMs = rec.downlink.which_payload == tvr_Downlink_telemetry_tag
+                             ? rec.downlink.payload.telemetry.timestamp_ms
+                             : rec.downlink.payload.status.timestamp_ms;
+        const qint32 deltaMs = qint32(quint32(rec.rxNs / 1000000) - sentMs);
+        add(rec.which, Link, qint64(deltaMs) * 1000000);
+    }
+    if (rec.framedNs)
+        add(rec.which, Framing, rec.framedNs - rec.rxNs);
+    if (rec.decodedNs && rec.framedNs)
+        add(rec.which, Decode, rec.decodedNs - rec.framedNs);
+
+    if (m_pending.size() >= kMaxPending) {
+        // No frame for a long time (hidden window, headless): forget the oldest.
+        const size_t drop = m_pending.size() / 2;
+        m_pending.erase(m_pending.begin(), m_pending.begin() + qsizetype(drop));
+        m_modeled = m_modeled > drop ? m_modeled - drop : 0;
+        m_unrenderedDropped += drop;
+    }
+    m_pending.push_back({ rec.which, rec.rxNs, rec.decodedNs, 0 });
+}
+
+void LatencyMonitor::modelUpdated(qint64 ns)
+{
+    for (size_t i = m_modeled; i < m_pending.size(); ++i) {
+        Pending& p = m_pending[i];
+        p.modelNs = ns;
+        if (p.decNs)
+            add(p.which, Handoff, ns - p.decNs);
+    }
+    m_modeled = m_pending.size();
+}
+
+void LatencyMonitor::onFrameShown(qint64 swapNs)
+{
+    if (m_modeled == 0)
+        return;
+    for (size_t i = 0; i < m_modeled; ++i) {
+        const Pending& p = m_pending[i];
+        add(p.which, Render, swapNs - p.modelNs);
+        add(p.which, Total, swapNs - p.rxNs);
+    }
+    m_pending.erase(m_pending.begin(), m_pending.begin() + qsizetype(m_modeled));
+    m_modeled = 0;
+}
+
+void LatencyMonitor::publish()
+{
+    if (!m_dirty)
+        return;
+    m_dirty = false;
+
+    QVariantList rows;
+    auto addRows = [&rows](int link, const StageSet& set) {
+        for (int s = 0; s < StageCount; ++s) {
+            const LatencyHistogram& h = set[s];
+            if (h.count() == 0)
+                continue;
+            QVariantMap row;
+            row["stage"]  = stageName(s);
+            row["link"]   = link;
+            row["count"]  = h.count();
+            row["p50Us"]  = toUs(h.percentile(50.0));
+            row["p99Us"]  = toUs(h.percentile(99.0));
+            row["maxUs"]  = toUs(h.max());
+            row["meanUs"] = h.mean() / 1000.0;
+            rows.append(row);
+        }
+    };
+    addRows(0, m_all);
+    for (auto it = m_links.cbegin(); it != m_links.cend(); ++it)
+        addRows(it.key(), it.value());
+
+    m_rows = rows;
+    emit updated();
+}
+
+QString LatencyMonitor::report() const
+{
+    QString out = QStringLiteral("%1 %2 %3 %4 %5 %6 %7\n")
+                      .arg(QStringLiteral("stage"), -8).arg(QStringLiteral("link"), 5)
+                      .arg(QStringLiteral("count"), 10).arg(QStringLiteral("p50 us"), 11)
+                      .arg(QStringLiteral("p99 us"), 11).arg(QStringLiteral("max us"), 11)
+                      .arg(QStringLiteral("mean us"), 11);
+    auto addRows = [&out](const QString& link, const StageSet& set) {
+        for (int s = 0; s < StageCount; ++s) {
+            const LatencyHistogram& h = set[s];
+            if (h.count() == 0)
+                continue;
+            out += QStringLiteral("%1 %2 %3 %4 %5 %6 %7\n")
+                       .arg(stageName(s), -8).arg(link, 5).arg(h.count(), 10)
+                       .arg(toUs(h.percentile(50.0)), 11, 'f', 1).arg(toUs(h.percentile(99.0)), 11, 'f', 1)
+                       .arg(toUs(h.max()), 11, 'f', 1).arg(h.mean() / 1000.0, 11, 'f', 1);
+        }
+    };
+    addRows(QStringLiteral("all"), m_all);
+    for (auto it = m_links.cbegin(); it != m_links.cend(); ++it)
+        addRows(QString::number(it.key()), it.value());
+    return out;
+}
+
+bool LatencyMonitor::dump(const QString& path) const
+{
+    auto toJson = [](const StageSet& set) {
+        QJsonObject stages;
+        for (int s = 0; s < StageCount; ++s) {
+            const LatencyHistogram& h = set[s];
+            if (h.count() == 0)
+                continue;
+            QJsonObject o;
+            o["count"]   = double(h.count());
+            o["min_ns"]  = double(h.min());
+            o["p50_ns"]  = double(h.percentile(50.0));
+            o["p90_ns"]  = double(h.percentile(90.0));
+            o["p99_ns"]  = double(h.percentile(99.0));
+            o["p999_ns"] = double(h.percentile(99.9));
+            o["max_ns"]  = double(h.max());
+            o["mean_ns"] = h.mean();
+            stages[stageName(s)] = o;
+        }
+        return stages;
+    };
+
+    QJsonObject links;
+    for (auto it = m_links.cbegin(); it != m_links.cend(); ++it)
+        links[QString::number(it.key())] = toJson(it.value());
+
+    QJsonObject root;
+    root["sender_clock_monotonic"] = m_senderMonotonic;
+    root["unrendered_dropped"]     = double(m_unrenderedDropped);
+    root["all"]   = toJson(m_all);
+    root["links"] = links;
+
+    QFile f(path);
+    if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    const QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Indented);
+    return f.write(json) == json.size();
+}
+
+void LatencyMonitor::reset()
+{
+    for (auto& h : m_all)
+        h.reset();
+    m_links.clear();
+    m_pending.clear();
+    m_modeled = 0;
+    m_unrenderedDropped = 0;
+    m_dirty = true;
+    publish();
+}
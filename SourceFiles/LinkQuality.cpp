@@ -0,0 +1,208 @@
+#include "LinkQuality.h"
+#include <QVariantList>
+#include <algorithm>
+#include <cmath>
+
+extern "C" {
+    #include "rp/codec.h"
+}
+
+namespace {
+constexpr qint32 kMaxTelemetryGapMs = 60000;  ///< Longer silences (or resets) relearn instead of counting.
+constexpr int    kRelearnStreak     = 8;      ///< Same-sized "gaps" in a row mean a new send rate.
+
+double ratio(quint64 num, quint64 den) { return den ? double(num) / double(den) : 0.0; }
+}
+
+void LinkQuality::Counters::add(const Counters& o, int sign)
+{
+    auto f = [sign](quint64& a, quint64 b) { a = sign > 0 ? a + b : a - b; };
+    f(frames, o.frames);
+    f(bytes, o.bytes);
+    f(decodeOk, o.decodeOk);
+    f(decodeErrors, o.decodeErrors);
+    f(missedTelemetry, o.missedTelemetry);
+    f(downlinkSent, o.downlinkSent);
+    f(downlinkReceived, o.downlinkReceived);
+    f(uplinkSent, o.uplinkSent);
+    f(uplinkReceived, o.uplinkReceived);
+}
+
+void LinkQuality::reset()
+{
+    *this = LinkQuality();
+}
+
+void LinkQuality::advance(qint64 nowNs)
+{
+    const qint64 bucket = nowNs / kBucketNs;
+    if (m_bucket < 0) {
+        m_bucket  = bucket;
+        m_firstNs = nowNs;
+        return;
+    }
+    if (bucket <= m_bucket)
+        return;
+
+    if (bucket - m_bucket >= kSlots) {
+        // Silent for longer than the ring: every window is empty again.
+        m_slots.fill(Counters());
+        m_windows.fill(Counters());
+        m_bucket = bucket;
+        return;
+    }
+    while (m_bucket < bucket) {
+        ++m_bucket;
+        for (int w = 0; w < kWindowCount; ++w) {
+            const qint64 leaving = m_bucket - qint64(kWindowSec[size_t(w)]) * kBucketsPerSec;
+            m_windows[size_t(w)].add(m_slots[size_t(leaving & (kSlots - 1))], -1);
+        }
+        m_slots[size_t(m_bucket & (kSlots - 1))] = Counters();
+    }
+}
+
+void LinkQuality::onBytes(quint64 n, qint64 nowNs)
+{
+    advance(nowNs);
+    bump([n](Counters& c) { c.bytes += n; });
+}
+
+void LinkQuality::onFrame(qint64 nowNs)
+{
+    advance(nowNs);
+    bump([](Counters& c) { ++c.frames; });
+    ++m_framesSinceStatus;
+}
+
+void LinkQuality::onUplinkFrame(qint64 nowNs)
+{
+    advance(nowNs);
+    ++m_uplinkSinceStatus;
+}
+
+void LinkQuality::onDecoded(int status, const tvr_Downlink& msg, qint64 nowNs)
+{
+    advance(nowNs);
+    if (status != RP_CODEC_OK) {
+        bump([](Counters& c) { ++c.decodeErrors; });
+        ++m_errorsByStatus[size_t(std::clamp(status < 0 ? -status : status, 0, int(m_errorsByStatus.size()) - 1))];
+        return;
+    }
+    bump([](Counters& c) { ++c.decodeOk; });
+
+    if (msg.which_payload == tvr_Downlink_telemetry_tag)
+        onTelemetry(msg.payload.telemetry.timestamp_ms);
+    else if (msg.which_payload == tvr_Downlink_status_tag)
+        onStatus(msg.payload.status);
+}
+
+void LinkQuality::onTelemetry(quint32 timestampMs)
+{
+    if (!m_haveTelemetry) {
+        m_haveTelemetry = true;
+        m_lastTelemetryMs = timestampMs;
+        return;
+    }
+    const qint32 d = qint32(timestampMs - m_lastTelemetryMs);
+    m_lastTelemetryMs = timestampMs;
+    if (d <= 0 || d > kMaxTelemetryGapMs)
+        return; // Reordered, duplicated (diversity) or the rocket restarted.
+
+    if (m_periodMs <= 0.0) {
+        m_periodMs = d;
+        return;
+    }
+    if (d <= 1.5 * m_periodMs) {
+        m_periodMs += 0.1 * (d - m_periodMs);
+        m_gapStreak = 0;
+        return;
+    }
+
+    // A jump: count the messages that should have filled it, unless the rate changed.
+    m_gapStreak = (std::abs(d - m_lastGapMs) * 10 <= d) ? m_gapStreak + 1 : 1;
+    m_lastGapMs = d;
+    if (m_gapStreak >= kRelearnStreak) {
+        m_periodMs = d;
+        m_gapStreak = 0;
+        return;
+    }
+    const quint64 missed = quint64(std::llround(d / m_periodMs)) - 1;
+    if (missed > 0)
+        bump([missed](Counters& c) { c.missedTelemetry += missed; });
+}
+
+void LinkQuality::onStatus(const tvr_SystemStatus& s)
+{
+    if (m_haveStatus) {
+        const quint32 tx = s.radio_tx_count - m_lastRadioTx;
+        const quint32 rx = s.radio_rx_count - m_lastRadioRx;
+        // Counters that went backwards mean a rocket reboot: start a fresh span.
+        if (s.radio_tx_count >= m_lastRadioTx && s.radio_rx_count >= m_lastRadioRx) {
+            const quint64 got = m_framesSinceStatus;
+            const quint64 up  = m_uplinkSinceStatus;
+            bump([tx, rx, got, up](Counters& c) {
+                c.downlinkSent     += tx;
+                c.downlinkReceived += got;
+                c.uplinkSent       += up;
+                c.uplinkReceived   += rx;
+            });
+        }
+    }
+    m_haveStatus = true;
+    m_lastRadioTx = s.radio_tx_count;
+    m_lastRadioRx = s.radio_rx_count;
+    m_framesSinceStatus = 0;
+    m_uplinkSinceStatus = 0;
+}
+
+QVariantMap LinkQuality::summary(qint64 nowNs)
+{
+    if (m_bucket >= 0)
+        advance(nowNs);
+
+    auto toMap = [](const Counters& c, double spanS) {
+        const quint64 decoded = c.decodeOk + c.decodeErrors;
+        const double  dnLoss  = c.downlinkSent > c.downlinkReceived ? 1.0 - ratio(c.downlinkReceived, c.downlinkSent) : 0.0;
+        const double  upLoss  = c.uplinkSent > c.uplinkReceived ? 1.0 - ratio(c.uplinkReceived, c.uplinkSent) : 0.0;
+        return QVariantMap {
+            { QStringLiteral("framesPerSec"),     spanS > 0 ? double(c.frames) / spanS : 0.0 },
+            { QStringLiteral("bytesPerSec"),      spanS > 0 ? double(c.bytes) / spanS : 0.0 },
+            { QStringLiteral("frames"),           c.frames },
+            { QStringLiteral("decodeOk"),         c.decodeOk },
+            { QStringLiteral("decodeErrors"),     c.decodeErrors },
+            { QStringLiteral("decodeErrorRate"),  ratio(c.decodeErrors, decoded) },
+            { QStringLiteral("missedTelemetry"),  c.missedTelemetry },
+            { QStringLiteral("downlinkSent"),     c.downlinkSent },
+            { QStringLiteral("downlinkReceived"), c.downlinkReceived },
+            { QStringLiteral("downlinkLoss"),     dnLoss },
+            { QStringLiteral("uplinkSent"),       c.uplinkSent },
+            { QStringLiteral("uplinkReceived"),   c.uplinkReceived },
+            { QStringLiteral("uplinkLoss"),       upLoss },
+        };
+    };
+
+    // A window spans its full buckets plus the elapsed part of the current one, but never
+    // more than the time since the first sample.
+    const double alive = m_bucket >= 0 ? double(nowNs - m_firstNs) * 1e-9 : 0.0;
+    const double partial = double(nowNs % kBucketNs) * 1e-9;
+    QVariantList windows;
+    for (int w = 0; w < kWindowCount; ++w) {
+        const int sec = kWindowSec[size_t(w)];
+        const double span = std::min(double(sec) - double(kBucketNs) * 1e-9 + partial, alive);
+        QVariantMap m = toMap(m_windows[size_t(w)], span);
+        m.insert(QStringLiteral("windowS"), sec);
+        windows.append(m);
+    }
+
+    QVariantMap errors;
+    for (size_t i = 0; i < m_errorsByStatus.size(); ++i)
+        if (m_errorsByStatus[i])
+            errors.insert(QString::number(i), m_errorsByStatus[i]);
+
+    return QVariantMap {
+        { QStringLiteral("windows"),        windows },
+        { QStringLiteral("total"),          toMap(m_total, alive) },
+        { QStringLiteral("errorsByStatus"), errors },
+        { QStringLiteral("telemetryPeriodMs"), m_periodMs },
+    };
+}
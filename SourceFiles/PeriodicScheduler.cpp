@@ -0,0 +1,274 @@
+#include "PeriodicScheduler.h"
+#include "DownlinkRecord.h"
+#include "SerialBridge.h"
+#include <QThread>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace {
+constexpr int    kPublishMs  = 1000;
+constexpr size_t kKeepStopped = 16;    ///< Stopped streams kept for their final statistics.
+constexpr double kMaxHz      = 10000.0;
+
+double toUs(qint64 ns) { return double(ns) / 1000.0; }
+}
+
+PeriodicScheduler::PeriodicScheduler(SerialBridge* bridge, QObject* parent)
+    : QObject(parent), m_bridge(bridge), m_post(bridge), m_publishTimer(this)
+{
+    m_publishTimer.setInterval(kPublishMs);
+    connect(&m_publishTimer, &QTimer::timeout, this, &PeriodicScheduler::publish);
+    m_publishTimer.start();
+
+    // A link that goes away takes its streams with it.
+    if (bridge) {
+        connect(bridge, &SerialBridge::connectedChanged, this, [this](int which, bool connected) {
+            if (!connected)
+                stopLink(which);
+        });
+    }
+
+    m_thread = QThread::create([this] { run(); });
+    m_thread->setObjectName(QStringLiteral("TxScheduler"));
+    m_thread->start(QThread::TimeCriticalPriority);
+}
+
+PeriodicScheduler::~PeriodicScheduler()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_wake.notify_all();
+    m_thread->wait();
+    delete m_thread;
+}
+
+// -----------------------
+// Stream control (GUI thread)
+// -----------------------
+
+int PeriodicScheduler::startText(int which, const QString& text, double hz)
+{
+    QString line = text;
+    if (!line.endsWith('\n'))
+        line.append('\n'); // Same normalization as SerialBridge::sendText().
+    return start(which, line.toUtf8(), true, hz);
+}
+
+int PeriodicScheduler::startBinary(int which, const QByteArray& data, double hz)
+{
+    return start(which, data, false, hz);
+}
+
+int PeriodicScheduler::start(int which, const QByteArray& payload, bool text, double hz, int priority,
+                             const QString& label)
+{
+    if (!m_bridge || !m_bridge->isConnected(which) || payload.isEmpty() || !(hz > 0.0) || hz > kMaxHz)
+        return 0;
+
+    auto s = std::make_unique<Stream>();
+    s->which = which;
+    s->payload = payload;
+    s->text = text;
+    s->priority = priority;
+    s->hz = hz;
+    s->label = !label.isEmpty() ? label
+             : text ? QString::fromUtf8(payload).trimmed()
+                    : QStringLiteral("%1 bytes").arg(payload.size());
+    s->startNs = monotonicNs();
+    s->nextNs = s->startNs; // First tick goes out right away.
+
+    int id;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        id = m_nextId++;
+        s->id = id;
+        s->key = "periodic" + QByteArray::number(id);
+        pruneStopped();
+        m_streams.push_back(std::move(s));
+    }
+    m_wake.notify_all();
+    publish();
+    return id;
+}
+
+void PeriodicScheduler::stop(int id)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& s : m_streams) {
+            if (s->id == id && s->running) {
+                s->running = false;
+                s->stopNs = monotonicNs();
+            }
+        }
+    }
+    publish();
+}
+
+void PeriodicScheduler::stopLink(int which)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const qint64 now = monotonicNs();
+        for (auto& s : m_streams) {
+            if (s->which == which && s->running) {
+                s->running = false;
+                s->stopNs = now;
+            }
+        }
+    }
+    publish();
+}
+
+void PeriodicScheduler::stopAll()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const qint64 now = monotonicNs();
+        for (auto& s : m_streams) {
+            if (s->running) {
+                s->running = false;
+                s->stopNs = now;
+            }
+        }
+    }
+    publish();
+}
+
+bool PeriodicScheduler::isRunning(int id) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::any_of(m_streams.begin(), m_streams.end(),
+                       [id](const std::unique_ptr<Stream>& s) { return s->id == id && s->running; });
+}
+
+bool PeriodicScheduler::sendsPackets() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return std::any_of(m_streams.begin(), m_streams.end(), [](const std::unique_ptr<Stream>& s) {
+        return s->running && !s->text;
+    });
+}
+
+void PeriodicScheduler::pruneStopped()
+{
+    size_t stopped = size_t(std::count_if(m_streams.begin(), m_streams.end(),
+                                          [](const std::unique_ptr<Stream>& s) { return !s->running; }));
+    for (auto it = m_streams.begin(); it != m_streams.end() && stopped >= kKeepStopped;) {
+        if (!(*it)->running) {
+            it = m_streams.erase(it);
+            --stopped;
+        } else {
+            ++it;
+        }
+    }
+}
+
+// -----------------------
+// Timing thread
+// -----------------------
+
+void PeriodicScheduler::run()
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct Due { int which; int priority; bool text; QByteArray payload; QByteArray key; };
+    std::vector<Due> due;
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_quit) {
+        qint64 earliest = std::numeric_limits<qint64>::max();
+        for (const auto& s : m_streams)
+            if (s->running)
+                earliest = std::min(earliest, s->nextNs);
+
+        if (earliest == std::numeric_limits<qint64>::max()) {
+            m_wake.wait(lock);
+            continue;
+        }
+        if (monotonicNs() < earliest) {
+            // Absolute deadline: an early or spurious wake-up just loops around.
+            m_wake.wait_until(lock, Clock::time_point(
+                std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds(earliest))));
+            continue;
+        }
+
+        const qint64 now = monotonicNs();
+        for (auto& s : m_streams) {
+            if (!s->running || s->nextNs > now)
+                continue;
+            s->lateness.record(now - s->nextNs);
+            ++s->sent;
+            due.push_back({ s->which, s->priority, s->text, s->payload, s->key });
+
+            // Next slot after now; slots that already passed are skipped, not burst out.
+            ++s->slot;
+            qint64 next = slotTime(*s, s->slot);
+            if (next <= now) {
+                const quint64 behind = quint64(double(now - s->startNs) * s->hz / 1e9) + 1;
+                s->missed += behind - s->slot;
+                s->slot = behind;
+                next = slotTime(*s, s->slot);
+            }
+            s->nextNs = next;
+        }
+
+        // Hand off without holding the lock; payloads are implicitly shared, not copied.
+        lock.unlock();
+        for (const Due& d : due)
+            m_post->post(d.which, d.payload, d.text, d.priority, d.key);
+        due.clear();
+        lock.lock();
+    }
+}
+
+// -----------------------
+// Statistics
+// -----------------------
+
+QVariantMap PeriodicScheduler::rowOf(const Stream& s, qint64 nowNs) const
+{
+    const qint64 endNs = s.running ? nowNs : s.stopNs;
+    const double elapsedS = double(endNs - s.startNs) * 1e-9;
+    return QVariantMap {
+        { QStringLiteral("id"),            s.id },
+        { QStringLiteral("which"),         s.which },
+        { QStringLiteral("text"),          s.text },
+        { QStringLiteral("label"),         s.label },
+        { QStringLiteral("running"),       s.running },
+        { QStringLiteral("hz"),            s.hz },
+        { QStringLiteral("sent"),          s.sent },
+        { QStringLiteral("missed"),        s.missed },
+        { QStringLiteral("achievedHz"),    elapsedS > 0 ? double(s.sent) / elapsedS : 0.0 },
+        { QStringLiteral("latenessP50Us"), toUs(s.lateness.percentile(50.0)) },
+        { QStringLiteral("latenessP99Us"), toUs(s.lateness.percentile(99.0)) },
+        { QStringLiteral("latenessMaxUs"), toUs(s.lateness.max()) },
+    };
+}
+
+QVariantMap PeriodicScheduler::stats(int id) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const auto& s : m_streams)
+        if (s->id == id)
+            return rowOf(*s, monotonicNs());
+    return QVariantMap();
+}
+
+void PeriodicScheduler::publish()
+{
+    QVariantList rows;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const qint64 now = monotonicNs();
+        for (const auto& s : m_streams)
+            rows.append(rowOf(*s, now));
+    }
+    if (rows.isEmpty() && m_rows.isEmpty())
+        return;
+    m_rows = rows;
+    emit streamsChanged();
+}
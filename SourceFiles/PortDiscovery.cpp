@@ -0,0 +1,362 @@
+#include "PortDiscovery.h"
+#include <QFileInfo>
+#include <QSerialPort>
+#include <QSocketNotifier>
+#include <algorithm>
+#include <cstring>
+
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+/// False while the device node still lacks the permissions udev is about to give it.
+bool accessible(const QSerialPortInfo& info) {
+#ifdef Q_OS_UNIX
+    const QFileInfo node(info.systemLocation());
+    return node.isReadable() && node.isWritable();
+#else
+    Q_UNUSED(info);
+    return true;
+#endif
+}
+
+} // namespace
+
+PortDiscovery::PortDiscovery(QObject* parent) : QObject(parent) {}
+
+PortDiscovery::~PortDiscovery() {
+#ifdef Q_OS_LINUX
+    if (m_inotifyFd >= 0)
+        ::close(m_inotifyFd);
+#endif
+}
+
+PortDiscovery::Verdict PortDiscovery::classify(const QSerialPortInfo& info) {
+    const auto vid = info.vendorIdentifier();
+    const auto pid = info.productIdentifier();
+    const QString desc = info.description().toLower();
+    const QString mfg = info.manufacturer().toLower();
+
+    // Quickly reject typical Bluetooth virtual COM ports.
+    if (desc.contains("bluetooth") || mfg.contains("bluetooth"))
+        return NotRadio;
+
+    // Known USB–UART bridge IDs commonly used for RFD/SiK radios.
+    if ((vid == 0x0403 && pid == 0x6001) ||   // FTDI FT232R
+        (vid == 0x10C4 && pid == 0xEA60)) {   // SiLabs CP210x
+        return Radio;
+    }
+
+    // Fuzzy match against common USB–UART manufacturer strings.
+    if (desc.contains("ftdi") || desc.contains("silicon labs") ||
+        mfg.contains("ftdi")  || mfg.contains("silicon labs"))
+        return Radio;
+
+    // Other USB serial devices may still be radios (CH340, PL2303, CDC-ACM...): probe them.
+    // Built-in UARTs are left alone.
+    return info.hasVendorIdentifier() ? Unknown : NotRadio;
+}
+
+QString PortDiscovery::cacheKey(const QSerialPortInfo& info) {
+    if (!info.serialNumber().isEmpty())
+        return info.serialNumber();
+    return QStringLiteral("%1:%2@%3").arg(info.vendorIdentifier(), 4, 16, QLatin1Char('0'))
+                                      .arg(info.productIdentifier(), 4, 16, QLatin1Char('0'))
+                                      .arg(info.systemLocation());
+}
+
+void PortDiscovery::start() {
+    m_settle.setSingleShot(true);
+    m_settle.setInterval(kSettleMs);
+    connect(&m_settle, &QTimer::timeout, this, &PortDiscovery::rescan);
+
+#ifdef Q_OS_LINUX
+    m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (m_inotifyFd >= 0 &&
+        inotify_add_watch(m_inotifyFd, "/dev",
+                          IN_CREATE | IN_DELETE | IN_ATTRIB | IN_MOVED_TO | IN_MOVED_FROM) >= 0) {
+        m_devNotifier = new QSocketNotifier(m_inotifyFd, QSocketNotifier::Read, this);
+        connect(m_devNotifier, &QSocketNotifier::activated, this, &PortDiscovery::onDevEvent);
+    } else if (m_inotifyFd >= 0) {
+        ::close(m_inotifyFd);
+        m_inotifyFd = -1;
+    }
+#endif
+
+    if (!m_devNotifier) {
+        m_poll.setInterval(kPollMs);
+        connect(&m_poll, &QTimer::timeout, this, &PortDiscovery::rescan);
+        m_poll.start();
+    }
+    rescan();
+}
+
+void PortDiscovery::onDevEvent() {
+#ifdef Q_OS_LINUX
+    // Only tty nodes matter; /dev sees plenty of unrelated churn.
+    alignas(struct inotify_event) char buf[4096];
+    bool relevant = false;
+    for (;;) {
+        const ssize_t n = ::read(m_inotifyFd, buf, sizeof(buf));
+        if (n <= 0)
+            break;
+        for (ssize_t off = 0; off < n; ) {
+            const auto* ev = reinterpret_cast<const struct inotify_event*>(buf + off);
+            if (ev->len > 0 && (std::strncmp(ev->name, "tty", 3) == 0 ||
+                                std::strncmp(ev->name, "rfcomm", 6) == 0))
+                relevant = true;
+            off += ssize_t(sizeof(struct inotify_event) + ev->len);
+        }
+    }
+    if (relevant)
+        m_settle.start(); // udev creates, renames and chmods in a burst; scan once after it.
+#endif
+}
+
+void PortDiscovery::rescan() {
+    QSet<QString> present;
+    for (const QSerialPortInfo& info : QSerialPortInfo::availablePorts()) {
+        const QString name = info.portName();
+        present.insert(name);
+        if (m_reported.contains(name))
+            continue;
+        if (std::any_of(m_probes.begin(), m_probes.end(),
+                        [&name](const std::unique_ptr<Probe>& p) { return p->name == name; }))
+            continue;
+
+        const QString key = cacheKey(info);
+        if (isBusy(name)) {
+            report(name, info.serialNumber(), m_cache.value(key).ident); // Ours: no probing.
+            continue;
+        }
+
+        const Verdict verdict = classify(info);
+        if (verdict == NotRadio || !accessible(info))
+            continue; // Not a radio, or not usable yet (its IN_ATTRIB brings us back).
+        if (verdict == Radio) {
+            report(name, info.serialNumber(), m_cache.value(key).ident);
+            continue;
+        }
+
+        const auto cached = m_cache.constFind(key);
+        if (cached == m_cache.cend())
+            startProbe(info, key);
+        else if (cached->radio)
+            report(name, info.serialNumber(), cached->ident);
+    }
+
+    // Unplugged: stop probing it and unlist it.
+    for (const QString& name : std::as_const(m_seen)) {
+        if (present.contains(name))
+            continue;
+        for (size_t i = 0; i < m_probes.size(); ++i) {
+            if (m_probes[i]->name == name) {
+                abortProbe(i);
+                break;
+            }
+        }
+        if (m_reported.remove(name))
+            emit portRemoved(name);
+    }
+    m_seen = present;
+}
+
+bool PortDiscovery::setBusyPorts(const QStringList& names) {
+    bool free = true;
+    {
+        QMutexLocker lock(&m_busyMutex);
+        m_busy = QSet<QString>(names.cbegin(), names.cend());
+        for (const QString& name : names)
+            free = free && !m_probing.contains(name);
+    }
+    if (!free) // The application wants it: give it back as soon as that is safe.
+        QMetaObject::invokeMethod(this, &PortDiscovery::releaseBusy, Qt::QueuedConnection);
+    return free;
+}
+
+bool PortDiscovery::isBusy(const QString& name) const {
+    QMutexLocker lock(&m_busyMutex);
+    return m_busy.contains(name);
+}
+
+void PortDiscovery::releaseBusy() {
+    for (size_t i = 0; i < m_probes.size(); ) {
+        const size_t before = m_probes.size();
+        if (m_probes[i]->stage != 3 && isBusy(m_probes[i]->name))
+            abortProbe(i);
+        if (m_probes.size() == before)
+            ++i;
+    }
+}
+
+void PortDiscovery::clearCache() {
+    m_cache.clear();
+}
+
+void PortDiscovery::report(const QString& name, const QString& serial, const QString& ident) {
+    m_reported.insert(name, serial);
+    emit portAdded(name, serial, ident);
+}
+
+// -----------------------
+// AT probe
+// -----------------------
+
+void PortDiscovery::startProbe(const QSerialPortInfo& info, const QString& key) {
+    {
+        // Claimed by the application since rescan() looked: leave it alone.
+        QMutexLocker lock(&m_busyMutex);
+        if (m_busy.contains(info.portName()))
+            return;
+        m_probing.insert(info.portName());
+    }
+
+    auto p = std::make_unique<Probe>();
+    p->name = info.portName();
+    p->key = key;
+    p->serial = info.serialNumber();
+    p->port = new QSerialPort(info, this);
+    p->port->setBaudRate(kProbeBaud);
+    p->port->setDataBits(QSerialPort::Data8);
+    p->port->setParity(QSerialPort::NoParity);
+    p->port->setStopBits(QSerialPort::OneStop);
+    p->port->setFlowControl(QSerialPort::NoFlowControl);
+    if (!p->port->open(QIODevice::ReadWrite)) {
+        delete p->port; // In use elsewhere or not accessible yet: no verdict, try next scan.
+        QMutexLocker lock(&m_busyMutex);
+        m_probing.remove(info.portName());
+        return;
+    }
+
+    p->timer = new QTimer(this);
+    p->timer->setSingleShot(true);
+    QSerialPort* port = p->port;
+    connect(port, &QIODevice::readyRead, this, [this, port] {
+        if (Probe* q = probeFor(port))
+            advanceProbe(q, false);
+    });
+    connect(p->timer, &QTimer::timeout, this, [this, port] {
+        if (Probe* q = probeFor(port))
+            advanceProbe(q, true);
+    });
+
+    p->timer->start(kGuardMs); // "+++" is only recognised after a quiet guard time.
+    m_probes.push_back(std::move(p));
+}
+
+PortDiscovery::Probe* PortDiscovery::probeFor(QSerialPort* port) {
+    for (const auto& p : m_probes)
+        if (p->port == port)
+            return p.get();
+    return nullptr;
+}
+
+void PortDiscovery::advanceProbe(Probe* p, bool timedOut) {
+    if (!timedOut) {
+        if (p->stage == 0 || p->stage == 3) {
+            p->port->readAll(); // Whatever a radio was already streaming; not an answer.
+            return;
+        }
+        p->reply += p->port->readAll();
+    }
+
+    switch (p->stage) {
+    case 0:
+        p->port->write("+++");
+        p->sinceEscape.start();
+        p->stage = 1;
+        p->timer->start(kEscapeTimeoutMs);
+        break;
+
+    case 1:
+        if (p->reply.contains("OK")) {
+            p->reply.clear();
+            p->port->write("ATI\r\n");
+            p->stage = 2;
+            p->timer->start(kIdentTimeoutMs);
+        } else if (timedOut) {
+            finishProbe(p, false);
+        }
+        break;
+
+    case 2:
+        // Echo plus banner line, or whatever arrived before the timeout.
+        if (timedOut || p->reply.count('\n') >= 2)
+            finishProbe(p, true);
+        break;
+
+    case 3:
+        // Interrupted after "+++": the guard time is over, a radio is in command mode now.
+        p->stage = 2;
+        abortProbe(size_t(std::find_if(m_probes.begin(), m_probes.end(),
+                                       [p](const std::unique_ptr<Probe>& x) { return x.get() == p; })
+                          - m_probes.begin()));
+        break;
+    }
+}
+
+void PortDiscovery::finishProbe(Probe* p, bool radio) {
+    Verdicts v;
+    v.radio = radio;
+    if (radio) {
+        for (const QByteArray& line : p->reply.split('\n')) {
+            const QByteArray t = line.trimmed();
+            if (!t.isEmpty() && t != "ATI" && t != "OK") {
+                v.ident = QString::fromLatin1(t);
+                break;
+            }
+        }
+    }
+    m_cache.insert(p->key, v);
+
+    const QString name = p->name;
+    const QString serial = p->serial;
+    const auto it = std::find_if(m_probes.begin(), m_probes.end(),
+                                 [p](const std::unique_ptr<Probe>& x) { return x.get() == p; });
+    // No "OK" well after the guard time: nothing is in command mode, just let go.
+    if (radio)
+        abortProbe(size_t(it - m_probes.begin()));
+    else
+        closeProbe(size_t(it - m_probes.begin()));
+
+    if (radio)
+        report(name, serial, v.ident);
+}
+
+void PortDiscovery::abortProbe(size_t index) {
+    Probe* p = m_probes[index].get();
+    if (p->stage == 1 && p->port->isOpen()) {
+        // "+++" is out but the radio only switches once the guard time has passed. Any byte
+        // now could be sent over the air; wait it out, then send ATO (stage 3 → stage 2).
+        const qint64 left = kGuardMs + 100 - p->sinceEscape.elapsed();
+        if (left > 0) {
+            p->stage = 3;
+            p->timer->start(int(left));
+            return;
+        }
+        p->stage = 2;
+    }
+    if (p->stage == 3)
+        return; // Already waiting to release it.
+    if (p->stage == 2 && p->port->isOpen()) {
+        // It may be in command mode: back to data mode before anyone opens it for real.
+        p->port->write("ATO\r\n");
+        p->port->waitForBytesWritten(50);
+    }
+    closeProbe(index);
+}
+
+void PortDiscovery::closeProbe(size_t index) {
+    Probe* p = m_probes[index].get();
+    {
+        QMutexLocker lock(&m_busyMutex);
+        m_probing.remove(p->name);
+    }
+    p->port->close();
+    p->port->deleteLater();
+    p->timer->deleteLater();
+    m_probes.erase(m_probes.begin() + qsizetype(index));
+}
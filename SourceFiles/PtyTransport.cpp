@@ -0,0 +1,106 @@
+#include "PtyTransport.h"
+#include <QSocketNotifier>
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+PtyTransport::PtyTransport(QObject* parent) : Transport(parent) {}
+
+PtyTransport::~PtyTransport() {
+    close();
+}
+
+bool PtyTransport::open() {
+    close();
+#ifdef Q_OS_UNIX
+    m_master = ::posix_openpt(O_RDWR | O_NOCTTY);
+    if (m_master < 0 || ::grantpt(m_master) != 0 || ::unlockpt(m_master) != 0) {
+        m_error = QString::fromLocal8Bit(std::strerror(errno));
+        close();
+        return false;
+    }
+    m_slavePath = QString::fromLocal8Bit(::ptsname(m_master));
+
+    // Raw mode on the line discipline: binary COBS frames must pass through untouched.
+    m_slave = ::open(::ptsname(m_master), O_RDWR | O_NOCTTY);
+    if (m_slave >= 0) {
+        termios tio;
+        if (::tcgetattr(m_slave, &tio) == 0) {
+            ::cfmakeraw(&tio);
+            ::tcsetattr(m_slave, TCSANOW, &tio);
+        }
+    }
+    ::fcntl(m_master, F_SETFL, ::fcntl(m_master, F_GETFL) | O_NONBLOCK);
+
+    m_notifier = new QSocketNotifier(m_master, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &Transport::readyRead);
+
+    m_writeNotifier = new QSocketNotifier(m_master, QSocketNotifier::Write, this);
+    m_writeNotifier->setEnabled(false);
+    connect(m_writeNotifier, &QSocketNotifier::activated, this, [this] {
+        m_writeNotifier->setEnabled(false);
+        emit bytesWritten(0);
+    });
+    return true;
+#else
+    m_error = QStringLiteral("pseudo-terminals are only supported on Unix");
+    return false;
+#endif
+}
+
+void PtyTransport::close() {
+    delete m_notifier;
+    m_notifier = nullptr;
+    delete m_writeNotifier;
+    m_writeNotifier = nullptr;
+#ifdef Q_OS_UNIX
+    if (m_slave >= 0)
+        ::close(m_slave);
+    if (m_master >= 0)
+        ::close(m_master);
+#endif
+    m_slave = m_master = -1;
+    m_slavePath.clear();
+}
+
+qint64 PtyTransport::read(char* dst, qint64 max) {
+#ifdef Q_OS_UNIX
+    const ssize_t n = ::read(m_master, dst, size_t(max));
+    if (n >= 0)
+        return n;
+    if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+        return 0;
+    m_error = QString::fromLocal8Bit(std::strerror(errno));
+    return -1;
+#else
+    Q_UNUSED(dst); Q_UNUSED(max);
+    return -1;
+#endif
+}
+
+qint64 PtyTransport::write(const char* data, qint64 size) {
+#ifdef Q_OS_UNIX
+    const ssize_t n = ::write(m_master, data, size_t(size));
+    if (n >= 0) {
+        if (n < size && m_writeNotifier)
+            m_writeNotifier->setEnabled(true); // Tell the writer when the rest fits.
+        return n;
+    }
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        if (m_writeNotifier)
+            m_writeNotifier->setEnabled(true); // Peer is not reading; the pty buffer is full.
+        return 0;
+    }
+    m_error = QString::fromLocal8Bit(std::strerror(errno));
+    return -1;
+#else
+    Q_UNUSED(data); Q_UNUSED(size);
+    return -1;
+#endif
+}
@@ -0,0 +1,222 @@
+#include "RawPacketLogModel.h"
+extern "C" {
+    #include "rp/codec.h"
+}
+
+namespace {
+constexpr int kDefaultRetention = 5000;
+constexpr int kMinRetention     = 100;
+constexpr int kMaxRetention     = 1000000;
+}
+
+RawPacketLogModel::RawPacketLogModel(QObject* parent)
+    : QAbstractListModel(parent)
+    , m_ring(kDefaultRetention)
+    , m_view(kDefaultRetention)
+{
+}
+
+int RawPacketLogModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : count();
+}
+
+QVariant RawPacketLogModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() < 0 || index.row() >= count())
+        return {};
+
+    const DownlinkRecord& rec = recordAt(rowSeq(size_t(index.row())));
+    switch (role) {
+    case Qt::DisplayRole:
+        return formatRecord(rec); // Formatted only for rows the view asks for.
+    case KindRole:
+        if (rec.status != RP_CODEC_OK)
+            return QStringLiteral("ERROR");
+        return rec.downlink.which_payload == tvr_Downlink_status_tag ? QStringLiteral("STATUS")
+                                                                     : QStringLiteral("TELEM");
+    case RxTimeRole:
+        return double(rec.rxNs - m_epochNs) / 1e6;
+    default:
+        return {};
+    }
+}
+
+QHash<int, QByteArray> RawPacketLogModel::roleNames() const {
+    return {
+        { Qt::DisplayRole, "display" },
+        { KindRole,        "kind" },
+        { RxTimeRole,      "rxTime" },
+    };
+}
+
+bool RawPacketLogModel::matches(const DownlinkRecord& rec) const {
+    switch (m_filter) {
+    case TelemetryOnly: return rec.status == RP_CODEC_OK && rec.downlink.which_payload == tvr_Downlink_telemetry_tag;
+    case StatusOnly:    return rec.status == RP_CODEC_OK && rec.downlink.which_payload == tvr_Downlink_status_tag;
+    case ErrorsOnly:    return rec.status != RP_CODEC_OK;
+    default:            return true;
+    }
+}
+
+void RawPacketLogModel::append(const DownlinkRecord& rec) {
+    if (m_nextSeq == 0)
+        m_epochNs = rec.rxNs;
+
+    // Overwrite the oldest slot once the ring is full.
+    m_ring[m_nextSeq % m_ring.size()] = rec;
+    if (m_nextSeq - m_firstSeq == m_ring.size())
+        ++m_firstSeq;
+    ++m_nextSeq; // Filtered into rows by flush().
+}
+
+void RawPacketLogModel::flush() {
+    // Rows whose record was overwritten by this batch leave from the top.
+    size_t evicted = 0;
+    while (evicted < m_viewCount && rowSeq(evicted) < m_firstSeq)
+        ++evicted;
+    if (evicted) {
+        beginRemoveRows(QModelIndex(), 0, int(evicted) - 1);
+        m_viewHead = (m_viewHead + evicted) % m_view.size();
+        m_viewCount -= evicted;
+        endRemoveRows();
+    }
+
+    // Filter the staged records into the free slots behind the last row (invisible until
+    // the insert below). A burst longer than the ring may already have overwritten some.
+    // Rows and staged records together never outnumber the ring, so they always fit.
+    size_t inserted = 0;
+    for (quint64 seq = qMax(m_stagedSeq, m_firstSeq); seq < m_nextSeq; ++seq) {
+        if (matches(recordAt(seq)))
+            rowSeq(m_viewCount + inserted++) = seq;
+    }
+    m_stagedSeq = m_nextSeq;
+
+    if (inserted) {
+        const int first = count();
+        beginInsertRows(QModelIndex(), first, first + int(inserted) - 1);
+        m_viewCount += inserted;
+        endInsertRows();
+    }
+
+    if (evicted || inserted)
+        emit countChanged();
+}
+
+void RawPacketLogModel::clear() {
+    beginResetModel();
+    m_firstSeq = m_nextSeq;
+    m_stagedSeq = m_nextSeq;
+    m_viewHead = m_viewCount = 0;
+    endResetModel();
+    emit countChanged();
+}
+
+void RawPacketLogModel::rebuildView() {
+    m_viewHead = m_viewCount = 0;
+    for (quint64 seq = m_firstSeq; seq < m_nextSeq; ++seq) {
+        if (matches(recordAt(seq)))
+            m_view[m_viewCount++] = seq;
+    }
+    m_stagedSeq = m_nextSeq;
+}
+
+void RawPacketLogModel::setRetention(int packets) {
+    packets = qBound(kMinRetention, packets, kMaxRetention);
+    if (size_t(packets) == m_ring.size())
+        return;
+
+    // Keep the newest records that still fit, re-slotted for the new ring size.
+    const quint64 keep = qMin<quint64>(m_nextSeq - m_firstSeq, quint64(packets));
+    std::vector<DownlinkRecord> ring(size_t(packets));
+    for (quint64 seq = m_nextSeq - keep; seq < m_nextSeq; ++seq)
+        ring[seq % ring.size()] = recordAt(seq);
+
+    beginResetModel();
+    m_ring.swap(ring);
+    m_view.assign(size_t(packets), 0);
+    m_firstSeq = m_nextSeq - keep;
+    rebuildView();
+    endResetModel();
+
+    emit retentionChanged();
+    emit countChanged();
+}
+
+void RawPacketLogModel::setFilter(int filter) {
+    if (filter < AllPackets || filter > ErrorsOnly || filter == m_filter)
+        return;
+
+    flush(); // Publish staged rows under the old filter first.
+    beginResetModel();
+    m_filter = filter;
+    rebuildView();
+    endResetModel();
+
+    emit filterChanged();
+    emit countChanged();
+}
+
+void RawPacketLogModel::setFollowing(bool following) {
+    if (following == m_following)
+        return;
+    m_following = following;
+    emit followingChanged();
+}
+
+QString RawPacketLogModel::formatRecord(const DownlinkRecord& rec) {
+    if (rec.status != RP_CODEC_OK)
+        return QStringLiteral("[decode error %1]").arg(rec.status);
+
+    const tvr_Downlink& downlink = rec.downlink;
+
+    // Log decoded fields as readable text
+    if (downlink.which_payload == tvr_Downlink_telemetry_tag) {
+        const tvr_TelemetryState* t = &downlink.payload.telemetry;
+        QString line = QStringLiteral("TELEM t=%1 state=%2 thrust=%3 gx=%4 gy=%5")
+            .arg(t->timestamp_ms)
+            .arg(t->flight_state)
+            .arg(static_cast<double>(t->thrust_cmd))
+            .arg(static_cast<double>(t->gimbal_x))
+            .arg(static_cast<double>(t->gimbal_y));
+        if (t->has_position)
+            line += QStringLiteral(" pos=%1,%2,%3")
+                .arg(static_cast<double>(t->position.x))
+                .arg(static_cast<double>(t->position.y))
+                .arg(static_cast<double>(t->position.z));
+        if (t->has_velocity)
+            line += QStringLiteral(" vel=%1,%2,%3")
+                .arg(static_cast<double>(t->velocity.x))
+                .arg(static_cast<double>(t->velocity.y))
+                .arg(static_cast<double>(t->velocity.z));
+        if (t->has_attitude)
+            line += QStringLiteral(" att=%1,%2,%3,%4")
+                .arg(static_cast<double>(t->attitude.w))
+                .arg(static_cast<double>(t->attitude.x))
+                .arg(static_cast<double>(t->attitude.y))
+                .arg(static_cast<double>(t->attitude.z));
+        if (t->has_angular_rate)
+            line += QStringLiteral(" gyro=%1,%2,%3")
+                .arg(static_cast<double>(t->angular_rate.x))
+                .arg(static_cast<double>(t->angular_rate.y))
+                .arg(static_cast<double>(t->angular_rate.z));
+        return line;
+    }
+
+    if (downlink.which_payload == tvr_Downlink_status_tag) {
+        const tvr_SystemStatus* s = &downlink.payload.status;
+        return QStringLiteral(
+            "STATUS t=%1 up=%2 state=%3 accel=%4 gyro=%5 b1=%6 b2=%7 gps=%8 rx=%9 tx=%10 cmd=%11")
+            .arg(s->timestamp_ms)
+            .arg(s->uptime_ms)
+            .arg(s->flight_state)
+            .arg(s->accel_ok)
+            .arg(s->gyro_ok)
+            .arg(s->baro1_ok)
+            .arg(s->baro2_ok)
+            .arg(s->gps_connected)
+            .arg(s->radio_rx_count)
+            .arg(s->radio_tx_count)
+            .arg(s->cmd_rx_count);
+    }
+
+    return QStringLiteral("[unknown payload %1]").arg(downlink.which_payload);
+}
@@ -0,0 +1,355 @@
+#include "ReplayEngine.h"
+#include "DiversityCombiner.h"
+#include "RecordingFormat.h"
+#include <QPointer>
+#include <QUrl>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+extern "C" {
+    #include "rp/codec.h"
+    #include "downlink.pb.h"
+}
+
+using namespace recording;
+
+namespace {
+constexpr int    kTickMs       = 5;     // Paced playback resolution.
+constexpr size_t kMaxBatch     = 4096;  // Frames per tick at most (keeps the GUI responsive).
+constexpr size_t kFastBatch    = 512;   // Frames per batch when playing as fast as possible.
+static_assert(kFastBatch <= SerialWorker::RecordQueue::capacity(), "a fast batch must fit the record queue");
+constexpr size_t kPrimeLookback = 4096; // How far back a seek looks for the last telemetry/status.
+}
+
+ReplayEngine::ReplayEngine(SerialBridge* bridge, QObject* parent)
+    : QObject(parent), m_bridge(bridge)
+{
+    m_timer.setTimerType(Qt::PreciseTimer);
+    m_timer.setInterval(kTickMs);
+    connect(&m_timer, &QTimer::timeout, this, &ReplayEngine::tick);
+}
+
+ReplayEngine::~ReplayEngine() {
+    close();
+}
+
+bool ReplayEngine::open(const QString& path) {
+    close();
+
+    const QUrl url(path);
+    m_file.setFileName(url.isLocalFile() ? url.toLocalFile() : path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        emit errorMessage(QStringLiteral("Replay: cannot open %1: %2").arg(path, m_file.errorString()));
+        return false;
+    }
+
+    const qint64 size = m_file.size();
+    m_map = (size > 0) ? m_file.map(0, size) : nullptr;
+    if (!m_map || !buildIndex(size)) {
+        emit errorMessage(QStringLiteral("Replay: %1 is not a readable flight recording").arg(path));
+        close();
+        return false;
+    }
+
+    m_next = 0;
+    resetClock();
+    emit loadedChanged();
+    emit positionChanged();
+    return true;
+}
+
+void ReplayEngine::close() {
+    const bool wasLoaded = isLoaded();
+    pause();
+
+    // Queued batches still read from the mapping.
+    if (m_pendingBatches > 0 && m_bridge)
+        m_bridge->waitInjected();
+
+    m_frames.clear();
+    m_frames.shrink_to_fit();
+    m_spans.clear();
+    m_spans.shrink_to_fit();
+    m_marks.clear();
+    m_next = 0;
+    if (m_map)
+        m_file.unmap(const_cast<uchar*>(m_map));
+    m_map = nullptr;
+    m_file.close();
+
+    if (wasLoaded) {
+        emit loadedChanged();
+        emit positionChanged();
+    }
+}
+
+bool ReplayEngine::buildIndex(qint64 fileSize) {
+    FileHeader fh;
+    if (fileSize < qint64(sizeof(fh)))
+        return false;
+    std::memcpy(&fh, m_map, sizeof(fh));
+    if (std::memcmp(fh.magic, kFileMagic, sizeof(fh.magic)) != 0 || fh.version != kVersion)
+        return false;
+
+    tvr_Downlink msg;
+    int state = -1;
+    quint64 pos = sizeof(fh);
+
+    // With several radios up every packet is recorded once per link. Like live RX, keep
+    // the first copy of each (timestamp, type) from any link: the combined stream.
+    DiversityCombiner combiner;
+
+    // Chunks are self-describing; the first torn or foreign chunk ends the recording.
+    while (pos + sizeof(ChunkHeader) <= quint64(fileSize)) {
+        ChunkHeader ch;
+        std::memcpy(&ch, m_map + pos, sizeof(ch));
+        const quint64 payload = pos + sizeof(ch);
+        const quint64 end = payload + ch.payloadBytes;
+        if (ch.magic != kChunkMagic || end > quint64(fileSize))
+            break;
+
+        quint64 at = payload;
+        for (quint32 i = 0; i < ch.frameCount && at + sizeof(FrameHeader) <= end; ++i) {
+            FrameHeader hdr;
+            std::memcpy(&hdr, m_map + at, sizeof(hdr));
+            const quint64 bytes = at + sizeof(hdr);
+            if (bytes + hdr.length > end)
+                break;
+
+            FrameRef ref {};
+            ref.rxNs   = hdr.rxNs;
+            ref.kind   = KindError;
+
+            msg = tvr_Downlink_init_default;
+            if (rp_packet_decode(m_map + bytes, hdr.length, &tvr_Downlink_msg, &msg).status == RP_CODEC_OK) {
+                if (msg.which_payload == tvr_Downlink_telemetry_tag) {
+                    ref.kind        = KindTelemetry;
+                    ref.timestampMs = msg.payload.telemetry.timestamp_ms;
+                    state           = int(msg.payload.telemetry.flight_state);
+                } else if (msg.which_payload == tvr_Downlink_status_tag) {
+                    ref.kind        = KindStatus;
+                    ref.timestampMs = msg.payload.status.timestamp_ms;
+                    state           = int(msg.payload.status.flight_state);
+                }
+                if (ref.kind != KindError &&
+                    !combiner.offer(hdr.port, 0, int(msg.which_payload), ref.timestampMs, ref.rxNs)) {
+                    at = bytes + paddedLength(hdr.length);
+                    continue; // Another link's copy was first.
+                }
+            }
+
+            ref.flightState = state;
+            m_frames.push_back(ref);
+            m_spans.push_back(SerialBridge::InjectedFrame { bytes, hdr.length, int(hdr.port) });
+
+            at = bytes + paddedLength(hdr.length);
+        }
+        pos = end;
+    }
+
+    if (m_frames.empty())
+        return false;
+
+    for (size_t i = 0; i < m_frames.size(); ++i) {
+        if (i == 0 || m_frames[i].flightState != m_frames[i - 1].flightState)
+            m_marks.push_back(i);
+    }
+    return true;
+}
+
+// -----------------------
+// Transport
+// -----------------------
+
+void ReplayEngine::play() {
+    if (!isLoaded() || isPlaying())
+        return;
+    if (m_next >= m_frames.size())
+        moveTo(0); // Play from the top again once at the end.
+
+    resetClock();
+    m_timer.start();
+    emit playingChanged();
+    if (m_fast)
+        tick(); // Further batches follow each other's completion; the timer is the backstop.
+}
+
+void ReplayEngine::pause() {
+    if (!isPlaying())
+        return;
+    m_timer.stop();
+    emit playingChanged();
+}
+
+void ReplayEngine::step(int count) {
+    if (!isLoaded() || count == 0)
+        return;
+    pause();
+
+    if (count < 0) {
+        // Stepping back re-primes from the frame before the new play head.
+        const qint64 target = qMax<qint64>(0, qint64(m_next) + count);
+        moveTo(size_t(target));
+        return;
+    }
+
+    const size_t to = qMin(m_frames.size(), m_next + size_t(count));
+    inject(m_next, to);
+    m_next = to;
+    emit positionChanged();
+}
+
+void ReplayEngine::seek(double positionMs) {
+    if (!isLoaded())
+        return;
+    const qint64 target = m_frames.front().rxNs + qint64(positionMs * 1e6);
+    const auto it = std::lower_bound(m_frames.begin(), m_frames.end(), target,
+                                     [](const FrameRef& f, qint64 ns) { return f.rxNs < ns; });
+    moveTo(size_t(it - m_frames.begin()));
+}
+
+void ReplayEngine::seekFrame(int index) {
+    if (!isLoaded())
+        return;
+    moveTo(size_t(qBound(0, index, frameCount())));
+}
+
+bool ReplayEngine::seekToFlightState(int state, int occurrence) {
+    for (size_t mark : m_marks) {
+        if (m_frames[mark].flightState == state && occurrence-- == 0) {
+            moveTo(mark);
+            return true;
+        }
+    }
+    return false;
+}
+
+QVariantList ReplayEngine::flightStateMarks() const {
+    QVariantList out;
+    out.reserve(qsizetype(m_marks.size()));
+    for (size_t mark : m_marks) {
+        out.append(QVariantMap {
+            { QStringLiteral("positionMs"), double(m_frames[mark].rxNs - m_frames.front().rxNs) / 1e6 },
+            { QStringLiteral("state"),      m_frames[mark].flightState },
+        });
+    }
+    return out;
+}
+
+// -----------------------
+// Property getters/setters
+// -----------------------
+
+double ReplayEngine::durationMs() const {
+    return isLoaded() ? double(m_frames.back().rxNs - m_frames.front().rxNs) / 1e6 : 0.0;
+}
+
+double ReplayEngine::positionMs() const {
+    if (!isLoaded())
+        return 0.0;
+    const size_t at = qMin(m_next, m_frames.size() - 1);
+    return double(m_frames[at].rxNs - m_frames.front().rxNs) / 1e6;
+}
+
+int ReplayEngine::flightState() const {
+    return (isLoaded() && m_next > 0) ? m_frames[m_next - 1].flightState : -1;
+}
+
+void ReplayEngine::setSpeed(double speed) {
+    speed = qBound(0.1, speed, 100.0);
+    if (qFuzzyCompare(speed, m_speed))
+        return;
+    m_speed = speed;
+    resetClock();
+    emit speedChanged();
+}
+
+void ReplayEngine::setFastAsPossible(bool fast) {
+    if (fast == m_fast)
+        return;
+    m_fast = fast;
+    resetClock();
+    emit speedChanged();
+}
+
+// -----------------------
+// Playback
+// -----------------------
+
+void ReplayEngine::tick() {
+    const size_t from = m_next;
+    size_t to = from;
+
+    if (m_fast) {
+        // One batch in flight at a time, and only once the GUI drained room for all of it:
+        // a full record queue would drop what the packet log and history should show.
+        if (m_pendingBatches > 0 || !m_bridge ||
+            m_bridge->downlinkQueue().sizeApprox() + kFastBatch > SerialWorker::RecordQueue::capacity())
+            return;
+        to = qMin(m_frames.size(), from + kFastBatch);
+    } else {
+        const qint64 due = m_anchorNs + qint64(double(m_clock.nsecsElapsed()) * m_speed);
+        const size_t limit = qMin(m_frames.size(), from + kMaxBatch);
+        while (to < limit && m_frames[to].rxNs <= due)
+            ++to;
+    }
+
+    if (to != from) {
+        inject(from, to);
+        m_next = to;
+        emit positionChanged();
+    }
+
+    if (m_next >= m_frames.size()) {
+        pause();
+        emit finished();
+    }
+}
+
+void ReplayEngine::inject(size_t from, size_t to, bool primed) {
+    if (!m_bridge || from >= to)
+        return;
+
+    // The spans point into the mapping, which close() keeps until the batch is done.
+    ++m_pendingBatches;
+    QPointer<ReplayEngine> self(this);
+    m_bridge->injectFrames(m_map, m_spans.data() + from, to - from, primed, [self] {
+        if (!self)
+            return;
+        --self->m_pendingBatches;
+        // The batch's records were drained before this runs (queued after their notification).
+        if (self->m_fast && self->isPlaying())
+            self->tick();
+    });
+}
+
+void ReplayEngine::moveTo(size_t index) {
+    index = qMin(index, m_frames.size());
+
+    // Re-prime the display: newest telemetry and status frame before the play head.
+    size_t lastTelemetry = SIZE_MAX, lastStatus = SIZE_MAX;
+    const size_t floor = (index > kPrimeLookback) ? index - kPrimeLookback : 0;
+    for (size_t i = index; i > floor && (lastTelemetry == SIZE_MAX || lastStatus == SIZE_MAX); --i) {
+        const quint8 kind = m_frames[i - 1].kind;
+        if (kind == KindTelemetry && lastTelemetry == SIZE_MAX)
+            lastTelemetry = i - 1;
+        else if (kind == KindStatus && lastStatus == SIZE_MAX)
+            lastStatus = i - 1;
+    }
+    const size_t first = qMin(lastTelemetry, lastStatus), second = qMax(lastTelemetry, lastStatus);
+    if (first != SIZE_MAX)
+        inject(first, first + 1, true);   // Keep recorded order.
+    if (second != SIZE_MAX)
+        inject(second, second + 1, true);
+
+    m_next = index;
+    resetClock();
+    emit positionChanged();
+}
+
+void ReplayEngine::resetClock() {
+    if (m_frames.empty())
+        return;
+    m_anchorNs = m_frames[qMin(m_next, m_frames.size() - 1)].rxNs;
+    m_clock.start();
+}
@@ -0,0 +1,381 @@
+#include "RocketSimulator.h"
+#include "DownlinkGenerator.h"
+#include "DownlinkRecord.h"
+#include "Transport.h"
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+extern "C" {
+    #include "rp/codec.h"
+    #include "command.pb.h"
+}
+
+namespace {
+// Flight states as reported by the vehicle
+constexpr int kIdle  = 0;
+constexpr int kEstop = 1;
+constexpr int kRise  = 2;
+constexpr int kHover = 3;
+constexpr int kLower = 4;
+
+// FlightCommand state command types (same numbering as the control panel)
+constexpr int kCmdArm    = 1;
+constexpr int kCmdLaunch = 2;
+constexpr int kCmdAbort  = 3;
+constexpr int kCmdLand   = 4;
+
+constexpr int     kTickMs     = 1;
+constexpr int     kMaxBacklog = 32 * 1024;  ///< TX bytes held while the peer isn't reading.
+constexpr quint64 kNever      = std::numeric_limits<quint64>::max();
+}
+
+RocketSimulator::RocketSimulator(const Options& options, QObject* parent)
+    : QObject(parent), m_opt(options), m_timer(this), m_rx(16 * 1024, 512), m_rng(options.seed)
+{
+    m_timer.setTimerType(Qt::PreciseTimer);
+    m_timer.setInterval(kTickMs);
+    connect(&m_timer, &QTimer::timeout, this, &RocketSimulator::tick);
+}
+
+RocketSimulator::~RocketSimulator() {
+    stop();
+}
+
+bool RocketSimulator::parseProfile(const QString& name, Profile* out) {
+    const QString n = name.toLower();
+    if (n == QLatin1String("pad"))        *out = Profile::Pad;
+    else if (n == QLatin1String("hop"))   *out = Profile::Hop;
+    else if (n == QLatin1String("hover")) *out = Profile::Hover;
+    else if (n == QLatin1String("abort")) *out = Profile::Abort;
+    else return false;
+    return true;
+}
+
+bool RocketSimulator::start(QString* error) {
+    stop();
+    m_link = Transport::create(m_opt.link, m_opt.baud, this);
+    connect(m_link, &Transport::readyRead, this, &RocketSimulator::onReadyRead);
+    connect(m_link, &Transport::errorOccurred, this, [](const QString& msg) {
+        qWarning() << "RocketSimulator: link error:" << msg;
+    });
+    if (!m_link->open()) {
+        if (error)
+            *error = m_link->errorString();
+        delete m_link;
+        m_link = nullptr;
+        return false;
+    }
+
+    m_stats = Stats();
+    m_tx.clear();
+    m_rx.clear();
+    m_telemetrySlots = m_statusSlots = 0;
+    m_bitPos = m_bytePos = 0;
+    m_nextFlip = skip(m_opt.bitErrorRate);
+    m_nextDrop = skip(m_opt.dropRate);
+    m_altitude = m_climbRate = 0.0f;
+
+    m_clock.start();
+    runScript(m_opt.waitLaunch ? std::vector<Phase>{ { kIdle, 0, 0.0f, 0.0f } } : profileScript(false), 0);
+    m_timer.start();
+    return true;
+}
+
+void RocketSimulator::stop() {
+    m_timer.stop();
+    if (m_link) {
+        m_link->close();
+        delete m_link;
+        m_link = nullptr;
+    }
+}
+
+QString RocketSimulator::linkDescription() const {
+    return m_link ? m_link->describe() : QString();
+}
+
+// -----------------------
+// Flight script
+// -----------------------
+
+std::vector<RocketSimulator::Phase> RocketSimulator::profileScript(bool skipPad) const {
+    std::vector<Phase> s;
+    switch (m_opt.profile) {
+    case Profile::Pad:
+        s = { { kIdle, 0, 0.0f, 0.0f } };
+        break;
+    case Profile::Hop:
+        s = { { kIdle, 3000, 0.0f, 0.0f }, { kRise, 4000, 0.0f, 10.0f }, { kHover, 6000, 10.0f, 10.0f },
+              { kLower, 5000, 10.0f, 0.0f }, { kIdle, 3000, 0.0f, 0.0f } };
+        break;
+    case Profile::Hover:
+        s = { { kIdle, 2000, 0.0f, 0.0f }, { kRise, 3000, 0.0f, 5.0f }, { kHover, 0, 5.0f, 5.0f } };
+        break;
+    case Profile::Abort:
+        s = { { kIdle, 2000, 0.0f, 0.0f }, { kRise, 3000, 0.0f, 6.0f }, { kEstop, 1500, 6.0f, 0.0f },
+              { kIdle, 3000, 0.0f, 0.0f } };
+        break;
+    }
+    if (skipPad && s.size() > 1 && s.front().state == kIdle)
+        s.erase(s.begin());
+    return s;
+}
+
+void RocketSimulator::runScript(std::vector<Phase> script, qint64 nowMs) {
+    m_script = std::move(script);
+    m_phaseIndex = 0;
+    m_phase = m_script.front();
+    m_phase.startMs = nowMs;
+}
+
+void RocketSimulator::advance(qint64 nowMs) {
+    while (m_phase.durationMs > 0 && nowMs - m_phase.startMs >= m_phase.durationMs) {
+        const qint64 endMs = m_phase.startMs + m_phase.durationMs;
+        if (m_phaseIndex + 1 < m_script.size()) {
+            m_phase = m_script[++m_phaseIndex];
+            m_phase.startMs = endMs;
+        } else if (m_opt.loop && !m_opt.waitLaunch) {
+            runScript(profileScript(false), endMs);
+        } else {
+            runScript({ { kIdle, 0, m_phase.altTo, m_phase.altTo } }, endMs); // Hold on the pad.
+        }
+    }
+
+    // Smoothstep between the phase endpoints; the climb rate is its time derivative.
+    if (m_phase.durationMs <= 0) {
+        m_altitude  = m_phase.altTo;
+        m_climbRate = 0.0f;
+        return;
+    }
+    const float durS = float(m_phase.durationMs) * 0.001f;
+    const float t = std::clamp(float(nowMs - m_phase.startMs) * 0.001f / durS, 0.0f, 1.0f);
+    const float span = m_phase.altTo - m_phase.altFrom;
+    m_altitude  = m_phase.altFrom + span * t * t * (3.0f - 2.0f * t);
+    m_climbRate = span * 6.0f * t * (1.0f - t) / durS;
+}
+
+void RocketSimulator::applyCommand(int type) {
+    const qint64 nowMs = m_clock.elapsed();
+    switch (type) {
+    case kCmdLaunch:
+        if (m_phase.state == kIdle)
+            runScript(profileScript(true), nowMs);
+        break;
+    case kCmdAbort:
+        runScript({ { kEstop, 2000, m_altitude, 0.0f }, { kIdle, 0, 0.0f, 0.0f } }, nowMs);
+        break;
+    case kCmdLand:
+        if (m_phase.state == kRise || m_phase.state == kHover)
+            runScript({ { kLower, qMax<qint64>(1000, qint64(m_altitude * 500.0f)), m_altitude, 0.0f },
+                        { kIdle, 0, 0.0f, 0.0f } }, nowMs);
+        break;
+    case kCmdArm:
+    default:
+        break; // Counted only.
+    }
+    emit commandReceived(type);
+}
+
+// -----------------------
+// Downlink
+// -----------------------
+
+void RocketSimulator::tick() {
+    const qint64 nowNs = m_clock.nsecsElapsed();
+    const qint64 nowMs = nowNs / 1000000;
+    advance(nowMs);
+
+    // Absolute slot counts keep the long-run rate exact whatever the timer jitter;
+    // after a stall at most ~100 ms worth is caught up instead of one huge burst.
+    auto due = [nowNs](double hz, quint64& served) -> quint64 {
+        if (hz <= 0.0)
+            return 0;
+        const quint64 slots = quint64(double(nowNs) * hz / 1e9);
+        const quint64 cap = qMax<quint64>(1, quint64(hz / 10.0));
+        if (slots > served + cap)
+            served = slots - cap;
+        const quint64 n = slots - served;
+        served = slots;
+        return n;
+    };
+
+    tvr_Downlink msg;
+    for (quint64 n = due(m_opt.statusHz, m_statusSlots); n > 0; --n) {
+        fillStatus(msg, nowMs);
+        if (send(msg))
+            ++m_stats.statusSent;
+    }
+    for (quint64 n = due(m_opt.telemetryHz, m_telemetrySlots); n > 0; --n) {
+        fillTelemetry(msg, nowMs);
+        if (send(msg))
+            ++m_stats.telemetrySent;
+    }
+    drainTx();
+}
+
+void RocketSimulator::fillTelemetry(tvr_Downlink& msg, qint64 nowMs) {
+    msg = tvr_Downlink_init_zero;
+    msg.which_payload = tvr_Downlink_telemetry_tag;
+    auto& t = msg.payload.telemetry;
+
+    const int state = m_phase.state;
+    const bool flying = state == kRise || state == kHover || state == kLower || m_altitude > 0.01f;
+    const float s = float(nowMs) * 0.001f;
+    const float wobble = flying ? 1.0f : 0.0f;
+
+    t.timestamp_ms = quint32(nowMs);
+    t.flight_state = decltype(t.flight_state)(state);
+    switch (state) {
+    case kRise:  t.thrust_cmd = 0.75f; break;
+    case kHover: t.thrust_cmd = 0.60f; break;
+    case kLower: t.thrust_cmd = 0.50f; break;
+    default:     t.thrust_cmd = 0.0f;  break;
+    }
+    t.gimbal_x = wobble * 2.0f * std::sin(1.3f * s);
+    t.gimbal_y = wobble * 2.0f * std::cos(1.1f * s);
+
+    t.has_position = true;
+    t.position.x = wobble * 0.2f * std::sin(0.3f * s);
+    t.position.y = wobble * 0.2f * std::cos(0.3f * s);
+    t.position.z = m_altitude;
+
+    t.has_velocity = true;
+    t.velocity.x = wobble * 0.06f * std::cos(0.3f * s);
+    t.velocity.y = wobble * -0.06f * std::sin(0.3f * s);
+    t.velocity.z = m_climbRate;
+
+    // Small roll/pitch oscillation while airborne, as a unit quaternion.
+    const float hr = wobble * 0.02f * std::sin(1.7f * s);
+    const float hp = wobble * 0.02f * std::cos(1.9f * s);
+    t.has_attitude = true;
+    t.attitude.w = std::cos(hr) * std::cos(hp);
+    t.attitude.x = std::sin(hr) * std::cos(hp);
+    t.attitude.y = std::cos(hr) * std::sin(hp);
+    t.attitude.z = -std::sin(hr) * std::sin(hp);
+
+    t.has_angular_rate = true;
+    t.angular_rate.x = wobble * 0.068f * std::cos(1.7f * s);
+    t.angular_rate.y = wobble * -0.076f * std::sin(1.9f * s);
+    t.angular_rate.z = 0.0f;
+}
+
+void RocketSimulator::fillStatus(tvr_Downlink& msg, qint64 nowMs) {
+    msg = tvr_Downlink_init_zero;
+    msg.which_payload = tvr_Downlink_status_tag;
+    auto& st = msg.payload.status;
+    st.timestamp_ms   = quint32(nowMs);
+    st.uptime_ms      = quint32(nowMs);
+    st.flight_state   = decltype(st.flight_state)(m_phase.state);
+    st.accel_ok       = true;
+    st.gyro_ok        = true;
+    st.baro1_ok       = true;
+    st.baro2_ok       = true;
+    st.gps_connected  = true;
+    st.radio_rx_count = quint32(m_stats.uplinkFrames);
+    st.radio_tx_count = quint32(m_stats.telemetrySent + m_stats.statusSent);
+    st.cmd_rx_count   = quint32(m_stats.commandsRx);
+}
+
+bool RocketSimulator::send(tvr_Downlink& msg) {
+    if (m_tx.size() >= kMaxBacklog) {
+        ++m_stats.framesOverrun;
+        return false;
+    }
+    if (m_opt.stampMonotonic) {
+        const quint32 sendMs = quint32(monotonicNs() / 1000000);
+        if (msg.which_payload == tvr_Downlink_telemetry_tag)
+            msg.payload.telemetry.timestamp_ms = sendMs;
+        else
+            msg.payload.status.timestamp_ms = sendMs;
+    }
+
+    uint8_t frame[DownlinkGenerator::kMaxFrame];
+    const size_t n = DownlinkGenerator::encode(msg, frame, sizeof(frame));
+    if (n == 0)
+        return false;
+    impairAndQueue(frame, n);
+    return true;
+}
+
+quint64 RocketSimulator::skip(double p) {
+    if (p <= 0.0)
+        return kNever;
+    if (p >= 1.0)
+        return 0;
+    return std::geometric_distribution<quint64>(p)(m_rng);
+}
+
+void RocketSimulator::impairAndQueue(const uint8_t* data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        const quint64 pos = m_bytePos++;
+        if (pos == m_nextDrop) {
+            ++m_stats.bytesDropped;
+            const quint64 gap = skip(m_opt.dropRate);
+            m_nextDrop = gap == kNever ? kNever : pos + 1 + gap;
+            continue; // Never transmitted, so it consumes no bit positions.
+        }
+        uint8_t b = data[i];
+        while (m_nextFlip < m_bitPos + 8) {
+            b ^= uint8_t(1u << (m_nextFlip - m_bitPos));
+            ++m_stats.bitsFlipped;
+            const quint64 gap = skip(m_opt.bitErrorRate);
+            m_nextFlip = gap == kNever ? kNever : m_nextFlip + 1 + gap;
+        }
+        m_bitPos += 8;
+        m_tx.append(char(b));
+    }
+}
+
+void RocketSimulator::drainTx() {
+    if (!m_link)
+        return;
+    while (!m_tx.isEmpty()) {
+        const qint64 n = m_link->write(m_tx.constData(), m_tx.size());
+        if (n < 0) {
+            qWarning() << "RocketSimulator: write failed:" << m_link->errorString();
+            m_tx.clear();
+            break;
+        }
+        if (n == 0)
+            break; // Peer not reading; keep the backlog for the next tick.
+        m_stats.bytesSent += quint64(n);
+        m_tx.remove(0, n);
+    }
+    m_link->flush();
+}
+
+// -----------------------
+// Uplink
+// -----------------------
+
+void RocketSimulator::onReadyRead() {
+    for (;;) {
+        size_t room = 0;
+        uint8_t* dst = m_rx.writeSpan(&room);
+        qint64 n = 0;
+        if (room > 0) {
+            n = m_link->read(reinterpret_cast<char*>(dst), qint64(room));
+            if (n > 0)
+                m_rx.commit(size_t(n));
+        }
+
+        FrameView f;
+        while (m_rx.nextFrame(0x00, f)) {
+            if (f.size <= 1)
+                continue; // Bare delimiter (sender-side resync).
+            ++m_stats.uplinkFrames;
+            tvr_FlightCommand cmd = tvr_FlightCommand_init_zero;
+            if (rp_packet_decode(f.data, f.size, &tvr_FlightCommand_msg, &cmd).status != RP_CODEC_OK) {
+                ++m_stats.uplinkErrors; // Text lines and garbage end up here too.
+                continue;
+            }
+            ++m_stats.commandsRx;
+            if (cmd.which_payload == tvr_FlightCommand_state_cmd_tag)
+                applyCommand(int(cmd.payload.state_cmd.type));
+        }
+        if (n <= 0)
+            break;
+    }
+}
@@ -0,0 +1,187 @@
+#include "RxRing.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+enum ByteClass : uint8_t { Printable = 0, Binary, Newline, Delimiter };
+
+/// Mixed-mode classification: printable ASCII, TAB, CR and UTF-8 bytes count as text.
+struct ByteClassTable {
+    uint8_t cls[256];
+    constexpr ByteClassTable() : cls() {
+        for (int b = 0; b < 256; ++b)
+            cls[b] = (b >= 0x20 && b != 0x7f) || b == '\t' || b == '\r' ? Printable : Binary;
+        cls[0x00] = Delimiter;
+        cls[uint8_t('\n')] = Newline;
+    }
+};
+constexpr ByteClassTable kByteClass;
+
+size_t roundUpPow2(size_t v) {
+    size_t p = 1;
+    while (p < v)
+        p <<= 1;
+    return p;
+}
+} // namespace
+
+RxRing::RxRing(size_t capacity, size_t maxFrame)
+    : m_buf(roundUpPow2(std::max<size_t>(capacity, 64)))
+{
+    m_mask = m_buf.size() - 1;
+    setMaxFrame(maxFrame);
+}
+
+void RxRing::setMaxFrame(size_t maxFrame) {
+    // A frame must always fit with room left for the driver to keep reading.
+    m_maxFrame = std::clamp<size_t>(maxFrame, 2, m_buf.size() / 2);
+    m_scratch.reserve(m_maxFrame);
+}
+
+uint8_t* RxRing::writeSpan(size_t* len) {
+    const size_t free = m_buf.size() - size();
+    const size_t off  = m_head & m_mask;
+    *len = std::min(free, m_buf.size() - off);
+    return m_buf.data() + off;
+}
+
+void RxRing::commit(size_t n) {
+    m_head += n;
+}
+
+void RxRing::clear() {
+    m_head = m_tail = m_scan = m_textEnd = 0;
+    m_textOpen = true;
+}
+
+size_t RxRing::scan(uint8_t delim) {
+    if (delim != m_scanDelim) {
+        m_scanDelim = delim;
+        m_scan = m_tail;
+    }
+
+    // At most two contiguous pieces: [scan, end of storage) and [start of storage, head).
+    while (m_scan < m_head) {
+        const size_t off = m_scan & m_mask;
+        const size_t len = std::min(m_head - m_scan, m_buf.size() - off);
+        const void* hit = std::memchr(m_buf.data() + off, delim, len);
+        if (hit) {
+            m_scan += static_cast<const uint8_t*>(hit) - (m_buf.data() + off);
+            return m_scan;
+        }
+        m_scan += len;
+    }
+    return m_head;
+}
+
+bool RxRing::nextFrame(uint8_t delim, FrameView& out) {
+    for (;;) {
+        const size_t idx = scan(delim);
+
+        if (idx == m_head) {
+            // No delimiter yet. Guard against a lost delimiter growing the backlog forever.
+            if (size() > m_maxFrame) {
+                ++m_oversizeDrops;
+                m_droppedBytes += size();
+                m_tail = m_scan = m_head;
+            }
+            return false;
+        }
+
+        const size_t len   = idx - m_tail + 1; // Include the delimiter.
+        const size_t start = m_tail;
+        m_tail = m_scan = idx + 1;
+
+        if (len > m_maxFrame) {
+            // Delimiter arrived too late; the run is garbage (lost sync), skip it.
+            ++m_oversizeDrops;
+            m_droppedBytes += len;
+            continue;
+        }
+
+        out = viewOf(start, len);
+        return true;
+    }
+}
+
+FrameView RxRing::viewOf(size_t start, size_t len) {
+    FrameView v;
+    const size_t off = start & m_mask;
+    if (off + len <= m_buf.size()) {
+        v.data = m_buf.data() + off;            // Zero-copy: view straight into the ring.
+    } else {
+        const size_t first = m_buf.size() - off; // Wraps: one contiguous copy.
+        m_scratch.resize(len);
+        std::memcpy(m_scratch.data(), m_buf.data() + off, first);
+        std::memcpy(m_scratch.data() + first, m_buf.data(), len - first);
+        v.data = m_scratch.data();
+        ++m_wrappedFrames;
+    }
+    v.size = len;
+    return v;
+}
+
+bool RxRing::nextSegment(RxSegment& out, bool flushText) {
+    if (m_scanDelim != 0) {              // Coming from line framing: rescan for the delimiter.
+        m_scanDelim = 0;
+        m_scan = m_textEnd = m_tail;
+        m_textOpen = true;
+    }
+
+    for (;;) {
+        // One pass, one table lookup per byte; each byte is classified exactly once.
+        bool found = false;
+        while (m_scan < m_head) {
+            const uint8_t c = kByteClass.cls[m_buf[m_scan & m_mask]];
+            if (c == Delimiter) {
+                found = true;
+                break;
+            }
+            if (c == Newline) {
+                if (m_textOpen)
+                    m_textEnd = m_scan + 1;
+            } else if (c == Binary) {
+                m_textOpen = false;
+            }
+            ++m_scan;
+        }
+
+        if (!found) {
+            const bool oversize = size() > m_maxFrame;
+            if (m_textEnd > m_tail && (flushText || oversize)) {
+                // The remainder after the lines keeps its own printable state (m_textOpen).
+                out.bytes = viewOf(m_tail, m_textEnd - m_tail);
+                out.textPrefix = out.bytes.size;
+                out.text = true;
+                m_tail = m_textEnd;
+                return true;
+            }
+            if (oversize) {
+                // Lost sync inside binary data: drop it and resync on the next delimiter.
+                ++m_oversizeDrops;
+                m_droppedBytes += size();
+                m_tail = m_scan = m_textEnd = m_head;
+                m_textOpen = true;
+            }
+            return false;
+        }
+
+        const size_t start  = m_tail;
+        const size_t len    = m_scan - m_tail + 1;     // Include the delimiter.
+        const size_t prefix = m_textEnd - m_tail;
+        m_tail = m_scan = m_textEnd = m_scan + 1;
+        m_textOpen = true;
+
+        if (len - prefix > m_maxFrame) {
+            // Delimiter arrived too late; the binary run is garbage (lost sync), skip it.
+            ++m_oversizeDrops;
+            m_droppedBytes += len;
+            continue;
+        }
+
+        out.bytes = viewOf(start, len);
+        out.textPrefix = prefix;
+        out.text = false;
+        return true;
+    }
+}
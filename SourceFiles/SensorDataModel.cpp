@@ -1,63 +1,35 @@
 #include "SensorDataModel.h"
+#include "AllocCounter.h"
+#include "CommandTracker.h"
 #include "SerialBridge.h"
+#include "TelemetryAlarms.h"
+#include "VehicleRouter.h"
+#include <QtAlgorithms>
 extern "C" {
     #include "rp/codec.h"
     #include "downlink.pb.h"
 }
-#include <QDebug>
-#include <QtMath>
-#include <cmath>
 
 namespace {
-static constexpr bool kDownlinkDebug = false;
-
-// Quaternion (w,x,y,z) to Euler angles (roll, pitch, yaw) in radians.
-void quatToEulerRad(float w, float x, float y, float z,
-                    float* roll_rad, float* pitch_rad, float* yaw_rad) {
-    double sinp = 2.0 * (w * y - z * x);
-    if (std::abs(sinp) >= 1) {
-        *pitch_rad = static_cast<float>(std::copysign(M_PI / 2, sinp));
-    } else {
-        *pitch_rad = static_cast<float>(std::asin(sinp));
-    }
-    double siny_cosp = 2.0 * (w * z + x * y);
-    double cosy_cosp = 1.0 - 2.0 * (y * y + z * z);
-    *yaw_rad = static_cast<float>(std::atan2(siny_cosp, cosy_cosp));
-    double sinr_cosp = 2.0 * (w * x + y * z);
-    double cosr_cosp = 1.0 - 2.0 * (x * x + y * y);
-    *roll_rad = static_cast<float>(std::atan2(sinr_cosp, cosr_cosp));
-}
-
-float radToDeg(float rad) {
-    return static_cast<float>(rad * 180.0 / M_PI);
+constexpr int kTimerFlushMs    = 16;  ///< Frame clock without a (visible) window.
+constexpr int kBackstopFlushMs = 100; ///< Latest flush while waiting for a window frame.
 }
-} // namespace
 
 SensorDataModel::SensorDataModel(SerialBridge* bridge, QObject* parent)
-    : QObject(parent), m_bridge(bridge)
+    : QObject(parent), m_packetLog(this), m_history(16, this), m_bridge(bridge)
 {
+    // Fallback frame clock until main() hands us the window (or when running headless).
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setTimerType(Qt::PreciseTimer);
+    m_flushTimer.setInterval(kTimerFlushMs);
+    connect(&m_flushTimer, &QTimer::timeout, this, &SensorDataModel::flushNotifications);
+
     if (!m_bridge)
         return;
 
-    // Subscribe to binary COBS packets (rocket sends COBS+protobuf Downlink).
-    QObject::connect(
-        m_bridge,
-        &SerialBridge::binaryPacketReceived,
-        this,
-        [this](int which, const QByteArray &packet) {
-            if (!m_bridge) return;
-            const bool p1 = m_bridge->isConnected(1);
-            const bool p2 = m_bridge->isConnected(2);
-            bool listen = (p1 && p2) ? (which == 1) : m_bridge->isConnected(which);
-            if (listen)
-                onBinaryPacketReceived(which, packet);
-        });
-}
-
-void SensorDataModel::clearRawPacketLog()
-{
-    m_rawPacketLog.clear();
-    emit rawPacketLogChanged();
+    // Decoding happens on the bridge's I/O thread; we are told (coalesced) when records wait.
+    QObject::connect(m_bridge, &SerialBridge::downlinkAvailable,
+                     this, &SensorDataModel::drainDownlink);
 }
 
 void SensorDataModel::onBinaryPacketReceived(int which, const QByteArray& packet)
@@ -65,200 +37,335 @@ void SensorDataModel::onBinaryPacketReceived(int which, const QByteArray& packet
     if (packet.isEmpty())
         return;
 
-    tvr_Downlink downlink = tvr_Downlink_init_default;
+    DownlinkRecord rec;
+    rec.which    = which;
+    rec.rxNs     = monotonicNs();
+    rec.downlink = tvr_Downlink_init_default;
     const uint8_t* data = reinterpret_cast<const uint8_t*>(packet.constData());
     size_t size = static_cast<size_t>(packet.size());
 
-    rp_packet_decode_result_t result =
-        rp_packet_decode(data, size, &tvr_Downlink_msg, &downlink);
+    rec.status = rp_packet_decode(data, size, &tvr_Downlink_msg, &rec.downlink).status;
 
-   
-    if (result.status != RP_CODEC_OK) {
-        m_rawPacketLog += QStringLiteral("[decode error %1]\n").arg(result.status);
-        emit rawPacketLogChanged();
+    onDownlinkRecord(rec);
+    flushLogs();
+    if (m_router)
+        m_router->flush();
+    if (rec.status == RP_CODEC_OK)
+        applyDownlink(which, &rec.downlink);
+    stampModelUpdated();
+}
+
+void SensorDataModel::drainDownlink()
+{
+    if (!m_bridge)
         return;
+
+    // Ack first so a record pushed while we drain triggers a fresh notification.
+    m_bridge->ackDownlink();
+
+    auto& queue = m_bridge->downlinkQueue();
+    while (DownlinkRecord* rec = queue.front()) {
+        ULYSSES_NO_ALLOC("SensorDataModel::drainDownlink record");
+        onDownlinkRecord(*rec);
+        queue.popFront();
     }
+    flushLogs(); // One row-insert batch per drain.
+    if (m_router)
+        m_router->flush();
+
+    // Latest state wins: bindings see the newest packet once, however many arrived.
+    TelemetrySnapshot snap;
+    if (m_bridge->downlinkSnapshot().read(snap))
+        applySnapshot(snap);
+    stampModelUpdated();
+}
+
+void SensorDataModel::stampModelUpdated()
+{
+    // QML sees the records once their notifications go out: with a flush pending that is
+    // flushNotifications(), otherwise (nothing changed, or already flushed) now.
+    if (m_latency && !m_dirty)
+        m_latency->modelUpdated(monotonicNs());
+}
 
-    // Log decoded fields as readable text
-    if (downlink.which_payload == tvr_Downlink_telemetry_tag) {
-        const tvr_TelemetryState* t = &downlink.payload.telemetry;
-        QString line = QStringLiteral("TELEM t=%1 state=%2 thrust=%3 gx=%4 gy=%5")
-            .arg(t->timestamp_ms)
-            .arg(t->flight_state)
-            .arg(static_cast<double>(t->thrust_cmd))
-            .arg(static_cast<double>(t->gimbal_x))
-            .arg(static_cast<double>(t->gimbal_y));
-        if (t->has_position)
-            line += QStringLiteral(" pos=%1,%2,%3")
-                .arg(static_cast<double>(t->position.x))
-                .arg(static_cast<double>(t->position.y))
-                .arg(static_cast<double>(t->position.z));
-        if (t->has_velocity)
-            line += QStringLiteral(" vel=%1,%2,%3")
-                .arg(static_cast<double>(t->velocity.x))
-                .arg(static_cast<double>(t->velocity.y))
-                .arg(static_cast<double>(t->velocity.z));
-        if (t->has_attitude)
-            line += QStringLiteral(" att=%1,%2,%3,%4")
-                .arg(static_cast<double>(t->attitude.w))
-                .arg(static_cast<double>(t->attitude.x))
-                .arg(static_cast<double>(t->attitude.y))
-                .arg(static_cast<double>(t->attitude.z));
-        if (t->has_angular_rate)
-            line += QStringLiteral(" gyro=%1,%2,%3")
-                .arg(static_cast<double>(t->angular_rate.x))
-                .arg(static_cast<double>(t->angular_rate.y))
-                .arg(static_cast<double>(t->angular_rate.z));
-        m_rawPacketLog += line + "\n";
-    } else if (downlink.which_payload == tvr_Downlink_status_tag) {
-        const tvr_SystemStatus* s = &downlink.payload.status;
-        m_rawPacketLog += QStringLiteral(
-            "STATUS t=%1 up=%2 state=%3 accel=%4 gyro=%5 b1=%6 b2=%7 gps=%8 rx=%9 tx=%10 cmd=%11\n")
-            .arg(s->timestamp_ms)
-            .arg(s->uptime_ms)
-            .arg(s->flight_state)
-            .arg(s->accel_ok)
-            .arg(s->gyro_ok)
-            .arg(s->baro1_ok)
-            .arg(s->baro2_ok)
-            .arg(s->gps_connected)
-            .arg(s->radio_rx_count)
-            .arg(s->radio_tx_count)
-            .arg(s->cmd_rx_count);
+void SensorDataModel::onDownlinkRecord(const DownlinkRecord& rec)
+{
+    if (rec.primed) {
+        // A replay seek restoring state: no new row, sample, alarm or confirmation.
+        if (m_router)
+            m_router->route(rec);
+        if (rec.status == RP_CODEC_OK && rec.vehicle == m_vehicle)
+            m_recordState.apply(rec.downlink);
+        return;
     }
-    emit rawPacketLogChanged();
+    if (m_latency)
+        m_latency->recordDecoded(rec);
+    if (m_router)
+        m_router->route(rec);
+    m_packetLog.append(rec);
+    if (rec.status != RP_CODEC_OK || rec.vehicle != m_vehicle)
+        return;
 
-    applyDownlink(which, &downlink);
+    // Every sample goes into the history, even when the snapshot coalesces a burst.
+    m_recordState.apply(rec.downlink);
+    if (rec.downlink.which_payload == tvr_Downlink_telemetry_tag)
+        m_history.append(rec.downlink.payload.telemetry.timestamp_ms, m_recordState);
+    if (m_alarms)
+        m_alarms->evaluate(rec, m_recordState);
+    if (m_tracker)
+        m_tracker->observe(rec, m_recordState);
+}
+
+void SensorDataModel::setAlarmEngine(TelemetryAlarms* alarms)
+{
+    m_alarms = alarms;
+}
+
+void SensorDataModel::setCommandTracker(CommandTracker* tracker)
+{
+    m_tracker = tracker;
+}
+
+void SensorDataModel::setVehicleRouter(VehicleRouter* router)
+{
+    m_router = router;
+}
+
+void SensorDataModel::flushLogs()
+{
+    m_packetLog.flush();
+    m_history.flush();
 }
 
 void SensorDataModel::updateKalman(double rawAngleX, double filteredAngleX,
                                    double rawAngleY, double filteredAngleY,
                                    double rawAngleZ, double filteredAngleZ)
 {
-    m_rawAngleX = rawAngleX;
-    m_filteredAngleX = filteredAngleX;
-    m_rawAngleY = rawAngleY;
-    m_filteredAngleY = filteredAngleY;
-    m_rawAngleZ = rawAngleZ;
-    m_filteredAngleZ = filteredAngleZ;
-
-    emit kalmanDataChanged();
+    TelemetrySnapshot snap = m_state;
+    snap.rawAngleX = rawAngleX;
+    snap.filteredAngleX = filteredAngleX;
+    snap.rawAngleY = rawAngleY;
+    snap.filteredAngleY = filteredAngleY;
+    snap.rawAngleZ = rawAngleZ;
+    snap.filteredAngleZ = filteredAngleZ;
+
+    commitState(snap, kKalmanFields);
 }
 
 void SensorDataModel::updatePosition(double altitude, double posX, double posY)
 {
-    m_altitude = altitude;
-    m_posX     = posX;
-    m_posY     = posY;
+    TelemetrySnapshot snap = m_state;
+    snap.altitude = altitude;
+    snap.posX     = posX;
+    snap.posY     = posY;
 
-    emit baroDataChanged();
+    commitState(snap, kBaroFields);
 }
 
 void SensorDataModel::updateEngine(double thrustCmd, double gimbalX, double gimbalY)
 {
-    m_thrustCmd = thrustCmd;
-    m_gimbalX   = gimbalX;
-    m_gimbalY   = gimbalY;
+    TelemetrySnapshot snap = m_state;
+    snap.thrustCmd = thrustCmd;
+    snap.gimbalX   = gimbalX;
+    snap.gimbalY   = gimbalY;
 
-    emit engineDataChanged();
+    commitState(snap, kEngineFields);
 }
 
 void SensorDataModel::updateTelemetry(double velocity)
 {
-    m_velocity = velocity;
+    TelemetrySnapshot snap = m_state;
+    snap.velocity = velocity;
 
-    emit telemetryDataChanged();
+    commitState(snap, kTelemetryFields);
 }
 
 void SensorDataModel::applyDownlink(int which, const void* downlinkStruct)
 {
     Q_UNUSED(which);
-    const tvr_Downlink* d = static_cast<const tvr_Downlink*>(downlinkStruct);
-
-    if (d->which_payload == tvr_Downlink_telemetry_tag) {
-        const tvr_TelemetryState* t = &d->payload.telemetry;
-
-        if (kDownlinkDebug) {
-            qDebug() << "TelemetryState: has_pos=" << t->has_position
-                     << "has_vel=" << t->has_velocity
-                     << "has_att=" << t->has_attitude
-                     << "flight_state=" << t->flight_state;
-        }
-
-        // Velocity magnitude [m/s] → km/h
-        double vel = m_velocity;
-        if (t->has_velocity) {
-            const tvr_Vec3* v = &t->velocity;
-            double vx = static_cast<double>(v->x), vy = static_cast<double>(v->y), vz = static_cast<double>(v->z);
-            vel = std::sqrt(vx * vx + vy * vy + vz * vz) * 3.6;
-        }
-
-        // Filtered Euler angles (deg) from attitude quaternion.
-        double filtX = 0.0, filtY = 0.0, filtZ = 0.0;
-        if (t->has_attitude) {
-            float roll, pitch, yaw;
-            quatToEulerRad(t->attitude.w, t->attitude.x, t->attitude.y, t->attitude.z,
-                           &roll, &pitch, &yaw);
-            filtX = radToDeg(roll);
-            filtY = radToDeg(pitch);
-            filtZ = radToDeg(yaw);
-        }
-
-        // Raw angular rates (rad/s) → deg/s for display alongside Euler angles.
-        double rawX = 0.0, rawY = 0.0, rawZ = 0.0;
-        if (t->has_angular_rate) {
-            rawX = radToDeg(t->angular_rate.x);
-            rawY = radToDeg(t->angular_rate.y);
-            rawZ = radToDeg(t->angular_rate.z);
-        }
-
-        // Raw angular rates (rad/s) → deg/s for display alongside Euler angles.
-
-        // Position [m]: altitude from z, horizontal from x/y.
-        double alt = m_altitude, px = m_posX, py = m_posY;
-        if (t->has_position) {
-            alt = static_cast<double>(t->position.z);
-            px  = static_cast<double>(t->position.x);
-            py  = static_cast<double>(t->position.y);
-        }
-
-        // Flight state from TelemetryState (10Hz update).
-        m_flightState = static_cast<int>(t->flight_state);
-
-        updateKalman(rawX, filtX, rawY, filtY, rawZ, filtZ);
-        updatePosition(alt, px, py);
-        updateTelemetry(vel);
-        updateEngine(
-            static_cast<double>(t->thrust_cmd),
-            static_cast<double>(t->gimbal_x),
-            static_cast<double>(t->gimbal_y)
-        );
-
-        // Emit statusReceived so flightState binding updates from telemetry too.
-        emit statusReceived();
-
-    } else if (d->which_payload == tvr_Downlink_status_tag) {
-        const tvr_SystemStatus* s = &d->payload.status;
-
-        if (kDownlinkDebug) {
-            qDebug() << "SystemStatus: flight_state=" << s->flight_state
-                     << "accel=" << s->accel_ok << "gyro=" << s->gyro_ok
-                     << "baro1=" << s->baro1_ok << "baro2=" << s->baro2_ok
-                     << "gps=" << s->gps_connected
-                     << "uptime=" << s->uptime_ms;
-        }
-
-        m_flightState  = static_cast<int>(s->flight_state);
-        m_uptimeMs     = s->uptime_ms;
-        m_accelOk      = s->accel_ok;
-        m_gyroOk       = s->gyro_ok;
-        m_baro1Ok      = s->baro1_ok;
-        m_baro2Ok      = s->baro2_ok;
-        m_gpsConnected = s->gps_connected;
-        m_radioRxCount = s->radio_rx_count;
-        m_radioTxCount = s->radio_tx_count;
-        m_cmdRxCount   = s->cmd_rx_count;
-
-        emit statusReceived();
+    TelemetrySnapshot snap = m_state;
+    snap.apply(*static_cast<const tvr_Downlink*>(downlinkStruct));
+    applySnapshot(snap);
+}
+
+void SensorDataModel::applySnapshot(const TelemetrySnapshot& snap)
+{
+    const bool telemetry = snap.telemetryCount != m_state.telemetryCount;
+    const bool status    = snap.statusCount    != m_state.statusCount;
+
+    // Without per-field tracking a TelemetryState notified every group, SystemStatus the status group.
+    quint32 touched = 0;
+    if (telemetry)
+        touched = kAllFields;
+    else if (status)
+        touched = kStatusFields;
+
+    commitState(snap, touched);
+}
+
+// -----------------------
+// Notification coalescing
+// -----------------------
+
+quint32 SensorDataModel::diffMask(const TelemetrySnapshot& a, const TelemetrySnapshot& b)
+{
+    quint32 m = 0;
+    auto diff = [&m](int field, auto x, auto y) { if (x != y) m |= 1u << field; };
+    diff(Altitude,       a.altitude,       b.altitude);
+    diff(PosX,           a.posX,           b.posX);
+    diff(PosY,           a.posY,           b.posY);
+    diff(RawAngleX,      a.rawAngleX,      b.rawAngleX);
+    diff(FilteredAngleX, a.filteredAngleX, b.filteredAngleX);
+    diff(RawAngleY,      a.rawAngleY,      b.rawAngleY);
+    diff(FilteredAngleY, a.filteredAngleY, b.filteredAngleY);
+    diff(RawAngleZ,      a.rawAngleZ,      b.rawAngleZ);
+    diff(FilteredAngleZ, a.filteredAngleZ, b.filteredAngleZ);
+    diff(ThrustCmd,      a.thrustCmd,      b.thrustCmd);
+    diff(GimbalX,        a.gimbalX,        b.gimbalX);
+    diff(GimbalY,        a.gimbalY,        b.gimbalY);
+    diff(Velocity,       a.velocity,       b.velocity);
+    diff(FlightState,    a.flightState,    b.flightState);
+    diff(UptimeMs,       a.uptimeMs,       b.uptimeMs);
+    diff(AccelOk,        a.accelOk,        b.accelOk);
+    diff(GyroOk,         a.gyroOk,         b.gyroOk);
+    diff(Baro1Ok,        a.baro1Ok,        b.baro1Ok);
+    diff(Baro2Ok,        a.baro2Ok,        b.baro2Ok);
+    diff(GpsConnected,   a.gpsConnected,   b.gpsConnected);
+    diff(RadioRxCount,   a.radioRxCount,   b.radioRxCount);
+    diff(RadioTxCount,   a.radioTxCount,   b.radioTxCount);
+    diff(CmdRxCount,     a.cmdRxCount,     b.cmdRxCount);
+    return m;
+}
+
+void SensorDataModel::commitState(const TelemetrySnapshot& snap, quint32 touched)
+{
+    const quint32 changed = diffMask(m_state, snap);
+    m_state = snap; // Getters always return the latest value; only the notification waits.
+
+    // Suppressed = would have notified before, but the value is unchanged or already pending.
+    const quint32 suppressed = (touched & ~changed) | (changed & m_dirty);
+    for (quint32 bits = suppressed; bits; bits &= bits - 1)
+        ++m_suppressed[size_t(qCountTrailingZeroBits(bits))];
+    m_notifySuppressed += quint64(qPopulationCount(suppressed));
+
+    if (!changed)
+        return;
+    m_dirty |= changed;
+
+    if (!m_coalesce) {
+        flushNotifications();
+        return;
+    }
+    if (m_frameWindow && m_frameWindow->isExposed()) {
+        m_frameWindow->requestUpdate();   // Flushed from afterAnimating() of that frame.
+        // Backstop: an exposed window may still skip frames (occluded, compositor throttling).
+        if (!m_flushTimer.isActive())
+            m_flushTimer.start(kBackstopFlushMs);
+    } else if (!m_flushTimer.isActive()) {
+        m_flushTimer.start(kTimerFlushMs);  // Minimized or hidden windows never animate.
+    }
+}
+
+void SensorDataModel::flushNotifications()
+{
+    m_flushTimer.stop();
+    if (!m_dirty)
+        return;
+
+    // Clear first: a slot reacting to a signal may change state again.
+    const quint32 dirty = m_dirty;
+    m_dirty = 0;
+    ++m_notifyFlushes;
+
+    // The render-side latency of the records behind this flush starts here, not at the drain.
+    if (m_latency)
+        m_latency->modelUpdated(monotonicNs());
+
+    for (quint32 bits = dirty; bits; bits &= bits - 1)
+        emitFieldChanged(int(qCountTrailingZeroBits(bits)));
+    m_notifyEmitted += quint64(qPopulationCount(dirty));
+
+    if (dirty & kKalmanFields)    emit kalmanDataChanged();
+    if (dirty & kBaroFields)      emit baroDataChanged();
+    if (dirty & kTelemetryFields) emit telemetryDataChanged();
+    if (dirty & kEngineFields)    emit engineDataChanged();
+    if (dirty & kStatusFields)    emit statusReceived();
+
+    emit notifyStatsChanged();
+}
+
+void SensorDataModel::emitFieldChanged(int field)
+{
+    switch (field) {
+    case Altitude:       emit altitudeChanged(); break;
+    case PosX:           emit posXChanged(); break;
+    case PosY:           emit posYChanged(); break;
+    case RawAngleX:      emit rawAngleXChanged(); break;
+    case FilteredAngleX: emit filteredAngleXChanged(); break;
+    case RawAngleY:      emit rawAngleYChanged(); break;
+    case FilteredAngleY: emit filteredAngleYChanged(); break;
+    case RawAngleZ:      emit rawAngleZChanged(); break;
+    case FilteredAngleZ: emit filteredAngleZChanged(); break;
+    case ThrustCmd:      emit thrustCmdChanged(); break;
+    case GimbalX:        emit gimbalXChanged(); break;
+    case GimbalY:        emit gimbalYChanged(); break;
+    case Velocity:       emit velocityChanged(); break;
+    case FlightState:    emit flightStateChanged(); break;
+    case UptimeMs:       emit uptimeMsChanged(); break;
+    case AccelOk:        emit accelOkChanged(); break;
+    case GyroOk:         emit gyroOkChanged(); break;
+    case Baro1Ok:        emit baro1OkChanged(); break;
+    case Baro2Ok:        emit baro2OkChanged(); break;
+    case GpsConnected:   emit gpsConnectedChanged(); break;
+    case RadioRxCount:   emit radioRxCountChanged(); break;
+    case RadioTxCount:   emit radioTxCountChanged(); break;
+    case CmdRxCount:     emit cmdRxCountChanged(); break;
+    default: break;
     }
 }
+
+void SensorDataModel::setCoalesceNotifications(bool on)
+{
+    if (on == m_coalesce)
+        return;
+    m_coalesce = on;
+    if (!on)
+        flushNotifications();
+    emit coalesceNotificationsChanged();
+}
+
+void SensorDataModel::setFrameWindow(QQuickWindow* window)
+{
+    if (m_frameWindow)
+        QObject::disconnect(m_frameWindow, &QQuickWindow::afterAnimating, this, nullptr);
+    m_frameWindow = window;
+    if (window) {
+        // afterAnimating() runs on the GUI thread right before the scene graph sync, so
+        // bindings updated here land in the frame being prepared.
+        QObject::connect(window, &QQuickWindow::afterAnimating,
+                         this, &SensorDataModel::flushNotifications);
+    }
+}
+
+QVariantMap SensorDataModel::suppressedByField() const
+{
+    static const char* const names[FieldCount] = {
+        "altitude", "posX", "posY",
+        "rawAngleX", "filteredAngleX", "rawAngleY", "filteredAngleY", "rawAngleZ", "filteredAngleZ",
+        "thrustCmd", "gimbalX", "gimbalY",
+        "velocity",
+        "flightState", "uptimeMs", "accelOk", "gyroOk", "baro1Ok", "baro2Ok", "gpsConnected",
+        "radioRxCount", "radioTxCount", "cmdRxCount",
+    };
+    QVariantMap out;
+    for (int f = 0; f < FieldCount; ++f)
+        out.insert(QString::fromLatin1(names[f]), m_suppressed[size_t(f)]);
+    return out;
+}
+
+void SensorDataModel::resetNotifyStats()
+{
+    m_notifyEmitted = m_notifySuppressed = m_notifyFlushes = 0;
+    m_suppressed.fill(0);
+    emit notifyStatsChanged();
+}
@@ -1,127 +1,248 @@
 #include "SerialBridge.h"
+#include "PortDiscovery.h"
 #include <QObject>
 #include <QSerialPort>
 #include <QSerialPortInfo>
-#include <QElapsedTimer>
+#include <QMetaMethod>
 #include <QThread>
 #include <QDebug>
+#include <algorithm>
 
 namespace {
 enum { kSerialDebug = 0 }; // flip to 1 to re-enable verbose IMU logging
 }
 
 SerialBridge::SerialBridge(QObject* parent) : QObject(parent) {
-    refreshPorts(); // Build the initial COM list so the UI has something to show.
+    // All port I/O, framing and decoding happens on m_ioThread; this object stays on the
+    // GUI thread and only forwards requests / re-emits results.
+    m_ioThread.setObjectName(QStringLiteral("SerialIO"));
+    m_worker = new SerialWorker;
+    m_worker->moveToThread(&m_ioThread);
+    connect(&m_ioThread, &QThread::finished, m_worker, &QObject::deleteLater);
+
+    connect(m_worker, &SerialWorker::recordsAvailable, this, &SerialBridge::downlinkAvailable,
+            Qt::QueuedConnection);
+    connect(m_worker, &SerialWorker::textReceivedFrom, this, &SerialBridge::textReceivedFrom,
+            Qt::QueuedConnection);
+    connect(m_worker, &SerialWorker::errorMessage, this, &SerialBridge::errorMessage,
+            Qt::QueuedConnection);
+    connect(m_worker, &SerialWorker::writeFinished, this, [this](quint64 id, int, int result) {
+        if (TxCallback done = m_txCallbacks.take(id))
+            done(result);
+    }, Qt::QueuedConnection);
+    connect(m_worker, &SerialWorker::linkStatsUpdated, this, [this](const QVariantList& stats) {
+        m_linkStats = stats;
+        emit linksChanged();
+    }, Qt::QueuedConnection);
+    connect(m_worker, &SerialWorker::diversityStatsUpdated, this, [this](const QVariantMap& stats) {
+        m_diversity = stats;   // Arrives just before the link stats; notified with them.
+    }, Qt::QueuedConnection);
+
+    m_ioThread.start();
+
+    // Port discovery has its own thread: enumeration and AT probes may take seconds.
+    m_discoveryThread.setObjectName(QStringLiteral("PortDiscovery"));
+    m_discovery = new PortDiscovery;
+    m_discovery->moveToThread(&m_discoveryThread);
+    connect(&m_discoveryThread, &QThread::started, m_discovery, &PortDiscovery::start);
+    connect(&m_discoveryThread, &QThread::finished, m_discovery, &QObject::deleteLater);
+    connect(m_discovery, &PortDiscovery::portAdded, this, &SerialBridge::onPortAdded,
+            Qt::QueuedConnection);
+    connect(m_discovery, &PortDiscovery::portRemoved, this, &SerialBridge::onPortRemoved,
+            Qt::QueuedConnection);
+    m_discoveryThread.start();
 }
 
-bool SerialBridge::looksLikeRadio(const QSerialPortInfo& info) {
-    const auto vid = info.vendorIdentifier();
-    const auto pid = info.productIdentifier();
-    const QString desc = info.description().toLower();
-    const QString mfg = info.manufacturer().toLower();
+SerialBridge::~SerialBridge() {
+    m_discoveryThread.quit();
+    m_discoveryThread.wait();
+    m_ioThread.quit();
+    m_ioThread.wait();
+}
 
-    // Quickly reject typical Bluetooth virtual COM ports.
-    if (desc.contains("bluetooth") || mfg.contains("bluetooth"))
-        return false;
+void SerialBridge::connectNotify(const QMetaMethod& signal) {
+    if (signal != QMetaMethod::fromSignal(&SerialBridge::binaryPacketReceived) || m_rawFrameForward)
+        return;
+    m_rawFrameForward = connect(m_worker, &SerialWorker::frameReceived,
+                                this, &SerialBridge::binaryPacketReceived, Qt::QueuedConnection);
+}
 
-    // Known USB–UART bridge IDs commonly used for RFD/SiK radios.
-    if ((vid == 0x0403 && pid == 0x6001) ||   // FTDI FT232R
-        (vid == 0x10C4 && pid == 0xEA60)) {   // SiLabs CP210x
-        return true;
+void SerialBridge::disconnectNotify(const QMetaMethod& signal) {
+    if (signal != QMetaMethod::fromSignal(&SerialBridge::binaryPacketReceived))
+        return;
+    if (!isSignalConnected(signal)) {
+        QObject::disconnect(m_rawFrameForward);
+        m_rawFrameForward = {};
     }
+}
 
-    // Fuzzy match against common USB–UART manufacturer strings.
-    if (desc.contains("ftdi") || desc.contains("silicon labs") ||
-        mfg.contains("ftdi")  || mfg.contains("silicon labs"))
-        return true;
+void SerialBridge::setMaxFrameSize(int bytes) {
+    QMetaObject::invokeMethod(m_worker, [w = m_worker, bytes] { w->setMaxFrameSize(bytes); },
+                              Qt::QueuedConnection);
+}
+
+void SerialBridge::setDiversity(bool enabled) {
+    QMetaObject::invokeMethod(m_worker, [w = m_worker, enabled] { w->setDiversity(enabled); },
+                              Qt::QueuedConnection);
+}
+
+void SerialBridge::setLinkVehicle(int which, int vehicle) {
+    QMetaObject::invokeMethod(m_worker, [w = m_worker, which, vehicle] { w->setLinkVehicle(which, vehicle); },
+                              Qt::QueuedConnection);
+}
+
+void SerialBridge::setIoThreadTuning(int cpu, int rtPriority) {
+    QMetaObject::invokeMethod(m_worker, [w = m_worker, cpu, rtPriority] {
+        w->applyThreadTuning(cpu, rtPriority);
+    }, Qt::QueuedConnection);
+}
 
-    // Anything else is ignored until an explicit probe says otherwise.
-    return false;
+void SerialBridge::injectFrames(const uchar* base, const InjectedFrame* frames, size_t count, bool primed,
+                                std::function<void()> done) {
+    // The bridge outlives the I/O thread (see the destructor), so posting back to it is safe.
+    QMetaObject::invokeMethod(m_worker, [this, w = m_worker, base, frames, count, primed,
+                                         done = std::move(done)] {
+        for (size_t i = 0; i < count; ++i)
+            w->injectFrame(frames[i].port, base + frames[i].offset, frames[i].size, primed);
+        if (done)
+            QMetaObject::invokeMethod(this, done, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+}
+
+void SerialBridge::waitInjected() {
+    // Queued calls run in order: once this one returns, every earlier batch has.
+    QMetaObject::invokeMethod(m_worker, [] {}, Qt::BlockingQueuedConnection);
 }
 
 void SerialBridge::refreshPorts() {
-    QStringList list;
-    for (const QSerialPortInfo& info : QSerialPortInfo::availablePorts()) {
-        if (looksLikeRadio(info))
-            list << info.portName(); // Only keep ports that pass the heuristic filter.
-    }
+    QMetaObject::invokeMethod(m_discovery, &PortDiscovery::rescan, Qt::QueuedConnection);
+}
 
-    // Only notify QML if the list actually changed (prevents unnecessary UI churn).
-    if (list != m_ports) {
-        m_ports = list;
+void SerialBridge::onPortAdded(const QString& name, const QString& serial, const QString& ident) {
+    m_portInfo.insert(name, QVariantMap {
+        { QStringLiteral("serial"), serial },
+        { QStringLiteral("ident"),  ident },
+    });
+    if (!m_ports.contains(name)) {
+        m_ports.insert(std::lower_bound(m_ports.begin(), m_ports.end(), name), name);
         emit portsChanged();
     }
-}
 
-SerialBridge::PortBundle SerialBridge::bundle(int which) {
-    if (which == 1) {
-        return PortBundle{ m_p1, m_rx1_buffer, m_readyConnect1, m_error1 };
-    } else {
-        return PortBundle{ m_p2, m_rx2_buffer, m_readyConnect2, m_error2 };
+    // A link whose radio was unplugged comes back on the same device, even under a new name.
+    for (auto it = m_lostLinks.begin(); it != m_lostLinks.end(); ++it) {
+        if ((!serial.isEmpty() && it->serial == serial) || it->name == name) {
+            const int which = it.key();
+            const int baud = it->baud;
+            m_lostLinks.erase(it);
+            if (connectPort(which, name, baud))
+                qInfo("Link %d reconnected on %s", which, qPrintable(name));
+            break;
+        }
     }
 }
 
-bool SerialBridge::openPort(QSerialPort& port, const QString& name, int baud) {
-    if (port.isOpen())
-        port.close(); // Ensure we start from a clean state.
-
-    port.setPortName(name);
-    port.setBaudRate(baud);
-    port.setDataBits(QSerialPort::Data8);
-    port.setParity(QSerialPort::NoParity);
-    port.setStopBits(QSerialPort::OneStop);
-    port.setFlowControl(QSerialPort::NoFlowControl); // Change if using hardware flow control.
+void SerialBridge::onPortRemoved(const QString& name) {
+    m_portInfo.remove(name);
+    if (m_ports.removeOne(name))
+        emit portsChanged();
 
-    if (!port.open(QIODevice::ReadWrite)) {
-        emitError(QStringLiteral("Failed to open %1: %2").arg(name, port.errorString()));
-        return false;
+    for (auto it = m_linkState.cbegin(); it != m_linkState.cend(); ++it) {
+        if (it->open && it->name == name) {
+            const int which = it.key();
+            const PortState st = *it;
+            disconnectPort(which);
+            m_lostLinks.insert(which, st); // After disconnectPort(), which forgets lost links.
+            emitError(QStringLiteral("P%1: %2 was unplugged; it reconnects when it returns.")
+                      .arg(which).arg(name));
+            break;
+        }
     }
-    return true;
+}
+
+bool SerialBridge::updateBusyPorts(const QString& opening) {
+    QStringList busy;
+    for (const PortState& st : std::as_const(m_linkState))
+        if (st.open)
+            busy << st.name;
+    if (!opening.isEmpty())
+        busy << opening;
+
+    // Thread-safe call: the discovery thread may be busy enumerating or probing for a while.
+    return m_discovery->setBusyPorts(busy);
 }
 
 bool SerialBridge::connectPort(int which, const QString& name, int baud) {
-    // Prevent assigning the same OS port to both “P1” and “P2”.
-    if (which == 1 && m_p2.isOpen() && m_p2.portName() == name) {
-        emitError(QStringLiteral("Port %1 is already assigned to P2. Disconnect P2 first.").arg(name));
+    if (which <= 0) {
+        emitError(QStringLiteral("connectPort: invalid link id %1").arg(which));
         return false;
     }
-    if (which == 2 && m_p1.isOpen() && m_p1.portName() == name) {
-        emitError(QStringLiteral("Port %1 is already assigned to P1. Disconnect P1 first.").arg(name));
+
+    // Prevent assigning the same OS port to two links.
+    for (auto it = m_linkState.cbegin(); it != m_linkState.cend(); ++it) {
+        if (it.key() != which && it->open && it->name == name) {
+            emitError(QStringLiteral("Port %1 is already assigned to P%2. Disconnect P%2 first.")
+                      .arg(name).arg(it.key()));
+            return false;
+        }
+    }
+
+    // An explicit connect replaces a pending reconnect; a probe must let go of the port.
+    // It may first have to take the radio out of command mode: don't wait for that here.
+    m_lostLinks.remove(which);
+    if (!updateBusyPorts(name)) {
+        updateBusyPorts(); // Not ours yet: leave it to discovery again.
+        emitError(QStringLiteral("Port %1 is still being identified; connect again in a moment.")
+                  .arg(name));
         return false;
     }
 
-    auto b = bundle(which);
-    if (!openPort(b.port, name, baud))
+    // Opening is short; block until the I/O thread reports back so QML gets a real answer.
+    bool ok = false;
+    QString description;
+    QMetaObject::invokeMethod(m_worker, [w = m_worker, which, name, baud, &ok, &description] {
+        ok = w->openLink(which, name, baud, &description);
+    }, Qt::BlockingQueuedConnection);
+    if (!ok) {
+        updateBusyPorts();
         return false;
+    }
+
+    PortState& st = m_linkState[which];
+    st.open = true;
+    st.name = description.isEmpty() ? name : description; // e.g. "pty" → "/dev/pts/7"
+    st.baud = baud;
+    st.serial = m_portInfo.value(st.name).value(QStringLiteral("serial")).toString();
+    updateBusyPorts();
 
     emit connectedChanged(which, true);
     emit portNameChanged(which);
     emit baudChanged(which);
-
-    // Attach RX handlers for this port (can listen on both ports).
-    attachRx(which);
-
+    emit linksChanged();
     return true;
 }
 
 void SerialBridge::disconnectPort(int which) {
-    auto b = bundle(which);
-    if (b.port.isOpen()) {
-        b.port.close();
-    }
+    QMetaObject::invokeMethod(m_worker, [w = m_worker, which] {
+        w->closeLink(which);
+    }, Qt::BlockingQueuedConnection);
 
-    // Remove signal connections so we don’t read from a closed port.
-    detachRx(which);
+    m_lostLinks.remove(which);
+    if (m_linkState.remove(which) == 0)
+        return;
+    updateBusyPorts();
     emit connectedChanged(which, false);
+    emit linksChanged();
 }
 
-bool SerialBridge::setTxTo(int which) {
-    if (which != 1 && which != 2) {
-        emitError("setTxTo: which must be 1 or 2");
-        return false;
-    }
+int SerialBridge::addLink(const QString& spec, int baud) {
+    int id = 3; // 1 and 2 stay reserved for the P1/P2 panels.
+    while (m_linkState.contains(id))
+        ++id;
+    return connectPort(id, spec, baud) ? id : -1;
+}
 
-    if (!bundle(which).port.isOpen()) {
+bool SerialBridge::setTxTo(int which) {
+    if (!isConnected(which)) {
         emitError("setTxTo: selected port is not open");
         return false;
     }
@@ -136,11 +257,6 @@ bool SerialBridge::setTxTo(int which) {
 }
 
 bool SerialBridge::setRxFrom(int which) {
-    if (which != 1 && which != 2) {
-        emitError("setTxTo: which must be 1 or 2");
-        return false;
-    }
-
     if (!isConnected(which)) {
         emitError("setRxFrom: selected port is not open");
         return false;
@@ -149,180 +265,72 @@ bool SerialBridge::setRxFrom(int which) {
     if (m_rxFrom == which)
         return true;
 
-    // Switch RX source and move handlers over to the new port.
-    detachRx(which);
+    // Switch RX source; the worker uses it to decide when TX must pause RX.
     m_rxFrom = which;
-    attachRx(which);
+    QMetaObject::invokeMethod(m_worker, [w = m_worker, which] { w->setRxFrom(which); },
+                              Qt::QueuedConnection);
     emit rxFromChanged();
     return true;
 }
 
-void SerialBridge::attachRx(int which) {
-    auto b = bundle(which);
-
-    // Reconnect error handler for this port.
-    QObject::disconnect(b.errorConnect);
-    b.errorConnect = connect(
-        &b.port, &QSerialPort::errorOccurred, this,
-        [this, which](QSerialPort::SerialPortError e) { handleError(which, e); }
-        );
-
-    // Reconnect readyRead handler for this port.
-    QObject::disconnect(b.readyConnect);
-    b.readyConnect = connect(
-        &b.port, &QIODevice::readyRead, this,
-        [this, which] { handleReadyRead(which); }
-        );
-}
-
-void SerialBridge::detachRx(int which) {
-    auto b = bundle(which);
-    QObject::disconnect(b.readyConnect);
-    QObject::disconnect(b.errorConnect);
-}
-
-void SerialBridge::beginRxPause(int ms) {
-    m_rxPaused = true;
-    m_rxPauseMs = ms;
-    m_rxPauseTimer.restart(); // Start timing the pause window.
-}
-
-void SerialBridge::endRxPause() {
-    m_rxPaused = false;
-    m_rxPauseMs = 0;
-}
-
-bool SerialBridge::sendText(int which, const QString& text) {
-    auto b = bundle(which);
-    if (!b.port.isOpen()) {
+bool SerialBridge::sendText(int which, const QString& text, int priority, const QString& coalesceKey) {
+    if (!isConnected(which)) {
         emitError(QString("sendTextOn: P%1 not open").arg(which));
         return false;
     }
 
-    // If TX and RX share the same physical port, we temporarily pause RX while we TX.
-    const bool shared = (which == m_rxFrom);
-
     QString line = text;
     if (!line.endsWith('\n'))
         line.append('\n'); // Normalize to LF-terminated lines for the receiver/parser.
 
-    const QByteArray bytes = line.toUtf8();
-
-    int estMs = 0;
-    if (shared) {
-        // Rough TX-time estimate: bytes * 10 bits / baud → ms, clamped to a small range.
-        const int baud = b.port.baudRate();
-        const int nbytes = bytes.size();
-        double t_ms = (baud > 0)
-                          ? (double(nbytes) * 10.0 * 1000.0 / double(baud))
-                          : 2.0;
-        estMs = qBound(1, int(qCeil(t_ms)) + 1, 10);
-        beginRxPause(estMs);
-    }
+    return send(which, line.toUtf8(), true, priority, coalesceKey.toUtf8()) != 0;
+}
 
-    const qint64 n = b.port.write(bytes);
-    if (n < 0) {
-        emitError(QStringLiteral("Write failed on P%1: %2").arg(which).arg(b.port.errorString()));
-        if (shared)
-            endRxPause();
+bool SerialBridge::sendBinary(int which, const QByteArray& data, int priority, const QString& coalesceKey) {
+    if (!isConnected(which)) {
+        emitError(QString("sendBinary: P%1 not open").arg(which));
         return false;
     }
-
-    b.port.flush();
-    b.port.waitForBytesWritten(10); // Short blocking wait to push bytes out.
-
-    if (shared) {
-        endRxPause();
-        parseBufferedBinary(which);  // Process anything that arrived during the pause.
-    }
-    return true;
-}
-
-void SerialBridge::handleReadyRead(int which) {
-    auto b = bundle(which);
-    b.rxBuf.append(b.port.readAll());
-
-    // While TX pause is active we only accumulate data, we don't parse yet.
-    if (isRxPause())
-        return;
-
-    // Parse as binary COBS packets (0x00-delimited). Sender uses COBS+protobuf, not text.
-    parseBufferedBinary(which);
+    return send(which, data, false, priority, coalesceKey.toUtf8()) != 0;
 }
 
-void SerialBridge::parseBufferedLines(int which) {
-    auto b = bundle(which);
-
-    // Grab any remaining bytes in case readyRead fired again between calls.
-    b.rxBuf.append(b.port.readAll());
-
-    int idx;
-    // Consume full lines terminated by '\n'; keep partial line in buffer.
-    while ((idx = b.rxBuf.indexOf('\n')) != -1) {
-        QByteArray line = b.rxBuf.left(idx);
-
-        // Convert CRLF → LF by dropping trailing '\r'.
-        if (!line.isEmpty() && line.endsWith('\r')) {
-            line.chop(1);
-        }
-
-        // Remove this line (and its '\n') from the buffer.
-        b.rxBuf.remove(0, idx + 1);
-
-        // Prefer UTF-8; fall back to Latin-1 if decoding fails.
-        QString text = QString::fromUtf8(line);
-        if (text.isNull()) {
-            text = QString::fromLatin1(line);
-        }
-
-        // Emit a clean logical line to whoever is listening (QML, alarm system, etc.).
-        emit textReceivedFrom(which, text);
+quint64 SerialBridge::send(int which, const QByteArray& bytes, bool text, int priority,
+                           const QByteArray& coalesceKey, TxCallback done) {
+    if (!isConnected(which))
+        return 0;
+
+    const quint64 id = m_nextTxId++;
+    TxQueue::Message msg;
+    msg.data = bytes;
+    msg.key  = coalesceKey;
+    msg.text = text;
+    if (done) {
+        // Only messages somebody waits for travel with an id, so the worker signals them.
+        msg.id = id;
+        m_txCallbacks.insert(id, std::move(done));
     }
-}
-
-void SerialBridge::parseBufferedBinary(int which) {
-    auto b = bundle(which);
-
-    b.rxBuf.append(b.port.readAll());
-
-    // COBS packets are delimited by 0x00. Consume each complete packet.
-    int idx;
-    while ((idx = b.rxBuf.indexOf('\0')) != -1) {
-        // Packet is from start up to and including the delimiter (COBS decode expects it).
-        QByteArray packet = b.rxBuf.left(idx + 1);
-        b.rxBuf.remove(0, idx + 1);
 
-        if (!packet.isEmpty()) {
-            emit binaryPacketReceived(which, packet);
-        }
-    }
+    // Hand off to the I/O thread's queue; nothing here waits for the transport.
+    QMetaObject::invokeMethod(m_worker, [w = m_worker, which, priority, msg = std::move(msg)]() mutable {
+        w->enqueueWrite(which, priority, std::move(msg));
+    }, Qt::QueuedConnection);
+    return id;
 }
 
-void SerialBridge::handleError(int which, QSerialPort::SerialPortError e) {
-    // Ignore benign notifications.
-    if (e == QSerialPort::NoError || e == QSerialPort::TimeoutError)
-        return;
-
-    auto& p = (which == 1) ? m_p1 : m_p2;
-    emitError(QStringLiteral("Serial error on P%1: %2").arg(which).arg(p.errorString()));
+void SerialBridge::post(int which, const QByteArray& bytes, bool text, int priority,
+                        const QByteArray& coalesceKey) {
+    // Only touches m_worker, which is fixed for the bridge's lifetime.
+    TxQueue::Message msg;
+    msg.data = bytes;
+    msg.key  = coalesceKey;
+    msg.text = text;
+    QMetaObject::invokeMethod(m_worker, [w = m_worker, which, priority, msg = std::move(msg)]() mutable {
+        w->enqueueWrite(which, priority, std::move(msg));
+    }, Qt::QueuedConnection);
 }
 
-
-bool SerialBridge::sendBinary(int which, const QByteArray& data) {
-    auto b = bundle(which);
-    if (!b.port.isOpen()) {
-        emitError(QString("sendBinary: P%1 not open").arg(which));
-        return false;
-    }
-    
-    const qint64 n = b.port.write(data);
-    if (n < 0) {
-        emitError(QStringLiteral("Binary write failed on P%1: %2")
-                  .arg(which).arg(b.port.errorString()));
-        return false;
-    }
-    
-    b.port.flush();
-    b.port.waitForBytesWritten(10);
-    return true;
+void SerialBridge::setTxLimit(int priority, int depth, int policy) {
+    QMetaObject::invokeMethod(m_worker, [w = m_worker, priority, depth, policy] {
+        w->setTxLimit(priority, depth, policy);
+    }, Qt::QueuedConnection);
 }
@@ -0,0 +1,36 @@
+#include "SerialTransport.h"
+
+SerialTransport::SerialTransport(const QString& portName, int baud, QObject* parent)
+    : Transport(parent), m_port(this)
+{
+    m_port.setPortName(portName);
+    m_port.setBaudRate(baud);
+    m_port.setDataBits(QSerialPort::Data8);
+    m_port.setParity(QSerialPort::NoParity);
+    m_port.setStopBits(QSerialPort::OneStop);
+    m_port.setFlowControl(QSerialPort::NoFlowControl); // Change if using hardware flow control.
+
+    connect(&m_port, &QIODevice::readyRead, this, &Transport::readyRead);
+    connect(&m_port, &QIODevice::bytesWritten, this, &Transport::bytesWritten);
+    connect(&m_port, &QSerialPort::errorOccurred, this, [this](QSerialPort::SerialPortError e) {
+        // Ignore benign notifications.
+        if (e == QSerialPort::NoError || e == QSerialPort::TimeoutError)
+            return;
+        emit errorOccurred(m_port.errorString());
+    });
+}
+
+bool SerialTransport::open() {
+    if (m_port.isOpen())
+        m_port.close(); // Ensure we start from a clean state.
+    return m_port.open(QIODevice::ReadWrite);
+}
+
+void SerialTransport::close() {
+    if (m_port.isOpen())
+        m_port.close();
+}
+
+void SerialTransport::flush() {
+    m_port.flush(); // Writes what the driver takes now; the rest drains via bytesWritten().
+}
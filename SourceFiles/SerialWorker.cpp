@@ -0,0 +1,544 @@
+#include "SerialWorker.h"
+#include "AllocCounter.h"
+#include "FlightRecorder.h"
+#include <QMetaMethod>
+#include <QVariantMap>
+#include <QThread>
+#include <QtMath>
+#include <algorithm>
+#include <cstring>
+extern "C" {
+    #include "rp/codec.h"
+}
+
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+const tvr_Downlink kEmptyDownlink = tvr_Downlink_init_default;
+
+/// Sender timestamp of a decoded packet (diversity key, with the payload type).
+quint32 timestampOf(const tvr_Downlink& d) {
+    if (d.which_payload == tvr_Downlink_telemetry_tag)
+        return d.payload.telemetry.timestamp_ms;
+    if (d.which_payload == tvr_Downlink_status_tag)
+        return d.payload.status.timestamp_ms;
+    return 0;
+}
+
+/// A link quiet this long no longer has a frame in flight: pending text lines are text.
+constexpr int kTextIdleMs = 30;
+}
+
+SerialWorker::SerialWorker(QObject* parent)
+    : QObject(parent), m_statsTimer(this), m_textIdleTimer(this), m_probe(kEmptyDownlink) {
+    // The timers are children so moveToThread() carries them onto the I/O thread with us.
+    m_statsTimer.setInterval(1000);
+    connect(&m_statsTimer, &QTimer::timeout, this, &SerialWorker::publishLinkStats);
+    m_textIdleTimer.setSingleShot(true);
+    m_textIdleTimer.setInterval(kTextIdleMs);
+    connect(&m_textIdleTimer, &QTimer::timeout, this, &SerialWorker::flushIdleText);
+}
+
+SerialWorker::Link* SerialWorker::link(int which) {
+    for (auto& l : m_links)
+        if (l->id == which)
+            return l.get();
+    return nullptr;
+}
+
+const SerialWorker::Link* SerialWorker::link(int which) const {
+    for (const auto& l : m_links)
+        if (l->id == which)
+            return l.get();
+    return nullptr;
+}
+
+bool SerialWorker::isOpen(int which) const {
+    const Link* l = link(which);
+    return l && l->transport->isOpen();
+}
+
+bool SerialWorker::openLink(int which, const QString& spec, int baud, QString* description) {
+    closeLink(which); // Ensure we start from a clean state.
+
+    auto l = std::make_unique<Link>();
+    l->id = which;
+    l->vehicle = vehicleOf(which);
+    l->spec = spec;
+    l->rx.setMaxFrame(m_maxFrame);
+    for (int p = 0; p < TxQueue::PriorityCount; ++p)
+        if (m_txLimits[size_t(p)].first > 0)
+            l->txq.setLimit(TxQueue::Priority(p), m_txLimits[size_t(p)].first,
+                            TxQueue::Policy(m_txLimits[size_t(p)].second));
+    l->transport = Transport::create(spec, baud, this);
+
+    if (!l->transport->open()) {
+        emit errorMessage(QStringLiteral("Failed to open %1: %2").arg(spec, l->transport->errorString()));
+        delete l->transport;
+        return false;
+    }
+
+    connect(l->transport, &Transport::readyRead, this, [this, which] { handleReadyRead(which); });
+    connect(l->transport, &Transport::bytesWritten, this, [this, which] { pumpTx(which); });
+    connect(l->transport, &Transport::errorOccurred, this, [this, which](const QString& msg) {
+        emit errorMessage(QStringLiteral("Link %1 error: %2").arg(which).arg(msg));
+    });
+    if (description)
+        *description = l->transport->describe();
+
+    // Keep links sorted by id so isPrimary()/stats iterate in a stable order.
+    auto at = std::find_if(m_links.begin(), m_links.end(),
+                           [which](const std::unique_ptr<Link>& x) { return x->id > which; });
+    m_links.insert(at, std::move(l));
+
+    if (!m_statsTimer.isActive())
+        m_statsTimer.start();
+    return true;
+}
+
+void SerialWorker::closeLink(int which) {
+    auto it = std::find_if(m_links.begin(), m_links.end(),
+                           [which](const std::unique_ptr<Link>& x) { return x->id == which; });
+    if (it == m_links.end())
+        return;
+
+    // Whatever is still queued will never go out; tell whoever waits for it.
+    std::vector<TxQueue::Message> unsent;
+    if ((*it)->txBusy)
+        unsent.push_back(std::move((*it)->txCur));
+    (*it)->txq.clear(&unsent);
+
+    Transport* t = (*it)->transport;
+    t->disconnect(this);
+    t->close();
+    t->deleteLater(); // We may be inside one of its signals.
+    m_links.erase(it);
+    for (const auto& m : unsent)
+        finishTx(which, m, TxQueue::Closed);
+
+    publishLinkStats();
+    if (m_links.empty())
+        m_statsTimer.stop();
+}
+
+void SerialWorker::setMaxFrameSize(int bytes) {
+    if (bytes <= 0)
+        return;
+    m_maxFrame = size_t(bytes);
+    for (auto& l : m_links)
+        l->rx.setMaxFrame(m_maxFrame);
+}
+
+void SerialWorker::publishLinkStats() {
+    const qint64 nowNs = monotonicNs();
+    QVariantList out;
+    out.reserve(qsizetype(m_links.size()));
+    for (const auto& l : m_links) {
+        out.append(QVariantMap {
+            { QStringLiteral("id"),            l->id },
+            { QStringLiteral("vehicle"),       l->vehicle },
+            { QStringLiteral("spec"),          l->spec },
+            { QStringLiteral("description"),   l->transport->describe() },
+            { QStringLiteral("open"),          l->transport->isOpen() },
+            { QStringLiteral("bytesRx"),       l->bytesRx },
+            { QStringLiteral("framesRx"),      l->framesRx },
+            { QStringLiteral("textLines"),     l->textLines },
+            { QStringLiteral("bytesTx"),       l->bytesTx },
+            { QStringLiteral("txErrors"),      l->txErrors },
+            { QStringLiteral("txQueued"),      qulonglong(l->txq.size() + (l->txBusy ? 1 : 0)) },
+            { QStringLiteral("txDropped"),     l->txq.dropped() },
+            { QStringLiteral("txSuperseded"),  l->txq.superseded() },
+            { QStringLiteral("oversizeDrops"), l->rx.oversizeDrops() },
+            { QStringLiteral("droppedBytes"),  l->rx.droppedBytes() },
+            { QStringLiteral("discardedBytes"), l->rx.droppedBytes() + l->badFrameBytes },
+            { QStringLiteral("quality"),       l->quality.summary(nowNs) },
+            { QStringLiteral("diversity"),     m_diversity.linkStats(l->id) },
+        });
+    }
+
+    // Combiner totals go first so listeners of linkStatsUpdated() see the matching ones.
+    QVariantMap diversity = m_diversity.summary();
+    diversity.insert(QStringLiteral("enabled"), m_diversityEnabled);
+    diversity.insert(QStringLiteral("quality"), m_combined.summary(nowNs));
+    emit diversityStatsUpdated(diversity);
+    emit linkStatsUpdated(out);
+}
+
+void SerialWorker::applyThreadTuning(int cpu, int rtPriority) {
+#ifdef Q_OS_LINUX
+    if (cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        const int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (rc != 0)
+            emit errorMessage(QStringLiteral("I/O thread: cannot pin to CPU %1: %2")
+                              .arg(cpu).arg(QString::fromLocal8Bit(std::strerror(rc))));
+    }
+    if (rtPriority > 0) {
+        sched_param sp{};
+        sp.sched_priority = qBound(sched_get_priority_min(SCHED_FIFO), rtPriority,
+                                   sched_get_priority_max(SCHED_FIFO));
+        const int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp);
+        if (rc != 0) {
+            // Usually EPERM without CAP_SYS_NICE / rtprio limits; fall back to a nice boost.
+            QThread::currentThread()->setPriority(QThread::TimeCriticalPriority);
+            emit errorMessage(QStringLiteral("I/O thread: real-time priority unavailable (%1)")
+                              .arg(QString::fromLocal8Bit(std::strerror(rc))));
+        }
+    }
+#else
+    if (cpu >= 0)
+        emit errorMessage(QStringLiteral("I/O thread: CPU pinning is only supported on Linux"));
+    if (rtPriority > 0)
+        QThread::currentThread()->setPriority(QThread::TimeCriticalPriority);
+#endif
+}
+
+void SerialWorker::beginRxPause(int ms) {
+    m_rxPaused = true;
+    m_rxPauseMs = ms;
+    m_rxPauseTimer.restart(); // Start timing the pause window.
+}
+
+void SerialWorker::endRxPause() {
+    m_rxPaused = false;
+    m_rxPauseMs = 0;
+}
+
+void SerialWorker::setTxLimit(int priority, int depth, int policy) {
+    if (priority < 0 || priority >= TxQueue::PriorityCount || depth <= 0)
+        return;
+    m_txLimits[size_t(priority)] = { depth, policy };
+    for (auto& l : m_links)
+        l->txq.setLimit(TxQueue::Priority(priority), depth, TxQueue::Policy(policy));
+}
+
+void SerialWorker::enqueueWrite(int which, int priority, TxQueue::Message msg) {
+    Link* l = link(which);
+    if (!l || !l->transport->isOpen()) {
+        emit errorMessage(QStringLiteral("%1: link %2 not open")
+                          .arg(msg.text ? QStringLiteral("sendText") : QStringLiteral("sendBinary")).arg(which));
+        finishTx(which, msg, TxQueue::Closed);
+        return;
+    }
+
+    std::vector<std::pair<TxQueue::Message, TxQueue::Result>> displaced;
+    msg.enqueuedNs = monotonicNs();
+    const quint64 id = msg.id;
+    if (!l->txq.push(TxQueue::clampPriority(priority), std::move(msg), &displaced)) {
+        TxQueue::Message refused;
+        refused.id = id;
+        finishTx(which, refused, TxQueue::Dropped);
+    }
+    for (const auto& d : displaced)
+        finishTx(which, d.first, d.second);
+
+    pumpTx(which);
+}
+
+void SerialWorker::pumpTx(int which) {
+    // A few hundred bytes in the transport keeps the line busy; everything else waits in
+    // the priority queue, where an abort can still overtake it.
+    constexpr qint64 kTxLowWater = 256;
+
+    Link* l = link(which);
+    while (l && l->transport->isOpen() && l->transport->bytesToWrite() < kTxLowWater) {
+        if (!l->txBusy) {
+            if (!l->txq.pop(&l->txCur))
+                return;
+            l->txOffset = 0;
+            l->txBusy = true;
+
+            // If TX and RX share the same physical link, pause RX for the estimated airtime.
+            if (l->txCur.text && which == m_rxFrom) {
+                // Rough TX-time estimate: bytes * 10 bits / baud → ms, clamped to a small range.
+                const int baud = l->transport->baudRate();
+                const double t_ms = (baud > 0)
+                                        ? (double(l->txCur.data.size()) * 10.0 * 1000.0 / double(baud))
+                                        : 2.0;
+                const int pauseMs = qBound(1, int(qCeil(t_ms)) + 1, 10);
+                beginRxPause(pauseMs);
+                QTimer::singleShot(pauseMs, this, [this, which] {
+                    endRxPause();
+                    if (isOpen(which))
+                        parseBuffered(which);  // Process anything that arrived during the pause.
+                });
+            }
+        }
+
+        const QByteArray& data = l->txCur.data;
+        const qint64 n = l->transport->write(data.constData() + l->txOffset, data.size() - l->txOffset);
+        if (n < 0) {
+            ++l->txErrors;
+            emit errorMessage(QStringLiteral("Write failed on link %1: %2")
+                              .arg(which).arg(l->transport->errorString()));
+            l->txBusy = false;
+            finishTx(which, l->txCur, TxQueue::Failed);
+            continue;
+        }
+
+        l->bytesTx += quint64(n);
+        l->txOffset += n;
+        if (l->txOffset < data.size())
+            return; // Transport is full; bytesWritten() resumes us.
+
+        l->txBusy = false;
+        if (!l->txCur.text)
+            l->quality.onUplinkFrame(monotonicNs());
+        finishTx(which, l->txCur, TxQueue::Sent);
+    }
+}
+
+void SerialWorker::finishTx(int which, const TxQueue::Message& msg, TxQueue::Result result) {
+    if (msg.id)
+        emit writeFinished(msg.id, which, int(result));
+}
+
+void SerialWorker::injectFrame(int which, const QByteArray& frame) {
+    injectFrame(which, reinterpret_cast<const uint8_t*>(frame.constData()), static_cast<size_t>(frame.size()));
+}
+
+void SerialWorker::injectFrame(int which, const uint8_t* data, size_t size, bool primed) {
+    if (size == 0)
+        return;
+    ULYSSES_NO_ALLOC("SerialWorker::injectFrame");
+    FrameView view;
+    view.data = data;
+    view.size = size;
+    dispatchFrame(which, view, monotonicNs(), true, primed);
+}
+
+void SerialWorker::handleReadyRead(int which) {
+    // While TX pause is active leave the bytes in the driver; they are framed once it ends.
+    if (isRxPause())
+        return;
+
+    // COBS packets (0x00-delimited), with any firmware text lines in between split out.
+    parseBuffered(which);
+}
+
+qint64 SerialWorker::fillRing(Link& l) {
+    size_t room = 0;
+    uint8_t* dst = l.rx.writeSpan(&room);
+    if (room == 0)
+        return 0;
+    const qint64 n = l.transport->read(reinterpret_cast<char*>(dst), qint64(room));
+    if (n > 0) {
+        l.rx.commit(size_t(n));
+        l.bytesRx += quint64(n);
+        l.lastRxNs = monotonicNs();
+        l.quality.onBytes(quint64(n), l.lastRxNs);
+    }
+    return n;
+}
+
+void SerialWorker::parseBuffered(int which, bool flushText) {
+    Link* l = link(which);
+    if (!l)
+        return;
+    Link& p = *l;
+    const qint64 rxNs = monotonicNs();
+    FlightRecorder* recorder = m_recorder.load(std::memory_order_acquire);
+
+    // Alternate reading and framing so a backlog larger than the ring still drains.
+    RxSegment seg;
+    qint64 n;
+    do {
+        n = fillRing(p);
+        while (p.rx.nextSegment(seg, flushText)) {
+            if (seg.text) {
+                emitTextLines(p, seg.bytes.data, seg.bytes.size);
+                continue;
+            }
+
+            FrameView frame = seg.bytes;
+            if (seg.textPrefix) {
+                // Printable lines in front of the frame: debug text glued to the next packet,
+                // or the frame's own first bytes. Whichever split decodes wins.
+                const FrameView rest { frame.data + seg.textPrefix, frame.size - seg.textPrefix };
+                if (rest.size <= 1 || decodes(rest.data, rest.size)) {
+                    emitTextLines(p, frame.data, seg.textPrefix);
+                    frame = rest;
+                }
+            }
+            if (frame.size <= 1) // A lone delimiter is inter-frame padding.
+                continue;
+            ULYSSES_NO_ALLOC("SerialWorker::parseBuffered frame");
+            ++p.framesRx;
+            p.quality.onFrame(rxNs);
+            if (recorder)        // Record live frames only; injected (replayed) ones are not.
+                recorder->record(which, rxNs, frame.data, frame.size);
+            if (dispatchFrame(which, frame, rxNs) != RP_CODEC_OK)
+                p.badFrameBytes += frame.size;
+        }
+    } while (n > 0);
+
+    // Lines with no delimiter behind them are text once the link has gone quiet.
+    if (p.rx.hasPendingText() && !m_textIdleTimer.isActive())
+        m_textIdleTimer.start();
+}
+
+void SerialWorker::flushIdleText() {
+    const qint64 nowNs = monotonicNs();
+    bool pending = false;
+    for (const auto& l : m_links) {
+        if (!l->rx.hasPendingText())
+            continue;
+        if (nowNs - l->lastRxNs >= qint64(kTextIdleMs) * 1000000)
+            parseBuffered(l->id, true);
+        else
+            pending = true;
+    }
+    if (pending)
+        m_textIdleTimer.start();
+}
+
+void SerialWorker::emitTextLines(Link& l, const uint8_t* data, size_t size) {
+    const char* bytes = reinterpret_cast<const char*>(data);
+    const char* end = bytes + size;
+    while (bytes < end) {
+        const char* nl = static_cast<const char*>(std::memchr(bytes, '\n', size_t(end - bytes)));
+        const char* eol = nl ? nl : end;
+
+        // Drop the '\n', and convert CRLF → LF by dropping a trailing '\r'.
+        qsizetype len = qsizetype(eol - bytes);
+        if (len > 0 && bytes[len - 1] == '\r')
+            --len;
+        if (len > 0) {
+            // Prefer UTF-8; fall back to Latin-1 if decoding fails.
+            QString text = QString::fromUtf8(bytes, len);
+            if (text.isNull())
+                text = QString::fromLatin1(bytes, len);
+            ++l.textLines;
+            emit textReceivedFrom(l.id, text);
+        }
+        bytes = nl ? nl + 1 : end;
+    }
+}
+
+bool SerialWorker::decodes(const uint8_t* data, size_t size) {
+    m_probe = kEmptyDownlink;
+    return rp_packet_decode(data, size, &tvr_Downlink_msg, &m_probe).status == RP_CODEC_OK;
+}
+
+int SerialWorker::dispatchFrame(int which, const FrameView& frame, qint64 rxNs, bool injected, bool primed) {
+    static const QMetaMethod frameSignal = QMetaMethod::fromSignal(&SerialWorker::frameReceived);
+    const qint64 framedNs = monotonicNs();
+
+    // Raw-frame listeners need an owning copy; skip it entirely when nobody listens.
+    if (!primed && isSignalConnected(frameSignal)) {
+        ULYSSES_ALLOC_EXEMPT();
+        emit frameReceived(which, QByteArray(reinterpret_cast<const char*>(frame.data),
+                                             qsizetype(frame.size)));
+    }
+
+    // Injected frames were already chosen by their source (replay plays one link only)
+    // and say nothing about the live link's quality. Live frames are decoded from every
+    // link when combining, else only from the primary one.
+    Link* l = injected ? nullptr : link(which);
+    const int vehicle = l ? l->vehicle : vehicleOf(which);
+    if (injected || m_diversityEnabled || isPrimary(which, vehicle))
+        return processFrame(which, vehicle, frame.data, frame.size, rxNs, framedNs,
+                            l ? &l->quality : nullptr, primed);
+    return RP_CODEC_OK; // Not decoded here.
+}
+
+bool SerialWorker::isPrimary(int which, int vehicle) const {
+    // Lowest open link id of the vehicle is its canonical telemetry source (P1 wins over P2, etc.).
+    for (const auto& l : m_links)
+        if (l->vehicle == vehicle && l->transport->isOpen())
+            return l->id == which;
+    return which == 1;     // Nothing open → treat as P1.
+}
+
+int SerialWorker::openLinks(int vehicle) const {
+    int n = 0;
+    for (const auto& l : m_links)
+        if (l->vehicle == vehicle && l->transport->isOpen())
+            ++n;
+    return n;
+}
+
+int SerialWorker::vehicleOf(int which) const {
+    for (const auto& a : m_linkVehicle)
+        if (a.first == which)
+            return a.second;
+    return 0;
+}
+
+void SerialWorker::setLinkVehicle(int which, int vehicle) {
+    auto it = std::find_if(m_linkVehicle.begin(), m_linkVehicle.end(),
+                           [which](const std::pair<int, int>& a) { return a.first == which; });
+    if (vehicle == 0) {
+        if (it != m_linkVehicle.end())
+            m_linkVehicle.erase(it);
+    } else if (it != m_linkVehicle.end()) {
+        it->second = vehicle;
+    } else {
+        m_linkVehicle.emplace_back(which, vehicle);
+    }
+    if (Link* l = link(which))
+        l->vehicle = vehicle;
+}
+
+int SerialWorker::processFrame(int which, int vehicle, const uint8_t* data, size_t size, qint64 rxNs,
+                               qint64 framedNs, LinkQuality* quality, bool primed) {
+    // Decode straight into the next queue slot; fall back to a scratch record when the
+    // UI is a full queue behind so the snapshot still reflects the newest packet.
+    DownlinkRecord* rec = m_records.beginPush();
+    const bool queued = (rec != nullptr);
+    if (!queued)
+        rec = &m_overflow;
+
+    rec->which    = which;
+    rec->vehicle  = vehicle;
+    rec->rxNs     = rxNs;
+    rec->downlink = kEmptyDownlink;
+    rec->status   = rp_packet_decode(data, size, &tvr_Downlink_msg, &rec->downlink).status;
+    rec->framedNs  = framedNs;
+    rec->decodedNs = monotonicNs();
+    rec->primed    = primed;
+    if (quality)
+        quality->onDecoded(rec->status, rec->downlink, rxNs);
+
+    // Live frames from several radios: only the first copy of each packet goes on. An
+    // uncommitted queue slot is simply reused by the next frame. A lone link has nothing
+    // to combine with.
+    if (rec->status == RP_CODEC_OK && quality && m_diversityEnabled) {
+        if (openLinks(vehicle) > 1 &&
+            !m_diversity.offer(which, vehicle, int(rec->downlink.which_payload),
+                               timestampOf(rec->downlink), rxNs))
+            return rec->status;
+        if (vehicle == 0) {
+            m_combined.onFrame(rxNs);
+            m_combined.onDecoded(rec->status, rec->downlink, rxNs);
+        }
+    }
+
+    // The snapshot is the default vehicle's; the others are tracked by VehicleRouter.
+    if (rec->status == RP_CODEC_OK && vehicle == 0) {
+        m_state.apply(rec->downlink);
+        m_snapshot.publish(m_state);
+    }
+
+    if (queued) {
+        m_records.endPush();
+        if (!m_notifyPending.exchange(true, std::memory_order_acq_rel)) {
+            ULYSSES_ALLOC_EXEMPT(); // Queued event: once per GUI drain, not per frame.
+            emit recordsAvailable();
+        }
+    } else {
+        m_droppedRecords.fetch_add(1, std::memory_order_relaxed);
+    }
+    return rec->status;
+}
+
+void SerialWorker::setDiversity(bool enabled) {
+    m_diversityEnabled = enabled;
+    m_diversity.reset();
+    m_combined.reset();
+}
@@ -0,0 +1,255 @@
+#include "TelemetryAlarms.h"
+#include "AlarmRules.h"
+#include "AllocCounter.h"
+
+#include <QVariantMap>
+#include <algorithm>
+#include <cmath>
+
+extern "C" {
+    #include "rp/codec.h"
+}
+
+namespace {
+constexpr int kClockMs = 100;
+
+/// Built-in rules. Gimbal limits assume ±5 deg of travel; adjust with configure().
+struct RuleSpec {
+    const char* name;
+    int    input;
+    bool   above;
+    double raiseAt;
+    double clearAt;
+    int    debounceMs;
+    int    severity;
+    const char* raiseText;
+    const char* clearText;
+};
+} // namespace
+
+TelemetryAlarms::TelemetryAlarms(QObject* parent)
+    : QObject(parent)
+{
+    static const RuleSpec kDefaults[] = {
+        { "accel",   AccelOk,        false, 0.5, 0.5,     0, AlarmRules::Error,
+          "Accelerometer fault (accel_ok dropped)", "Accelerometer OK" },
+        { "gyro",    GyroOk,         false, 0.5, 0.5,     0, AlarmRules::Error,
+          "Gyroscope fault (gyro_ok dropped)", "Gyroscope OK" },
+        { "baro1",   Baro1Ok,        false, 0.5, 0.5,     0, AlarmRules::Warning,
+          "Barometer 1 fault (baro1_ok dropped)", "Barometer 1 OK" },
+        { "baro2",   Baro2Ok,        false, 0.5, 0.5,     0, AlarmRules::Warning,
+          "Barometer 2 fault (baro2_ok dropped)", "Barometer 2 OK" },
+        { "gps",     GpsConnected,   false, 0.5, 0.5,     0, AlarmRules::Warning,
+          "GPS connection lost", "GPS connected" },
+        { "gimbal",  GimbalAbs,      true,  4.5, 4.0,   300, AlarmRules::Warning,
+          "Gimbal near saturation", "Gimbal back within range" },
+        { "tilt",    TiltRate,       true, 30.0, 20.0,  200, AlarmRules::Error,
+          "Tilt rate above limit", "Tilt rate back within limit" },
+        { "silence", TelemetryAgeMs, true, 1000.0, 300.0, 0, AlarmRules::Error,
+          "Telemetry silent", "Telemetry resumed" },
+    };
+
+    std::vector<const RuleSpec*> specs;
+    for (const RuleSpec& s : kDefaults)
+        specs.push_back(&s);
+    std::stable_sort(specs.begin(), specs.end(), [](const RuleSpec* a, const RuleSpec* b) {
+        return groupOf(a->input) < groupOf(b->input);
+    });
+
+    for (const RuleSpec* s : specs) {
+        Rule r;
+        r.input      = quint8(s->input);
+        r.above      = s->above;
+        r.raiseAt    = s->raiseAt;
+        r.clearAt    = s->clearAt;
+        r.debounceNs = qint64(s->debounceMs) * 1000000;
+        r.severity   = s->severity;
+        m_rules.push_back(r);
+        m_text.push_back({ QString::fromLatin1(s->name), QString::fromLatin1(s->raiseText),
+                           QString::fromLatin1(s->clearText) });
+    }
+
+    // Group boundaries in the sorted table.
+    for (int g = 0, i = 0; g <= GroupCount; ++g) {
+        while (i < int(m_rules.size()) && groupOf(m_rules[size_t(i)].input) < g)
+            ++i;
+        m_groupBegin[size_t(g)] = i;
+    }
+    m_groupBegin[GroupCount] = int(m_rules.size());
+
+    m_clock.setInterval(kClockMs);
+    connect(&m_clock, &QTimer::timeout, this, &TelemetryAlarms::onClock);
+    m_clock.start();
+    publish();
+}
+
+TelemetryAlarms::Group TelemetryAlarms::groupOf(int input)
+{
+    if (input <= GpsConnected)
+        return StatusGroup;
+    if (input <= TiltRate)
+        return TelemetryGroup;
+    return ClockGroup;
+}
+
+QString TelemetryAlarms::inputName(int input)
+{
+    static const char* const kNames[InputCount] = {
+        "accel_ok", "gyro_ok", "baro1_ok", "baro2_ok", "gps_connected",
+        "gimbal_abs", "tilt_rate", "telemetry_age_ms",
+    };
+    return (input >= 0 && input < InputCount) ? QString::fromLatin1(kNames[input]) : QString();
+}
+
+void TelemetryAlarms::evaluate(const DownlinkRecord& rec, const TelemetrySnapshot& state)
+{
+    if (rec.status != RP_CODEC_OK)
+        return;
+
+    const qint64 nowNs = rec.rxNs ? rec.rxNs : monotonicNs();
+    if (rec.downlink.which_payload == tvr_Downlink_status_tag) {
+        m_inputs[AccelOk]      = state.accelOk;
+        m_inputs[GyroOk]       = state.gyroOk;
+        m_inputs[Baro1Ok]      = state.baro1Ok;
+        m_inputs[Baro2Ok]      = state.baro2Ok;
+        m_inputs[GpsConnected] = state.gpsConnected;
+        for (int i = AccelOk; i <= GpsConnected; ++i)
+            m_known[size_t(i)] = true;
+        evaluateGroup(StatusGroup, nowNs);
+    } else if (rec.downlink.which_payload == tvr_Downlink_telemetry_tag) {
+        m_inputs[GimbalAbs] = std::max(std::abs(state.gimbalX), std::abs(state.gimbalY));
+        m_inputs[TiltRate]  = std::hypot(state.rawAngleX, state.rawAngleY);
+        m_known[GimbalAbs] = m_known[TiltRate] = true;
+        evaluateGroup(TelemetryGroup, nowNs);
+
+        m_lastTelemetryNs = nowNs;
+        m_inputs[TelemetryAgeMs] = 0.0;
+        m_known[TelemetryAgeMs] = true;
+        evaluateGroup(ClockGroup, nowNs);
+    }
+
+    if (m_dirty) {
+        ULYSSES_ALLOC_EXEMPT(); // Only after a transition.
+        publish();
+    }
+}
+
+void TelemetryAlarms::onClock()
+{
+    if (!m_known[TelemetryAgeMs])
+        return; // No telemetry yet: nothing has gone silent.
+
+    const qint64 nowNs = monotonicNs();
+    m_inputs[TelemetryAgeMs] = double(nowNs - m_lastTelemetryNs) / 1e6;
+    evaluateGroup(ClockGroup, nowNs);
+    if (m_dirty)
+        publish();
+}
+
+void TelemetryAlarms::evaluateGroup(int group, qint64 nowNs)
+{
+    for (int i = m_groupBegin[size_t(group)]; i < m_groupBegin[size_t(group) + 1]; ++i) {
+        Rule& r = m_rules[size_t(i)];
+        if (!r.enabled || !m_known[r.input])
+            continue;
+
+        const double v = m_inputs[r.input];
+        const bool flip = r.active ? (r.above ? v < r.clearAt : v > r.clearAt)
+                                   : (r.above ? v > r.raiseAt : v < r.raiseAt);
+        if (!flip) {
+            r.pendingNs = 0;
+            continue;
+        }
+        if (r.pendingNs == 0)
+            r.pendingNs = nowNs;
+        if (nowNs - r.pendingNs < r.debounceNs)
+            continue;
+
+        ULYSSES_ALLOC_EXEMPT(); // A transition: rare, and allowed to build its log row.
+        r.pendingNs = 0;
+        r.active = !r.active;
+        m_dirty = true;
+        if (r.active) {
+            ++r.raised;
+            ++m_activeCount;
+            emit alarmRaised(r.severity, m_text[size_t(i)].raiseText, m_text[size_t(i)].name);
+        } else {
+            --m_activeCount;
+            emit alarmCleared(AlarmRules::Success, m_text[size_t(i)].clearText, m_text[size_t(i)].name);
+        }
+    }
+}
+
+int TelemetryAlarms::find(const QString& name) const
+{
+    for (size_t i = 0; i < m_text.size(); ++i)
+        if (m_text[i].name == name)
+            return int(i);
+    return -1;
+}
+
+bool TelemetryAlarms::configure(const QString& name, double raiseAt, double clearAt, int debounceMs)
+{
+    const int i = find(name);
+    if (i < 0)
+        return false;
+    Rule& r = m_rules[size_t(i)];
+    r.raiseAt = raiseAt;
+    r.clearAt = clearAt;
+    r.debounceNs = qint64(std::max(0, debounceMs)) * 1000000;
+    r.pendingNs = 0;
+    publish();
+    return true;
+}
+
+bool TelemetryAlarms::setEnabled(const QString& name, bool enabled)
+{
+    const int i = find(name);
+    if (i < 0)
+        return false;
+    Rule& r = m_rules[size_t(i)];
+    if (!enabled && r.active) {
+        r.active = false;
+        --m_activeCount;
+    }
+    r.enabled = enabled;
+    r.pendingNs = 0;
+    publish();
+    return true;
+}
+
+void TelemetryAlarms::reset()
+{
+    for (Rule& r : m_rules) {
+        r.active = false;
+        r.pendingNs = 0;
+        r.raised = 0;
+    }
+    m_known.fill(false);
+    m_inputs.fill(0.0);
+    m_lastTelemetryNs = 0;
+    m_activeCount = 0;
+    publish();
+}
+
+void TelemetryAlarms::publish()
+{
+    m_dirty = false;
+    m_rows.clear();
+    for (size_t i = 0; i < m_rules.size(); ++i) {
+        const Rule& r = m_rules[i];
+        m_rows.append(QVariantMap {
+            { QStringLiteral("name"),       m_text[i].name },
+            { QStringLiteral("input"),      inputName(r.input) },
+            { QStringLiteral("enabled"),    r.enabled },
+            { QStringLiteral("active"),     r.active },
+            { QStringLiteral("raiseAt"),    r.raiseAt },
+            { QStringLiteral("clearAt"),    r.clearAt },
+            { QStringLiteral("debounceMs"), double(r.debounceNs) / 1e6 },
+            { QStringLiteral("severity"),   AlarmRules::severityName(r.severity) },
+            { QStringLiteral("raised"),     r.raised },
+            { QStringLiteral("value"),      m_known[r.input] ? QVariant(m_inputs[r.input]) : QVariant() },
+        });
+    }
+    emit rulesChanged();
+}
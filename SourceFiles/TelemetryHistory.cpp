@@ -0,0 +1,212 @@
+#include "TelemetryHistory.h"
+#include <QHash>
+#include <QVariantList>
+#include <algorithm>
+
+namespace {
+// Names accepted by window()/recent(); order matches TelemetryHistory::Field.
+const char* const kFieldNames[TelemetryHistory::FieldCount] = {
+    "altitude", "posX", "posY",
+    "velocity",
+    "filteredAngleX", "filteredAngleY", "filteredAngleZ",
+    "rawAngleX", "rawAngleY", "rawAngleZ",
+    "thrustCmd", "gimbalX", "gimbalY",
+};
+
+constexpr int kLevelShiftStep = 2;   // Each level aggregates 4x the previous one.
+constexpr int kMinLevelBuckets = 16; // Stop adding levels once they get this small.
+} // namespace
+
+TelemetryHistory::TelemetryHistory(int capacityLog2, QObject* parent)
+    : QObject(parent)
+{
+    const size_t capacity = size_t(1) << qBound(8, capacityLog2, 24);
+    m_mask = capacity - 1;
+    m_time.resize(capacity);
+    for (auto& column : m_values)
+        column.resize(capacity);
+
+    for (int shift = kLevelShiftStep; (capacity >> shift) >= size_t(kMinLevelBuckets); shift += kLevelShiftStep) {
+        Level L;
+        L.shift = shift;
+        L.mask  = (capacity >> shift) - 1;
+        L.t.resize(capacity >> shift);
+        for (int f = 0; f < FieldCount; ++f) {
+            L.mn[f].resize(capacity >> shift);
+            L.mx[f].resize(capacity >> shift);
+            L.mean[f].resize(capacity >> shift);
+        }
+        m_levels.push_back(std::move(L));
+    }
+}
+
+void TelemetryHistory::append(quint32 timestampMs, const TelemetrySnapshot& s) {
+    const float v[FieldCount] = {
+        float(s.altitude), float(s.posX), float(s.posY),
+        float(s.velocity),
+        float(s.filteredAngleX), float(s.filteredAngleY), float(s.filteredAngleZ),
+        float(s.rawAngleX), float(s.rawAngleY), float(s.rawAngleZ),
+        float(s.thrustCmd), float(s.gimbalX), float(s.gimbalY),
+    };
+
+    // Time went backwards (replay seek or flight computer reboot): start a new series so
+    // the time column stays sorted for lowerBound().
+    if (m_next != m_first && double(timestampMs) < m_time[size_t((m_next - 1) & m_mask)]) {
+        m_next = (m_next + m_mask) & ~quint64(m_mask); // Next multiple of capacity: level buckets restart cleanly.
+        m_first = m_next;
+    }
+
+    const quint64 idx  = m_next;
+    const size_t  slot = size_t(idx & m_mask);
+    m_time[slot] = double(timestampMs);
+    for (int f = 0; f < FieldCount; ++f)
+        m_values[f][slot] = v[f];
+
+    // Fold the sample into the open bucket of every level (O(levels) per sample).
+    for (Level& L : m_levels) {
+        const quint64 inBucket = idx & ((quint64(1) << L.shift) - 1);
+        const size_t  bslot    = size_t((idx >> L.shift) & L.mask);
+        const double  n        = double(inBucket + 1);
+
+        if (inBucket == 0) {
+            L.t[bslot] = double(timestampMs);
+            for (int f = 0; f < FieldCount; ++f) {
+                L.mn[f][bslot] = L.mx[f][bslot] = L.mean[f][bslot] = v[f];
+                L.sum[f] = v[f];
+            }
+        } else {
+            for (int f = 0; f < FieldCount; ++f) {
+                L.mn[f][bslot] = std::min(L.mn[f][bslot], v[f]);
+                L.mx[f][bslot] = std::max(L.mx[f][bslot], v[f]);
+                L.sum[f] += v[f];
+                L.mean[f][bslot] = float(L.sum[f] / n);
+            }
+        }
+    }
+
+    ++m_next;
+    if (m_next - m_first > m_mask + 1)
+        ++m_first;
+    m_dirty = true;
+}
+
+void TelemetryHistory::flush() {
+    if (!m_dirty)
+        return;
+    m_dirty = false;
+    emit samplesAppended();
+}
+
+void TelemetryHistory::clear() {
+    m_first = m_next = 0;
+    m_dirty = false;
+    emit samplesAppended();
+}
+
+double TelemetryHistory::oldestMs() const {
+    return (m_next == m_first) ? 0.0 : m_time[size_t(m_first & m_mask)];
+}
+
+double TelemetryHistory::newestMs() const {
+    return (m_next == m_first) ? 0.0 : m_time[size_t((m_next - 1) & m_mask)];
+}
+
+quint64 TelemetryHistory::lowerBound(double ms) const {
+    quint64 lo = m_first, hi = m_next;
+    while (lo < hi) {
+        const quint64 mid = lo + (hi - lo) / 2;
+        if (m_time[size_t(mid & m_mask)] < ms)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+int TelemetryHistory::query(Field field, double fromMs, double toMs, int maxPoints,
+                            std::vector<Bucket>& out) const {
+    out.clear();
+    if (field < 0 || field >= FieldCount || maxPoints <= 0 || m_next == m_first)
+        return 0;
+
+    const quint64 a = lowerBound(fromMs);
+    quint64 b = lowerBound(toMs);
+    while (b < m_next && m_time[size_t(b & m_mask)] <= toMs) // Make the end inclusive.
+        ++b;
+    if (a >= b)
+        return 0;
+
+    // Coarsest detail that still fits: smallest level with <= maxPoints buckets.
+    int level = 0;
+    while (level < int(m_levels.size()) &&
+           ((b - a) >> (level * kLevelShiftStep)) > quint64(maxPoints))
+        ++level;
+
+    if (level == 0) {
+        out.reserve(size_t(b - a));
+        for (quint64 i = a; i < b; ++i) {
+            const size_t slot = size_t(i & m_mask);
+            const float v = m_values[field][slot];
+            out.push_back({ m_time[slot], v, v, v });
+        }
+        return 0;
+    }
+
+    const Level& L = m_levels[size_t(level - 1)];
+    const quint64 newest = (m_next - 1) >> L.shift;
+    quint64 first = a >> L.shift;
+    const quint64 last = (b - 1) >> L.shift;
+    if (newest - first > L.mask) // Oldest buckets have been overwritten in this level.
+        first = newest - L.mask;
+
+    out.reserve(size_t(last - first + 1));
+    for (quint64 bk = first; bk <= last; ++bk) {
+        const size_t bslot = size_t(bk & L.mask);
+        out.push_back({ L.t[bslot], L.mn[field][bslot], L.mx[field][bslot], L.mean[field][bslot] });
+    }
+    return level;
+}
+
+int TelemetryHistory::fieldFromName(const QString& name) {
+    static const QHash<QString, int> lookup = [] {
+        QHash<QString, int> h;
+        for (int f = 0; f < FieldCount; ++f)
+            h.insert(QString::fromLatin1(kFieldNames[f]), f);
+        return h;
+    }();
+    return lookup.value(name, -1);
+}
+
+QVariantMap TelemetryHistory::window(const QString& field, double fromMs, double toMs, int maxPoints) const {
+    const int f = fieldFromName(field);
+    if (f < 0)
+        return {};
+
+    std::vector<Bucket> buckets;
+    const int level = query(Field(f), fromMs, toMs, maxPoints, buckets);
+
+    QVariantList t, mn, mx, mean;
+    t.reserve(qsizetype(buckets.size()));
+    mn.reserve(qsizetype(buckets.size()));
+    mx.reserve(qsizetype(buckets.size()));
+    mean.reserve(qsizetype(buckets.size()));
+    for (const Bucket& bk : buckets) {
+        t.append(bk.tMs);
+        mn.append(bk.min);
+        mx.append(bk.max);
+        mean.append(bk.mean);
+    }
+
+    return {
+        { QStringLiteral("t"),     t },
+        { QStringLiteral("min"),   mn },
+        { QStringLiteral("max"),   mx },
+        { QStringLiteral("mean"),  mean },
+        { QStringLiteral("level"), level },
+    };
+}
+
+QVariantMap TelemetryHistory::recent(const QString& field, double seconds, int maxPoints) const {
+    const double newest = newestMs();
+    return window(field, newest - seconds * 1000.0, newest, maxPoints);
+}
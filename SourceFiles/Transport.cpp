@@ -0,0 +1,26 @@
+#include "Transport.h"
+#include "FileTransport.h"
+#include "PtyTransport.h"
+#include "SerialTransport.h"
+#include "UdpTransport.h"
+#include <QStringList>
+
+Transport* Transport::create(const QString& spec, int baud, QObject* parent) {
+    if (spec == QLatin1String("pty") || spec == QLatin1String("pty:"))
+        return new PtyTransport(parent);
+
+    if (spec.startsWith(QLatin1String("udp:"))) {
+        const QStringList parts = spec.mid(4).split(':');
+        const quint16 local = quint16(parts.value(0).toUInt());
+        const quint16 peer  = quint16(parts.value(1).toUInt());
+        return new UdpTransport(local, peer, parent);
+    }
+
+    if (spec.startsWith(QLatin1String("file:")))
+        return new FileTransport(spec.mid(5), baud, parent);
+
+    if (spec.startsWith(QLatin1String("serial:")))
+        return new SerialTransport(spec.mid(7), baud, parent);
+
+    return new SerialTransport(spec, baud, parent); // Bare OS port name (legacy P1/P2 usage).
+}
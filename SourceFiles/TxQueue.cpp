@@ -0,0 +1,77 @@
+#include "TxQueue.h"
+#include <algorithm>
+#include <iterator>
+
+TxQueue::TxQueue()
+{
+    // Safety traffic is never refused; a full class sheds its stalest entry instead.
+    setLimit(Critical, 32, DropOldest);
+    setLimit(Command, 64, DropOldest);
+    setLimit(Normal, 128, DropNewest);
+    // Periodic traffic only needs its latest value queued while the link is backed up.
+    setLimit(Periodic, 8, Coalesce);
+}
+
+void TxQueue::setLimit(Priority p, int depth, Policy policy)
+{
+    Class& c = m_classes[size_t(p)];
+    c.depth  = std::max(1, depth);
+    c.policy = policy;
+}
+
+bool TxQueue::push(Priority p, Message&& msg, std::vector<std::pair<Message, Result>>* displaced)
+{
+    Class& c = m_classes[size_t(p)];
+
+    if (c.policy == Coalesce && !msg.key.isEmpty()) {
+        auto it = std::find_if(c.queue.begin(), c.queue.end(),
+                               [&msg](const Message& q) { return q.key == msg.key; });
+        if (it != c.queue.end()) {
+            ++m_superseded;
+            if (displaced)
+                displaced->emplace_back(std::move(*it), Superseded);
+            *it = std::move(msg);
+            return true;
+        }
+    }
+
+    if (int(c.queue.size()) >= c.depth) {
+        ++m_dropped;
+        if (c.policy == DropNewest)
+            return false;
+        if (displaced)
+            displaced->emplace_back(std::move(c.queue.front()), Dropped);
+        c.queue.pop_front();
+    }
+    c.queue.push_back(std::move(msg));
+    return true;
+}
+
+bool TxQueue::pop(Message* out)
+{
+    for (Class& c : m_classes) {
+        if (c.queue.empty())
+            continue;
+        *out = std::move(c.queue.front());
+        c.queue.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void TxQueue::clear(std::vector<Message>* removed)
+{
+    for (Class& c : m_classes) {
+        if (removed)
+            std::move(c.queue.begin(), c.queue.end(), std::back_inserter(*removed));
+        c.queue.clear();
+    }
+}
+
+size_t TxQueue::size() const
+{
+    size_t n = 0;
+    for (const Class& c : m_classes)
+        n += c.queue.size();
+    return n;
+}
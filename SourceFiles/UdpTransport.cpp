@@ -0,0 +1,79 @@
+#include "UdpTransport.h"
+#include <cstring>
+
+namespace {
+constexpr qsizetype kMaxDatagram = 65536;
+}
+
+UdpTransport::UdpTransport(quint16 localPort, quint16 peerPort, QObject* parent)
+    : Transport(parent), m_socket(this), m_localPort(localPort), m_peerPort(peerPort)
+{
+    m_spill.reserve(kMaxDatagram); // Spilling never allocates on the RX path.
+    connect(&m_socket, &QUdpSocket::readyRead, this, &Transport::readyRead);
+    connect(&m_socket, &QAbstractSocket::errorOccurred, this, [this](QAbstractSocket::SocketError) {
+        emit errorOccurred(m_socket.errorString());
+    });
+}
+
+bool UdpTransport::open() {
+    m_error.clear();
+    close();
+    return m_socket.bind(QHostAddress::LocalHost, m_localPort);
+}
+
+void UdpTransport::close() {
+    m_socket.close();
+    m_lastSenderPort = 0;
+    m_spill.resize(0);
+    m_spillPos = 0;
+}
+
+qint64 UdpTransport::read(char* dst, qint64 max) {
+    if (max <= 0)
+        return 0;
+
+    // Finish a spilled datagram first so the byte stream stays in order.
+    if (m_spillPos < m_spill.size()) {
+        const qsizetype n = qMin<qsizetype>(qsizetype(max), m_spill.size() - m_spillPos);
+        std::memcpy(dst, m_spill.constData() + m_spillPos, size_t(n));
+        m_spillPos += n;
+        return n;
+    }
+    if (!m_socket.hasPendingDatagrams())
+        return 0;
+
+    QHostAddress sender;
+    quint16 senderPort = 0;
+    qint64 n;
+    const qint64 size = m_socket.pendingDatagramSize();
+    if (size <= max) {
+        n = m_socket.readDatagram(dst, max, &sender, &senderPort);
+    } else {
+        // It would not fit: never leave it pending (readyRead is not raised for it again).
+        m_spill.resize(qMax<qsizetype>(qsizetype(size), 0));
+        n = m_socket.readDatagram(m_spill.data(), m_spill.size(), &sender, &senderPort);
+        m_spill.resize(qMax<qsizetype>(qsizetype(n), 0));
+        m_spillPos = qMin<qsizetype>(qsizetype(max), m_spill.size());
+        if (n > 0) {
+            std::memcpy(dst, m_spill.constData(), size_t(m_spillPos));
+            n = m_spillPos;
+        }
+    }
+    if (n >= 0 && sender.isLoopback())
+        m_lastSenderPort = senderPort;
+    return n;
+}
+
+qint64 UdpTransport::write(const char* data, qint64 size) {
+    const quint16 port = m_peerPort ? m_peerPort : m_lastSenderPort;
+    if (!port) {
+        m_error = QStringLiteral("no UDP peer yet (nothing received and no peer port given)");
+        return -1;
+    }
+    return m_socket.writeDatagram(data, size, QHostAddress::LocalHost, port);
+}
+
+QString UdpTransport::describe() const {
+    return m_peerPort ? QStringLiteral("udp:%1:%2").arg(m_localPort).arg(m_peerPort)
+                      : QStringLiteral("udp:%1").arg(m_localPort);
+}
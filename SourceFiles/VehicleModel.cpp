@@ -0,0 +1,51 @@
+#include "VehicleModel.h"
+#include "VehicleRouter.h"
+
+VehicleModel::VehicleModel(QObject* parent)
+    : SensorDataModel(nullptr, parent)
+{
+}
+
+VehicleModel::~VehicleModel()
+{
+    if (m_router)
+        m_router->detach(this);
+}
+
+void VehicleModel::setRouter(VehicleRouter* router)
+{
+    if (router == m_router)
+        return;
+    if (m_router)
+        m_router->detach(this);
+    m_router = router;
+    resubscribe();
+    emit routerChanged();
+}
+
+void VehicleModel::setVehicle(int vehicle)
+{
+    if (vehicle == m_vehicle || vehicle < 0)
+        return;
+    m_vehicle = vehicle;
+    resubscribe();
+    emit vehicleChanged();
+}
+
+void VehicleModel::resubscribe()
+{
+    if (!m_router)
+        return;
+    m_router->attach(this, m_vehicle);
+    setFrameWindow(m_router->frameWindow());
+
+    // Start from what the router already knows; later records arrive through ingest().
+    const TelemetrySnapshot* state = m_router->state(m_vehicle);
+    applySnapshot(state ? *state : TelemetrySnapshot());
+}
+
+void VehicleModel::applyBatch(const TelemetrySnapshot& state)
+{
+    flushLogs();
+    applySnapshot(state);
+}
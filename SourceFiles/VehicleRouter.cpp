@@ -0,0 +1,167 @@
+#include "VehicleRouter.h"
+#include "AllocCounter.h"
+#include "SerialBridge.h"
+#include "VehicleModel.h"
+#include <algorithm>
+extern "C" {
+    #include "rp/codec.h"
+}
+
+VehicleRouter::VehicleRouter(SerialBridge* bridge, QObject* parent)
+    : QObject(parent), m_bridge(bridge)
+{
+    slotOf(0); // The default vehicle is always listed.
+
+    m_publishTimer.setInterval(1000);
+    connect(&m_publishTimer, &QTimer::timeout, this, &VehicleRouter::publish);
+    m_publishTimer.start();
+    publish();
+}
+
+int VehicleRouter::slotOf(int vehicle)
+{
+    if (m_lastSlot >= 0 && m_lastVehicle == vehicle)
+        return m_lastSlot;
+
+    int slot = -1;
+    for (size_t i = 0; i < m_table.size(); ++i) {
+        if (m_table[i].id == vehicle) {
+            slot = int(i);
+            break;
+        }
+    }
+    if (slot < 0) {
+        ULYSSES_ALLOC_EXEMPT(); // First record of a vehicle.
+        VehicleState v;
+        v.id = vehicle;
+        m_table.push_back(v);
+        slot = int(m_table.size()) - 1;
+    }
+    m_lastVehicle = vehicle;
+    m_lastSlot = slot;
+    return slot;
+}
+
+void VehicleRouter::route(const DownlinkRecord& rec)
+{
+    const size_t before = m_table.size();
+    VehicleState& v = m_table[size_t(slotOf(rec.vehicle))];
+    v.dirty = true;   // Also for decode errors: the models' packet logs have a new row.
+    if (rec.status == RP_CODEC_OK)
+        v.state.apply(rec.downlink);
+
+    // A replay seek only restores the state; the packet was counted and logged before.
+    if (!rec.primed) {
+        ++v.packets;
+        v.lastRxNs = rec.rxNs;
+        if (rec.status != RP_CODEC_OK)
+            ++v.decodeErrors;
+        for (const auto& m : m_models)
+            if (m.first == rec.vehicle)
+                m.second->ingest(rec);
+    }
+
+    if (m_table.size() != before) {
+        ULYSSES_ALLOC_EXEMPT();
+        publish(); // A new vehicle shows up at once, not on the next tick.
+    }
+}
+
+void VehicleRouter::flush()
+{
+    for (VehicleState& v : m_table) {
+        if (!v.dirty)
+            continue;
+        v.dirty = false;
+        for (const auto& m : m_models)
+            if (m.first == v.id)
+                m.second->applyBatch(v.state);
+    }
+}
+
+const TelemetrySnapshot* VehicleRouter::state(int vehicle) const
+{
+    for (const VehicleState& v : m_table)
+        if (v.id == vehicle)
+            return v.packets ? &v.state : nullptr;
+    return nullptr;
+}
+
+void VehicleRouter::assignLink(int link, int vehicle)
+{
+    if (vehicle < 0)
+        return;
+
+    auto it = std::find_if(m_assign.begin(), m_assign.end(),
+                           [link](const std::pair<int, int>& a) { return a.first == link; });
+    if (vehicle == 0) {
+        if (it != m_assign.end())
+            m_assign.erase(it);
+    } else if (it != m_assign.end()) {
+        it->second = vehicle;
+    } else {
+        m_assign.emplace_back(link, vehicle);
+    }
+
+    slotOf(vehicle);
+    if (m_bridge)
+        m_bridge->setLinkVehicle(link, vehicle);
+    publish();
+}
+
+int VehicleRouter::vehicleOfLink(int link) const
+{
+    for (const auto& a : m_assign)
+        if (a.first == link)
+            return a.second;
+    return 0;
+}
+
+void VehicleRouter::setFrameWindow(QQuickWindow* window)
+{
+    m_frameWindow = window;
+    for (const auto& m : m_models)
+        m.second->setFrameWindow(window);
+}
+
+void VehicleRouter::attach(VehicleModel* model, int vehicle)
+{
+    detach(model);
+    m_models.emplace_back(vehicle, model);
+}
+
+void VehicleRouter::detach(VehicleModel* model)
+{
+    m_models.erase(std::remove_if(m_models.begin(), m_models.end(),
+                                  [model](const std::pair<int, VehicleModel*>& m) { return m.second == model; }),
+                   m_models.end());
+}
+
+void VehicleRouter::publish()
+{
+    const QList<int> open = m_bridge ? m_bridge->linkIds() : QList<int>();
+    const qint64 nowNs = monotonicNs();
+
+    QVariantList rows;
+    rows.reserve(qsizetype(m_table.size()));
+    for (const VehicleState& v : m_table) {
+        QVariantList links;
+        for (int id : open)
+            if (vehicleOfLink(id) == v.id)
+                links.append(id);
+        const auto models = std::count_if(m_models.begin(), m_models.end(),
+                                          [&v](const std::pair<int, VehicleModel*>& m) { return m.first == v.id; });
+        rows.append(QVariantMap {
+            { QStringLiteral("vehicle"),      v.id },
+            { QStringLiteral("links"),        links },
+            { QStringLiteral("packets"),      v.packets },
+            { QStringLiteral("decodeErrors"), v.decodeErrors },
+            { QStringLiteral("ageMs"),        v.packets ? double(nowNs - v.lastRxNs) / 1e6 : -1.0 },
+            { QStringLiteral("flightState"),  v.state.flightState },
+            { QStringLiteral("uptimeMs"),     v.state.uptimeMs },
+            { QStringLiteral("models"),       int(models) },
+        });
+    }
+    m_rows = rows;
+    emit vehiclesChanged();
+}
@@ -0,0 +1,420 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "AllocCounter.h"
+#include "DownlinkGenerator.h"
+#include "DownlinkRecord.h"
+#include "RawPacketLogModel.h"
+#include "RxRing.h"
+#include "SensorDataModel.h"
+#include "SerialWorker.h"
+
+extern "C" {
+    #include "rp/codec.h"
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/// Keeps results observable so the optimizer can't drop the measured work.
+volatile quint64 g_sink = 0;
+
+/**
+ * @brief Stage
+ * Accumulates timed batches of one pipeline stage. Each batch contributes one latency
+ * sample (batch time / ops in the batch), so per-op figures stay meaningful for stages
+ * that are far cheaper than a clock read. Built with ULYSSES_ALLOC_CHECK, heap allocations
+ * made by the batches are counted as well.
+ */
+class Stage {
+public:
+    explicit Stage(const char* name) : m_name(name) {}
+
+    template <typename Fn>
+    void time(quint64 ops, quint64 bytes, Fn&& fn) {
+        const quint64 a0 = AllocCounter::threadCount();
+        const auto t0 = Clock::now();
+        fn();
+        const auto t1 = Clock::now();
+        record(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count(), ops, bytes,
+               AllocCounter::threadCount() - a0);
+    }
+
+    /// Account one batch measured by the caller.
+    void record(qint64 ns, quint64 ops, quint64 bytes, quint64 allocs = 0) {
+        if (!m_recording)
+            return;
+        m_ns     += ns;
+        m_ops    += ops;
+        m_bytes  += bytes;
+        m_allocs += allocs;
+        if (ops)
+            m_samples.push_back(double(ns) / double(ops));
+    }
+
+    /// Passes before this call are warm-up and are not recorded.
+    void startRecording() { m_recording = true; }
+
+    QJsonObject toJson() {
+        QJsonObject o;
+        o["name"]     = m_name;
+        o["ops"]      = double(m_ops);
+        o["bytes"]    = double(m_bytes);
+        o["total_ns"] = double(m_ns);
+        if (m_ops) {
+            const double secs = double(m_ns) * 1e-9;
+            o["ns_per_op"]   = double(m_ns) / double(m_ops);
+            o["ops_per_sec"] = secs > 0 ? double(m_ops) / secs : 0.0;
+            if (m_bytes)
+                o["mb_per_sec"] = secs > 0 ? double(m_bytes) / secs / 1e6 : 0.0;
+            if (AllocCounter::enabled())
+                o["allocs_per_op"] = double(m_allocs) / double(m_ops);
+        }
+        if (!m_samples.empty()) {
+            std::sort(m_samples.begin(), m_samples.end());
+            auto pct = [this](double p) {
+                return m_samples[std::min(m_samples.size() - 1, size_t(p * double(m_samples.size())))];
+            };
+            QJsonObject lat;
+            lat["min"] = m_samples.front();
+            lat["p50"] = pct(0.50);
+            lat["p90"] = pct(0.90);
+            lat["p99"] = pct(0.99);
+            lat["max"] = m_samples.back();
+            lat["samples"] = double(m_samples.size());
+            o["latency_ns"] = lat;
+        }
+        return o;
+    }
+
+private:
+    QString m_name;
+    bool    m_recording = false;
+    qint64  m_ns = 0;
+    quint64 m_ops = 0;
+    quint64 m_bytes = 0;
+    quint64 m_allocs = 0;
+    std::vector<double> m_samples;
+};
+
+/// Synthetic workload shared by all stages.
+struct Workload {
+    std::vector<QByteArray>     frames;   ///< One encoded frame each (delimiter included).
+    QByteArray                  stream;   ///< All frames back to back, as the radio delivers them.
+    std::vector<DownlinkRecord> records;  ///< Decode result of every frame.
+    quint64                     corrupted = 0;
+    quint64                     decodeErrors = 0;
+};
+
+Workload buildWorkload(const DownlinkGenerator::Options& opt, int frames)
+{
+    Workload w;
+    DownlinkGenerator gen(opt);
+    w.frames.reserve(size_t(frames));
+    w.records.reserve(size_t(frames));
+    for (int i = 0; i < frames; ++i) {
+        bool bad = false;
+        QByteArray f = gen.nextFrame(&bad);
+        w.corrupted += bad;
+        w.stream += f;
+
+        DownlinkRecord rec;
+        rec.which    = 1;
+        rec.rxNs     = monotonicNs();
+        rec.downlink = tvr_Downlink_init_default;
+        rec.status   = rp_packet_decode(reinterpret_cast<const uint8_t*>(f.constData()), size_t(f.size()),
+                                        &tvr_Downlink_msg, &rec.downlink).status;
+        w.decodeErrors += rec.status != RP_CODEC_OK;
+        w.records.push_back(rec);
+        w.frames.push_back(std::move(f));
+    }
+    return w;
+}
+
+// -----------------------
+// Stages
+// -----------------------
+
+/// Framing as in SerialWorker::parseBuffered: driver-sized reads into the RxRing, text/frame
+/// segments from nextSegment() and the decode-checked split of a printable prefix.
+void benchFraming(Stage& st, const Workload& w, int passes)
+{
+    constexpr size_t kReadSize = 4096; // Typical serial driver read.
+    tvr_Downlink probe;
+    for (int pass = 0; pass < passes; ++pass) {
+        if (pass == 1) st.startRecording();
+        RxRing ring(64 * 1024, DownlinkGenerator::kMaxFrame);
+        const uint8_t* src = reinterpret_cast<const uint8_t*>(w.stream.constData());
+        size_t left = size_t(w.stream.size());
+        while (left > 0) {
+            // One sample per driver read; the frame count is only known afterwards.
+            const auto t0 = Clock::now();
+            size_t room = 0;
+            uint8_t* dst = ring.writeSpan(&room);
+            const size_t taken = std::min({ room, left, kReadSize });
+            std::memcpy(dst, src, taken);
+            ring.commit(taken);
+            quint64 frames = 0;
+            RxSegment seg;
+            while (ring.nextSegment(seg)) {
+                if (seg.text) {
+                    g_sink = g_sink + seg.bytes.size;
+                    continue;
+                }
+                FrameView f = seg.bytes;
+                if (seg.textPrefix) {
+                    const FrameView rest { f.data + seg.textPrefix, f.size - seg.textPrefix };
+                    probe = tvr_Downlink_init_default;
+                    if (rest.size <= 1 ||
+                        rp_packet_decode(rest.data, rest.size, &tvr_Downlink_msg, &probe).status == RP_CODEC_OK)
+                        f = rest;
+                }
+                if (f.size <= 1)
+                    continue;
+                g_sink = g_sink + f.size;
+                ++frames;
+            }
+            st.record(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count(),
+                      frames, taken);
+            src += taken;
+            left -= taken;
+        }
+    }
+}
+
+/// rp_packet_decode (COBS + CRC + nanopb) of every frame.
+void benchDecode(Stage& st, const Workload& w, int passes, size_t batch)
+{
+    tvr_Downlink msg;
+    for (int pass = 0; pass < passes; ++pass) {
+        if (pass == 1) st.startRecording();
+        for (size_t i = 0; i < w.frames.size(); i += batch) {
+            const size_t end = std::min(i + batch, w.frames.size());
+            quint64 bytes = 0;
+            for (size_t k = i; k < end; ++k) bytes += quint64(w.frames[k].size());
+            st.time(end - i, bytes, [&] {
+                for (size_t k = i; k < end; ++k) {
+                    const QByteArray& f = w.frames[k];
+                    msg = tvr_Downlink_init_default;
+                    g_sink = g_sink + rp_packet_decode(reinterpret_cast<const uint8_t*>(f.constData()),
+                                                       size_t(f.size()), &tvr_Downlink_msg, &msg).status;
+                }
+            });
+        }
+    }
+}
+
+/// I/O-thread dispatch: decode, snapshot publish and SPSC hand-off, drained like the GUI does.
+void benchWorker(Stage& st, const Workload& w, int passes, size_t batch)
+{
+    SerialWorker worker;
+    auto& queue = worker.records();
+    for (int pass = 0; pass < passes; ++pass) {
+        if (pass == 1) st.startRecording();
+        for (size_t i = 0; i < w.frames.size(); i += batch) {
+            const size_t end = std::min(i + batch, w.frames.size());
+            st.time(end - i, 0, [&] {
+                for (size_t k = i; k < end; ++k)
+                    worker.injectFrame(1, w.frames[k]);
+                worker.ackRecords();
+                while (DownlinkRecord* rec = queue.front()) {
+                    g_sink = g_sink + quint64(rec->status);
+                    queue.popFront();
+                }
+            });
+        }
+    }
+}
+
+/// GUI-thread path: SensorDataModel::onBinaryPacketReceived (decode, raw log, history, state commit).
+void benchModel(Stage& st, const Workload& w, int passes, size_t batch)
+{
+    SensorDataModel model(nullptr);
+    for (int pass = 0; pass < passes; ++pass) {
+        if (pass == 1) st.startRecording();
+        for (size_t i = 0; i < w.frames.size(); i += batch) {
+            const size_t end = std::min(i + batch, w.frames.size());
+            st.time(end - i, 0, [&] {
+                for (size_t k = i; k < end; ++k)
+                    model.onBinaryPacketReceived(1, w.frames[k]);
+            });
+        }
+        QCoreApplication::processEvents(); // Let the deferred notification flush run between passes.
+    }
+}
+
+/// Raw packet log row formatting on its own.
+void benchFormat(Stage& st, const Workload& w, int passes, size_t batch)
+{
+    for (int pass = 0; pass < passes; ++pass) {
+        if (pass == 1) st.startRecording();
+        for (size_t i = 0; i < w.records.size(); i += batch) {
+            const size_t end = std::min(i + batch, w.records.size());
+            st.time(end - i, 0, [&] {
+                for (size_t k = i; k < end; ++k)
+                    g_sink = g_sink + quint64(RawPacketLogModel::formatRecord(w.records[k]).size());
+            });
+        }
+    }
+}
+
+/// TelemetrySnapshot::apply, the state fold behind SensorDataModel::applyDownlink.
+void benchApply(Stage& st, const Workload& w, int passes, size_t batch)
+{
+    TelemetrySnapshot snap;
+    for (int pass = 0; pass < passes; ++pass) {
+        if (pass == 1) st.startRecording();
+        for (size_t i = 0; i < w.records.size(); i += batch) {
+            const size_t end = std::min(i + batch, w.records.size());
+            st.time(end - i, 0, [&] {
+                for (size_t k = i; k < end; ++k)
+                    if (w.records[k].status == RP_CODEC_OK)
+                        snap.apply(w.records[k].downlink);
+            });
+        }
+    }
+    g_sink = g_sink + snap.telemetryCount;
+}
+
+/// Quaternion to Euler conversion over every decoded attitude.
+void benchQuat(Stage& st, const Workload& w, int passes, size_t batch)
+{
+    std::vector<tvr_Downlink> att;
+    for (const auto& r : w.records)
+        if (r.status == RP_CODEC_OK && r.downlink.which_payload == tvr_Downlink_telemetry_tag
+            && r.downlink.payload.telemetry.has_attitude)
+            att.push_back(r.downlink);
+
+    float roll = 0, pitch = 0, yaw = 0;
+    for (int pass = 0; pass < passes; ++pass) {
+        if (pass == 1) st.startRecording();
+        for (size_t i = 0; i < att.size(); i += batch) {
+            const size_t end = std::min(i + batch, att.size());
+            st.time(end - i, 0, [&] {
+                for (size_t k = i; k < end; ++k) {
+                    const auto& q = att[k].payload.telemetry.attitude;
+                    quatToEulerRad(q.w, q.x, q.y, q.z, &roll, &pitch, &yaw);
+                    g_sink = g_sink + quint64(roll + pitch + yaw);
+                }
+            });
+        }
+    }
+}
+
+} // namespace
+
+// Microbenchmarks for the downlink hot path on a synthetic, reproducible workload.
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("ulysses_bench");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Benchmark the downlink pipeline stages and report JSON.");
+    parser.addHelpOption();
+    QCommandLineOption framesOpt({"n", "frames"}, "Frames in the synthetic workload.", "n", "100000");
+    QCommandLineOption batchOpt("batch", "Ops per timed batch (one latency sample each).", "n", "32");
+    QCommandLineOption passesOpt("passes", "Measured passes per stage (plus one warm-up).", "n", "3");
+    QCommandLineOption statusOpt("status-every", "One SystemStatus after this many TelemetryStates.", "n", "10");
+    QCommandLineOption optionalOpt("optional-rate", "Probability each optional telemetry field is present.", "p", "1.0");
+    QCommandLineOption corruptOpt("corrupt-rate", "Fraction of frames with a flipped byte.", "p", "0.01");
+    QCommandLineOption seedOpt("seed", "Generator seed.", "n", "1");
+    QCommandLineOption stagesOpt("stages", "Comma-separated stage names to run (default: all).", "list");
+    QCommandLineOption outOpt({"o", "output"}, "Write the JSON report here instead of stdout.", "file");
+    parser.addOption(framesOpt);
+    parser.addOption(batchOpt);
+    parser.addOption(passesOpt);
+    parser.addOption(statusOpt);
+    parser.addOption(optionalOpt);
+    parser.addOption(corruptOpt);
+    parser.addOption(seedOpt);
+    parser.addOption(stagesOpt);
+    parser.addOption(outOpt);
+    parser.process(app);
+
+    DownlinkGenerator::Options gen;
+    gen.statusEvery  = parser.value(statusOpt).toInt();
+    gen.optionalRate = parser.value(optionalOpt).toDouble();
+    gen.corruptRate  = parser.value(corruptOpt).toDouble();
+    gen.seed         = parser.value(seedOpt).toUInt();
+    const int    frames = qMax(1, parser.value(framesOpt).toInt());
+    const size_t batch  = size_t(qMax(1, parser.value(batchOpt).toInt()));
+    const int    passes = qMax(1, parser.value(passesOpt).toInt()) + 1;
+    const QStringList only = parser.value(stagesOpt).split(',', Qt::SkipEmptyParts);
+
+    const Workload w = buildWorkload(gen, frames);
+
+    struct Entry {
+        const char* name;
+        void (*run)(Stage&, const Workload&, int, size_t);
+    };
+    const Entry entries[] = {
+        { "framing",         [](Stage& s, const Workload& wl, int p, size_t) { benchFraming(s, wl, p); } },
+        { "decode",          benchDecode },
+        { "worker_dispatch", benchWorker },
+        { "model_packet",    benchModel },
+        { "format_record",   benchFormat },
+        { "snapshot_apply",  benchApply },
+        { "quat_to_euler",   benchQuat },
+    };
+
+    QJsonArray stages;
+    for (const Entry& e : entries) {
+        if (!only.isEmpty() && !only.contains(QLatin1String(e.name)))
+            continue;
+        std::fprintf(stderr, "ulysses_bench: %s...\n", e.name);
+        Stage st(e.name);
+        e.run(st, w, passes, batch);
+        stages.append(st.toJson());
+    }
+
+    QJsonObject config;
+    config["frames"]        = frames;
+    config["stream_bytes"]  = double(w.stream.size());
+    config["batch"]         = double(batch);
+    config["passes"]        = passes - 1;
+    config["status_every"]  = gen.statusEvery;
+    config["optional_rate"] = gen.optionalRate;
+    config["corrupt_rate"]  = gen.corruptRate;
+    config["seed"]          = double(gen.seed);
+    config["corrupted_frames"] = double(w.corrupted);
+    config["decode_errors"]    = double(w.decodeErrors);
+
+    QJsonObject host;
+    host["qt"]     = QString::fromLatin1(qVersion());
+    host["arch"]   = QSysInfo::currentCpuArchitecture();
+    host["kernel"] = QSysInfo::kernelType() + ' ' + QSysInfo::kernelVersion();
+    host["os"]     = QSysInfo::prettyProductName();
+
+    QJsonObject report;
+    report["benchmark"] = QStringLiteral("ulysses_bench");
+    report["version"]   = 1;
+    report["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    report["host"]      = host;
+    report["config"]    = config;
+    report["stages"]    = stages;
+    const QByteArray json = QJsonDocument(report).toJson(QJsonDocument::Indented);
+
+    if (parser.isSet(outOpt)) {
+        QFile out(parser.value(outOpt));
+        if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate) || out.write(json) != json.size()) {
+            std::fprintf(stderr, "ulysses_bench: cannot write %s\n", qPrintable(out.fileName()));
+            return 1;
+        }
+    } else {
+        std::fwrite(json.constData(), 1, size_t(json.size()), stdout);
+    }
+    return 0;
+}
@@ -1,23 +1,115 @@
 #include <QGuiApplication>
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
+#include <QQmlEngine>
+#include <QQuickWindow>
 #include <QCommandLineParser>
 #include <QTimer>
+#include <cstdio>
+#include "FlightRecorder.h"
+#include "LatencyMonitor.h"
+#include "PeriodicScheduler.h"
+#include "ReplayEngine.h"
 #include "SerialBridge.h"
 #include "SensorDataModel.h"
 #include "CommandSender.h"
+#include "CommandTracker.h"
 #include "AlarmReceiver.h"
+#include "TelemetryAlarms.h"
+#include "VehicleModel.h"
+#include "VehicleRouter.h"
 
 int main(int argc, char *argv[])
 {
     // Qt GUI application (event loop owner)
     QGuiApplication app(argc, argv);
 
-    // Backend objects live for the duration of main
+    // I/O thread tuning for predictable RX on a loaded machine (both optional)
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption ioCpuOpt("io-cpu", "Pin the serial I/O thread to this CPU index.", "cpu", "-1");
+    QCommandLineOption ioRtOpt("io-rt-priority", "Run the serial I/O thread at this SCHED_FIFO priority (Linux).", "prio", "0");
+    parser.addOption(ioCpuOpt);
+    parser.addOption(ioRtOpt);
+
+    // Flight recording of raw downlink frames (on by default once a port opens)
+    QCommandLineOption noRecordOpt("no-record", "Do not record raw downlink frames to disk.");
+    QCommandLineOption recordDirOpt("record-dir", "Directory for flight recordings.", "dir");
+    parser.addOption(noRecordOpt);
+    parser.addOption(recordDirOpt);
+
+    // Extra links beside the P1/P2 radios (simulators, UDP bridges, captures); repeatable
+    QCommandLineOption linkOpt("link", "Open an extra link at startup: a serial port, pty, "
+                               "udp:<port>[:<peer>] or file:<path>.", "spec");
+    parser.addOption(linkOpt);
+
+    // Per-stage latency histograms (always collected; printed on exit, optionally dumped as JSON)
+    QCommandLineOption latencyDumpOpt("latency-dump", "Write the latency histograms to this JSON file on exit.", "file");
+    QCommandLineOption senderClockOpt("sender-clock-monotonic", "Downlink timestamp_ms is the sender's monotonic "
+                                      "clock (ulysses_sim --stamp-monotonic): also measure link latency.");
+    parser.addOption(latencyDumpOpt);
+    parser.addOption(senderClockOpt);
+
+    // Keyword → severity rules for firmware text lines (default: built-in keyword sets)
+    QCommandLineOption alarmRulesOpt("alarm-rules", "Load alarm keyword rules from this file.", "file");
+    parser.addOption(alarmRulesOpt);
+    parser.process(app);
+
+    // Backend objects live for the duration of main (recorder first: the I/O thread writes into it)
+    FlightRecorder recorder;
+    if (parser.isSet(recordDirOpt))
+        recorder.setDefaultDirectory(parser.value(recordDirOpt));
+
     SerialBridge bridge;
+    bridge.setIoThreadTuning(parser.value(ioCpuOpt).toInt(), parser.value(ioRtOpt).toInt());
+    bridge.setRecorder(&recorder);
+    // A recording that cannot open or stops on a write error is reported like a link error.
+    QObject::connect(&recorder, &FlightRecorder::errorMessage, &bridge, &SerialBridge::errorMessage);
+    if (!parser.isSet(noRecordOpt)) {
+        // Start a new recording the first time any link comes up.
+        QObject::connect(&bridge, &SerialBridge::connectedChanged, &recorder, [&recorder](int, bool connected) {
+            if (connected && !recorder.isRecording())
+                recorder.start();
+        });
+    }
+    LatencyMonitor latency;
+    latency.setSenderClockMonotonic(parser.isSet(senderClockOpt));
+    QObject::connect(&app, &QCoreApplication::aboutToQuit, &latency, [&latency, &parser, &latencyDumpOpt]() {
+        std::fputs(qPrintable(latency.report()), stderr);
+        if (parser.isSet(latencyDumpOpt) && !latency.dump(parser.value(latencyDumpOpt)))
+            qWarning("Cannot write latency dump to %s", qPrintable(parser.value(latencyDumpOpt)));
+    });
+
+    PeriodicScheduler scheduler(&bridge);     // drift-free periodic TX streams (own timing thread)
     CommandSender   commandsender(&bridge);   // sends commands via bridge
+    commandsender.setScheduler(&scheduler);
     AlarmReceiver   alarmreceiver(&bridge);   // receives/decodes alarms via bridge
+    if (parser.isSet(alarmRulesOpt))
+        alarmreceiver.loadRules(parser.value(alarmRulesOpt));
     SensorDataModel sensorData(&bridge);      // decodes all downlink packets (telemetry + status)
+    ReplayEngine    replay(&bridge);          // plays recordings back through the bridge
+    sensorData.setLatencyMonitor(&latency);
+    TelemetryAlarms telemetryAlarms;           // alarm rules on decoded status/telemetry fields
+    sensorData.setAlarmEngine(&telemetryAlarms);
+    QObject::connect(&telemetryAlarms, &TelemetryAlarms::alarmRaised, &alarmreceiver, &AlarmReceiver::postAlarm);
+    QObject::connect(&telemetryAlarms, &TelemetryAlarms::alarmCleared, &alarmreceiver, &AlarmReceiver::postAlarm);
+    VehicleRouter   vehicleRouter(&bridge);    // per-vehicle state for VehicleModel instances
+    sensorData.setVehicleRouter(&vehicleRouter);
+    CommandTracker  commandTracker(&bridge, &sensorData); // confirms flight commands from the downlink
+    commandsender.setTracker(&commandTracker);
+    commandTracker.setScheduler(&scheduler);
+
+    // Open extra links only once every consumer is connected
+    for (const QString& spec : parser.values(linkOpt)) {
+        const int id = bridge.addLink(spec);
+        if (id > 0)
+            qInfo("Link %d: %s", id, qPrintable(bridge.portName(id)));
+    }
+
+    // Per-vehicle models are created from QML: VehicleModel { router: vehicleRouter; vehicle: 2 }
+    qmlRegisterType<VehicleModel>("Ulysses.Vehicles", 1, 0, "VehicleModel");
+    qmlRegisterUncreatableType<VehicleRouter>("Ulysses.Vehicles", 1, 0, "VehicleRouter",
+                                              QStringLiteral("Use the vehicleRouter context property"));
 
     // QML engine + expose C++ backends to QML by name
     QQmlApplicationEngine engine;
@@ -25,6 +117,13 @@ int main(int argc, char *argv[])
     engine.rootContext()->setContextProperty("commandsender", &commandsender);
     engine.rootContext()->setContextProperty("alarmreceiver", &alarmreceiver);
     engine.rootContext()->setContextProperty("sensorData", &sensorData);
+    engine.rootContext()->setContextProperty("recorder", &recorder);
+    engine.rootContext()->setContextProperty("replay", &replay);
+    engine.rootContext()->setContextProperty("latency", &latency);
+    engine.rootContext()->setContextProperty("commandTracker", &commandTracker);
+    engine.rootContext()->setContextProperty("scheduler", &scheduler);
+    engine.rootContext()->setContextProperty("telemetryAlarms", &telemetryAlarms);
+    engine.rootContext()->setContextProperty("vehicleRouter", &vehicleRouter);
 
     // If QML fails to load, quit with error code
     QObject::connect(
@@ -43,6 +142,14 @@ int main(int argc, char *argv[])
     if (engine.rootObjects().isEmpty())
         return -1;
 
+    // Flush coalesced property notifications once per rendered frame of the main window;
+    // its frame swaps also close the render stage of the latency breakdown
+    if (auto* window = qobject_cast<QQuickWindow*>(engine.rootObjects().first())) {
+        sensorData.setFrameWindow(window);
+        vehicleRouter.setFrameWindow(window);
+        latency.setWindow(window);
+    }
+
     // Start the event loop
     return app.exec();
 }
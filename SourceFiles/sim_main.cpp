@@ -0,0 +1,89 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QTimer>
+#include <cstdio>
+#include "RocketSimulator.h"
+
+// Fake rocket for end-to-end load tests: open the printed pty path as a port in the GCS.
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("ulysses_sim");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Simulated vehicle streaming COBS+protobuf downlink over a pty (or any link spec).");
+    parser.addHelpOption();
+    QCommandLineOption linkOpt("link", "Transport spec: pty, udp:<local>[:<peer>], or a serial port.", "spec", "pty");
+    QCommandLineOption baudOpt("baud", "Baud rate for serial links.", "baud", "57600");
+    QCommandLineOption telOpt({"t", "telemetry-hz"}, "TelemetryState rate.", "hz", "10");
+    QCommandLineOption statusOpt({"s", "status-hz"}, "SystemStatus rate.", "hz", "1");
+    QCommandLineOption profileOpt({"p", "profile"}, "Flight profile: pad, hop, hover, abort.", "name", "hop");
+    QCommandLineOption noLoopOpt("no-loop", "Hold on the pad when the profile ends instead of restarting it.");
+    QCommandLineOption waitOpt("wait-launch", "Stay on the pad until a Launch command is received.");
+    QCommandLineOption berOpt("ber", "Bit error rate applied to the transmitted stream.", "p", "0");
+    QCommandLineOption dropOpt("drop-rate", "Probability each transmitted byte is lost.", "p", "0");
+    QCommandLineOption stampOpt("stamp-monotonic", "Put the monotonic send time (ms) in timestamp_ms for end-to-end latency.");
+    QCommandLineOption seedOpt("seed", "Impairment RNG seed.", "n", "1");
+    QCommandLineOption statsOpt("stats-interval", "Seconds between stats lines on stderr (0: off).", "s", "5");
+    parser.addOption(linkOpt);
+    parser.addOption(baudOpt);
+    parser.addOption(telOpt);
+    parser.addOption(statusOpt);
+    parser.addOption(profileOpt);
+    parser.addOption(noLoopOpt);
+    parser.addOption(waitOpt);
+    parser.addOption(berOpt);
+    parser.addOption(dropOpt);
+    parser.addOption(stampOpt);
+    parser.addOption(seedOpt);
+    parser.addOption(statsOpt);
+    parser.process(app);
+
+    RocketSimulator::Options opt;
+    opt.link           = parser.value(linkOpt);
+    opt.baud           = parser.value(baudOpt).toInt();
+    opt.telemetryHz    = parser.value(telOpt).toDouble();
+    opt.statusHz       = parser.value(statusOpt).toDouble();
+    opt.loop           = !parser.isSet(noLoopOpt);
+    opt.waitLaunch     = parser.isSet(waitOpt);
+    opt.bitErrorRate   = parser.value(berOpt).toDouble();
+    opt.dropRate       = parser.value(dropOpt).toDouble();
+    opt.stampMonotonic = parser.isSet(stampOpt);
+    opt.seed           = parser.value(seedOpt).toUInt();
+    if (!RocketSimulator::parseProfile(parser.value(profileOpt), &opt.profile)) {
+        std::fprintf(stderr, "ulysses_sim: unknown profile '%s'\n", qPrintable(parser.value(profileOpt)));
+        return 1;
+    }
+
+    RocketSimulator sim(opt);
+    QString error;
+    if (!sim.start(&error)) {
+        std::fprintf(stderr, "ulysses_sim: cannot open %s: %s\n", qPrintable(opt.link), qPrintable(error));
+        return 1;
+    }
+    std::fprintf(stderr, "ulysses_sim: streaming on %s (telemetry %.1f Hz, status %.1f Hz)\n",
+                 qPrintable(sim.linkDescription()), opt.telemetryHz, opt.statusHz);
+
+    QObject::connect(&sim, &RocketSimulator::commandReceived, [](int type) {
+        std::fprintf(stderr, "ulysses_sim: command %d received\n", type);
+    });
+
+    QTimer statsTimer;
+    const int statsSec = parser.value(statsOpt).toInt();
+    if (statsSec > 0) {
+        QObject::connect(&statsTimer, &QTimer::timeout, [&sim]() {
+            const auto& s = sim.stats();
+            std::fprintf(stderr, "state=%d tel=%llu status=%llu bytes=%llu overrun=%llu flips=%llu drops=%llu "
+                                 "uplink=%llu cmds=%llu uplinkErr=%llu\n",
+                         sim.flightState(),
+                         static_cast<unsigned long long>(s.telemetrySent), static_cast<unsigned long long>(s.statusSent),
+                         static_cast<unsigned long long>(s.bytesSent), static_cast<unsigned long long>(s.framesOverrun),
+                         static_cast<unsigned long long>(s.bitsFlipped), static_cast<unsigned long long>(s.bytesDropped),
+                         static_cast<unsigned long long>(s.uplinkFrames), static_cast<unsigned long long>(s.commandsRx),
+                         static_cast<unsigned long long>(s.uplinkErrors));
+        });
+        statsTimer.start(statsSec * 1000);
+    }
+
+    return app.exec();
+}